@@ -4,8 +4,18 @@
 */
 const char* kSignature = "application/x-vnd.przemub.Weather";
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "App.h"
 #include "MainWindow.h"
+#include "RenderHarness.h"
+
+
+// The render harness needs an application object, but must not be taken
+// for a running Weather by the roster
+static const char* kRenderSignature = "application/x-vnd.przemub.Weather-render";
 
 
 App::App(void)
@@ -18,8 +28,25 @@ App::App(void)
 
 
 int
-main()
+main(int argc, char** argv)
 {
+	if (argc >= 4 && strcmp(argv[1], "--render") == 0) {
+		BApplication app(kRenderSignature);
+		return RenderToFiles(argv[2], argv[3]) == B_OK ? 0 : 1;
+	}
+	if (argc >= 3 && strcmp(argv[1], "--benchmark") == 0) {
+		BApplication app(kRenderSignature);
+		int32 frames = argc >= 4 ? atoi(argv[3]) : 100;
+		return RunRenderBenchmark(argv[2], frames) == B_OK ? 0 : 1;
+	}
+	if (argc >= 2 && (strcmp(argv[1], "--render") == 0
+			|| strcmp(argv[1], "--benchmark") == 0)) {
+		fprintf(stderr, "Usage: %s --render <response.json> <directory>\n"
+			"       %s --benchmark <response.json> [frames]\n", argv[0],
+			argv[0]);
+		return 1;
+	}
+
 	App* mApp = new App();
 	mApp->Run();
 	delete mApp;
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#include <AbstractSocket.h>
+#include <Autolock.h>
+
+#include <sys/socket.h>
+
+#include "CancellationToken.h"
+
+
+CancellationToken::CancellationToken()
+	:
+	fLock("cancellation token"),
+	fSocket(NULL),
+	fCanceled(false)
+{
+}
+
+
+void
+CancellationToken::Cancel()
+{
+	BAutolock locker(fLock);
+	fCanceled = true;
+
+	// Only wakes the thread up from its read or write: the socket belongs
+	// to that thread, which disconnects and deletes it once it sees the
+	// error, after detaching it
+	if (fSocket != NULL)
+		shutdown(fSocket->Socket(), SHUT_RDWR);
+}
+
+
+bool
+CancellationToken::IsCanceled()
+{
+	BAutolock locker(fLock);
+	return fCanceled;
+}
+
+
+bool
+CancellationToken::Attach(BAbstractSocket* socket)
+{
+	BAutolock locker(fLock);
+	if (fCanceled)
+		return false;
+
+	fSocket = socket;
+	return true;
+}
+
+
+void
+CancellationToken::Detach()
+{
+	BAutolock locker(fLock);
+	fSocket = NULL;
+}
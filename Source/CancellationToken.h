@@ -0,0 +1,41 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _CANCELLATIONTOKEN_H_
+#define _CANCELLATIONTOKEN_H_
+
+
+#include <Locker.h>
+#include <Referenceable.h>
+
+
+class BAbstractSocket;
+
+
+// Shared between a looper and the thread running a request on its behalf.
+// The looper cancels without waiting: the connection of the request is
+// shut down, the thread ends on its own and the looper drops whatever it
+// still sends.
+class CancellationToken : public BReferenceable
+{
+public:
+						CancellationToken();
+
+			void		Cancel();
+			bool		IsCanceled();
+
+			// The socket is shut down on cancellation until it is
+			// detached, which the thread using it must do before it
+			// deletes it. Returns false if it's already too late to use it.
+			bool		Attach(BAbstractSocket* socket);
+			void		Detach();
+
+private:
+			BLocker		fLock;
+			BAbstractSocket* fSocket;
+			bool		fCanceled;
+};
+
+
+#endif // _CANCELLATIONTOKEN_H_
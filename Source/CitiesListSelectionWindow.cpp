@@ -16,14 +16,17 @@
 #include <ScrollView.h>
 #include <StringView.h>
 #include <Url.h>
-#include <UrlProtocolRoster.h>
-#include <UrlRequest.h>
 #include <Window.h>
 
 #include <memory>
 
+#include "CancellationToken.h"
 #include "CitiesListSelectionWindow.h"
+#include "CitySearchCache.h"
+#include "HttpSession.h"
 #include "MainWindow.h"
+#include "OpenMeteoUrl.h"
+#include "PlaceIndex.h"
 #include "WSOpenMeteo.h"
 
 #undef B_TRANSLATION_CONTEXT
@@ -127,8 +130,102 @@ CityItem::Update(BView* owner, const BFont* font)
 }
 
 
+// One geocoding request, run in a thread of its own. Its replies carry
+// the generation and query that started it.
+class CitySearch : public CancellationToken
+{
+public:
+						CitySearch(const BMessenger& target,
+							const BString& query, int32 generation);
+
+			status_t	Run();
+
+private:
+	static	int32		_RunFunc(void* cookie);
+			void		_Search();
+
+			BMessenger	fTarget;
+			BString		fQuery;
+			int32		fGeneration;
+};
+
+
+CitySearch::CitySearch(const BMessenger& target, const BString& query,
+	int32 generation)
+	:
+	fTarget(target),
+	fQuery(query),
+	fGeneration(generation)
+{
+}
+
+
+status_t
+CitySearch::Run()
+{
+	// The thread keeps the search alive until it's done
+	AcquireReference();
+
+	thread_id thread
+		= spawn_thread(&_RunFunc, "City search", B_NORMAL_PRIORITY, this);
+	if (thread < 0) {
+		ReleaseReference();
+		return thread;
+	}
+
+	return resume_thread(thread);
+}
+
+
+int32
+CitySearch::_RunFunc(void* cookie)
+{
+	CitySearch* search = static_cast<CitySearch*>(cookie);
+	search->_Search();
+	search->ReleaseReference();
+	return 0;
+}
+
+
+void
+CitySearch::_Search()
+{
+	// use translated queries and results in local language if available
+	BFormattingConventions conventions;
+	const char* language = NULL;
+	if (BLocale::Default()->GetFormattingConventions(&conventions) == B_OK)
+		language = conventions.LanguageCode();
+
+	BString urlString(CitySearchUrl(fQuery.String(), language).c_str());
+
+	WSOpenMeteo listener(fTarget, CITY_REQUEST);
+	BMessage replyFields;
+	replyFields.AddInt32("generation", fGeneration);
+	replyFields.AddString("query", fQuery);
+	listener.SetReplyFields(replyFields);
+
+#if B_HAIKU_VERSION < B_HAIKU_VERSION_1_PRE_BETA_6
+	BUrl url(urlString.String());
+#else
+	BUrl url(urlString.String(), true);
+#endif
+	// Keystrokes follow each other closely, the next search reuses the
+	// connection of this one
+	HttpSession* session = HttpSession::Default();
+	if (session == NULL)
+		return;
+
+	HttpRequest request(url, &listener);
+	session->Run(request, this);
+}
+
+
 const uint32 kSelectedCity = 'SeCy';
 const uint32 kCancelCity = 'CncC';
+const uint32 kStartSearchMessage = 'StSr';
+
+// Typing pause after which the service is asked
+const bigtime_t kSearchDelay = 300000;
 
 
 CitiesListSelectionWindow::CitiesListSelectionWindow(BRect rect, BWindow* parent, BString city,
@@ -136,7 +233,8 @@ CitiesListSelectionWindow::CitiesListSelectionWindow(BRect rect, BWindow* parent
 	:
 	BWindow(rect, B_TRANSLATE("Choose location"), B_TITLED_WINDOW, B_NOT_ZOOMABLE
 		| B_ASYNCHRONOUS_CONTROLS | B_CLOSE_ON_ESCAPE | B_AUTO_UPDATE_SIZE_LIMITS),
-	fDownloadThread(-1)
+	fSearchRunner(NULL),
+	fSearchGeneration(0)
 {
 	fParent = parent;
 	fCitiesListView = new BListView("citiesList");
@@ -170,12 +268,14 @@ CitiesListSelectionWindow::CitiesListSelectionWindow(BRect rect, BWindow* parent
 	fButtonOk->MakeDefault(true);
 	fCityControl->MakeFocus(true);
 
-	_StartSearch();
+	_QueueSearch();
 }
 
 
 CitiesListSelectionWindow::~CitiesListSelectionWindow()
 {
+	_StopSearch();
+
 	BListItem* cityItem;
 	for (int32 index = 0; cityItem = fCitiesListView->ItemAt(index); index++)
 		delete cityItem;
@@ -188,37 +288,30 @@ CitiesListSelectionWindow::MessageReceived(BMessage* msg)
 	switch (msg->what) {
 		case kCitiesListMessage:
 		{
-			fCitiesListView->MakeEmpty();
-			int index = 0;
-			while (msg->FindString("city", index, &fCity) == B_OK) {
-				BString city;
-				double latitude = 0L;
-				double longitude = 0L;
-				int32 countryId = 0L;
-				int32 id = 0L;
-				BString country = "";
-				BString extendedInfo = "";
-
-				msg->FindInt32("id", index, &id);
-				msg->FindString("city", index, &city);
-				msg->FindString("country", index, &country);
-				msg->FindInt32("country_id", index, &countryId);
-				msg->FindString("extended_info", index, &extendedInfo);
-				msg->FindDouble("longitude", index, &longitude);
-				msg->FindDouble("latitude", index, &latitude);
-
-				CityItem* cityItem = new CityItem(id, city, country, extendedInfo);
-				cityItem->Latitude = latitude;
-				cityItem->Longitude = longitude;
-				cityItem->CountryId = countryId;
-
-				fCitiesListView->AddItem(cityItem);
-				index++;
-			}
-			fCitiesListView->Select(0);
+			int32 generation;
+			BString query;
+			if (msg->FindInt32("generation", &generation) != B_OK
+				|| msg->FindString("query", &query) != B_OK)
+				break;
+
+			msg->RemoveName("generation");
+			msg->RemoveName("query");
+			CitySearchCache::Default()->Put(query, *msg);
+
+			// A slow answer to a query that was typed over
+			if (generation != fSearchGeneration)
+				break;
+
+			fSearch.Unset();
+			_ShowResults(msg);
 			break;
 		}
 		case kSearchMessage:
+		{
+			_QueueSearch();
+			break;
+		}
+		case kStartSearchMessage:
 		{
 			_StartSearch();
 			break;
@@ -233,6 +326,10 @@ CitiesListSelectionWindow::MessageReceived(BMessage* msg)
 		}
 		case kFailureMessage:
 		{
+			int32 generation;
+			if (msg->FindInt32("generation", &generation) == B_OK
+				&& generation == fSearchGeneration)
+				fSearch.Unset();
 			// TODO add a message to the window
 			break;
 		}
@@ -281,69 +378,123 @@ CitiesListSelectionWindow::_UpdateCity()
 }
 
 void
-CitiesListSelectionWindow::_StartSearch()
+CitiesListSelectionWindow::_QueueSearch()
 {
+	BString query(fCityControl->Text());
+	query.Trim();
+	if (query == fSearchQuery)
+		return;
+	fSearchQuery = query;
+
+	// Whatever is pending was for an older query
 	_StopSearch();
 
-	fDownloadThread
-		= spawn_thread(&_FindIdFunc, "Download Data", B_NORMAL_PRIORITY, this);
-	if (fDownloadThread >= 0)
-		resume_thread(fDownloadThread);
-}
+	if (query.IsEmpty()) {
+		BMessage noResults(kCitiesListMessage);
+		_ShowResults(&noResults);
+		return;
+	}
 
-int32
-CitiesListSelectionWindow::_FindIdFunc(void* cookie)
-{
-	CitiesListSelectionWindow* selectionWindow = static_cast<CitiesListSelectionWindow*>(cookie);
-	selectionWindow->_FindId();
-	return 0;
+	BMessage results;
+	if (CitySearchCache::Default()->Lookup(query, results)) {
+		_ShowResults(&results);
+		return;
+	}
+
+	// The bundled index answers most queries, the service is only asked
+	// for places it doesn't know
+	PlaceIndex* index = PlaceIndex::Default();
+	if (index != NULL) {
+		city_result places[PLACE_INDEX_TOP_PLACES];
+		int32 count = index->Search(query.String(), places,
+			PLACE_INDEX_TOP_PLACES);
+		if (count > 0) {
+			BMessage localResults(kCitiesListMessage);
+			for (int32 i = 0; i < count; i++)
+				WSOpenMeteo::AddCity(&localResults, places[i]);
+			_ShowResults(&localResults);
+			return;
+		}
+	}
+
+	if (CitySearchCache::Default()->LookupPrefix(query, results))
+		_ShowResults(&results);
+
+	// The service is only asked once typing pauses
+	BMessage message(kStartSearchMessage);
+	fSearchRunner = new BMessageRunner(BMessenger(this), &message,
+		kSearchDelay, 1);
 }
 
+
 void
-CitiesListSelectionWindow::_StopSearch()
+CitiesListSelectionWindow::_StartSearch()
 {
-	if (fDownloadThread < 0)
+	delete fSearchRunner;
+	fSearchRunner = NULL;
+
+	CitySearch* search = new(std::nothrow) CitySearch(BMessenger(this),
+		fSearchQuery, fSearchGeneration);
+	if (search == NULL)
 		return;
-	wait_for_thread(fDownloadThread, NULL);
-	fDownloadThread = -1;
+
+	fSearch.SetTo(search, true);
+	if (search->Run() != B_OK)
+		fSearch.Unset();
 }
 
+
 void
-CitiesListSelectionWindow::_FindId()
+CitiesListSelectionWindow::_StopSearch()
 {
-	BString urlString("https://geocoding-api.open-meteo.com/v1/search?name=");
-	urlString << fCityControl->Text();
+	// Replies still on their way are dropped
+	fSearchGeneration++;
 
-	// use translated queries and results in local language if available
-	// otherwise return english or the native location name. Lower-cased.
-	BFormattingConventions conventions;
-	if (BLocale::Default()->GetFormattingConventions(&conventions) == B_OK
-		&& conventions.LanguageCode() != NULL)
-	{
-		BString languageCode = conventions.LanguageCode();
-		urlString << "&language=" << languageCode.ToLower();
-	}
+	delete fSearchRunner;
+	fSearchRunner = NULL;
 
-	// Filter out characters that trip up BUrl
-	urlString.ReplaceAll(" ", "+");
-	urlString.ReplaceAll("<", "");
-	urlString.ReplaceAll(">", "");
-	urlString.ReplaceAll("\"", "");
-
-	BMallocIO requestData;
-	WSOpenMeteo listener(this, &requestData, CITY_REQUEST);
+	if (fSearch.Get() != NULL) {
+		fSearch->Cancel();
+		fSearch.Unset();
+	}
+}
 
-#if B_HAIKU_VERSION < B_HAIKU_VERSION_1_PRE_BETA_6
-	BUrl url(urlString.String());
-#else
-	BUrl url(urlString.String(), true);
-#endif
-	BUrlRequest* request
-		= BUrlProtocolRoster::MakeRequest(url, &requestData, &listener);
 
-	thread_id thread = request->Run();
-	wait_for_thread(thread, NULL);
-	delete request;
+void
+CitiesListSelectionWindow::_ShowResults(BMessage* results)
+{
+	BListItem* item;
+	for (int32 index = 0; (item = fCitiesListView->ItemAt(index)); index++)
+		delete item;
+	fCitiesListView->MakeEmpty();
+
+	int index = 0;
+	while (results->FindString("city", index, &fCity) == B_OK) {
+		BString city;
+		double latitude = 0L;
+		double longitude = 0L;
+		int32 countryId = 0L;
+		int32 id = 0L;
+		BString country = "";
+		BString extendedInfo = "";
+
+		results->FindInt32("id", index, &id);
+		results->FindString("city", index, &city);
+		results->FindString("country", index, &country);
+		results->FindInt32("country_id", index, &countryId);
+		results->FindString("extended_info", index, &extendedInfo);
+		results->FindDouble("longitude", index, &longitude);
+		results->FindDouble("latitude", index, &latitude);
+
+		CityItem* cityItem = new CityItem(id, city, country, extendedInfo);
+		cityItem->Latitude = latitude;
+		cityItem->Longitude = longitude;
+		cityItem->CountryId = countryId;
+
+		fCitiesListView->AddItem(cityItem);
+		index++;
+	}
+	fCitiesListView->Select(0);
 }
 
 bool
@@ -6,6 +6,8 @@
 
 
 #include <Message.h>
+#include <MessageRunner.h>
+#include <Referenceable.h>
 #include <String.h>
 #include <TextControl.h>
 #include <ListView.h>
@@ -18,6 +20,8 @@ const int32 kSaveMessage = 'Save';
 const int32 kUpdateCityMessage = 'Updt';
 const int32 kCloseCitySelectionWindowMessage = 'SUCe';
 
+class CitySearch;
+
 class CitiesListSelectionWindow : public BWindow
 {
 public:
@@ -32,14 +36,18 @@ private:
 	BTextControl*	fCityControl;
 	BListView*		fCitiesListView;
 	BWindow*		fParent;
-	thread_id		fDownloadThread;
-	
+
+	BMessageRunner*	fSearchRunner;
+	BReference<CitySearch> fSearch;
+	int32			fSearchGeneration;
+	BString			fSearchQuery;
+
+	void			_QueueSearch();
 	void			_StartSearch();
 	void			_StopSearch();
-	static int32	_FindIdFunc(void *cookie);
+	void			_ShowResults(BMessage* results);
 	void			_UpdateCity();
-	void			_FindId();
-	
+
 	BString			fCity;
 	BString			fCityFullName;
 	int32			fCityId;
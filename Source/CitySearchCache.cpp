@@ -0,0 +1,149 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#include <Autolock.h>
+
+#include <new>
+
+#include "CitySearchCache.h"
+
+
+static const int32 kDefaultCapacity = 64;
+
+static CitySearchCache sDefaultCache(kDefaultCapacity);
+
+
+CitySearchCache::CitySearchCache(int32 capacity)
+	:
+	fLock("city search cache"),
+	fEntries(new(std::nothrow) cache_entry*[capacity]),
+	fCount(0),
+	fCapacity(fEntries != NULL ? capacity : 0)
+{
+}
+
+
+CitySearchCache::~CitySearchCache()
+{
+	for (int32 i = 0; i < fCount; i++)
+		delete fEntries[i];
+	delete[] fEntries;
+}
+
+
+/*static*/ CitySearchCache*
+CitySearchCache::Default()
+{
+	return &sDefaultCache;
+}
+
+
+bool
+CitySearchCache::Lookup(const BString& query, BMessage& results)
+{
+	BAutolock locker(fLock);
+	BString key = _Key(query);
+
+	for (int32 i = 0; i < fCount; i++) {
+		if (fEntries[i]->query == key) {
+			_MoveToFront(i);
+			results = fEntries[0]->results;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+bool
+CitySearchCache::LookupPrefix(const BString& query, BMessage& results)
+{
+	BAutolock locker(fLock);
+	BString key = _Key(query);
+
+	int32 best = -1;
+	for (int32 i = 0; i < fCount; i++) {
+		const BString& cached = fEntries[i]->query;
+		if (cached.Length() < key.Length() && key.StartsWith(cached)
+			&& (best < 0 || cached.Length() > fEntries[best]->query.Length()))
+			best = i;
+	}
+	if (best < 0)
+		return false;
+
+	const BMessage& cached = fEntries[best]->results;
+	results.MakeEmpty();
+	results.what = cached.what;
+
+	BString city;
+	for (int32 i = 0; cached.FindString("city", i, &city) == B_OK; i++) {
+		if (!_Key(city).StartsWith(key))
+			continue;
+
+		results.AddInt32("id", cached.GetInt32("id", i, 0));
+		results.AddString("city", city);
+		results.AddString("country", cached.GetString("country", i, ""));
+		results.AddInt32("country_id", cached.GetInt32("country_id", i, 0));
+		results.AddString("extended_info",
+			cached.GetString("extended_info", i, ""));
+		results.AddDouble("longitude", cached.GetDouble("longitude", i, 0));
+		results.AddDouble("latitude", cached.GetDouble("latitude", i, 0));
+	}
+	return true;
+}
+
+
+void
+CitySearchCache::Put(const BString& query, const BMessage& results)
+{
+	BAutolock locker(fLock);
+	if (fCapacity == 0)
+		return;
+
+	BString key = _Key(query);
+
+	int32 index = 0;
+	for (; index < fCount; index++) {
+		if (fEntries[index]->query == key)
+			break;
+	}
+	if (index == fCount) {
+		// The least recently used entry is the last one
+		if (fCount < fCapacity) {
+			cache_entry* entry = new(std::nothrow) cache_entry;
+			if (entry == NULL)
+				return;
+			fEntries[fCount++] = entry;
+		}
+		index = fCount - 1;
+	}
+
+	fEntries[index]->query = key;
+	fEntries[index]->results = results;
+	_MoveToFront(index);
+}
+
+
+/*static*/ BString
+CitySearchCache::_Key(const BString& query)
+{
+	BString key(query);
+	key.Trim();
+	key.ToLower();
+	return key;
+}
+
+
+void
+CitySearchCache::_MoveToFront(int32 index)
+{
+	if (index == 0)
+		return;
+
+	cache_entry* entry = fEntries[index];
+	for (int32 i = index; i > 0; i--)
+		fEntries[i] = fEntries[i - 1];
+	fEntries[0] = entry;
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _CITYSEARCHCACHE_H_
+#define _CITYSEARCHCACHE_H_
+
+
+#include <Locker.h>
+#include <Message.h>
+#include <String.h>
+
+
+// Remembers the last geocoding results (kCitiesListMessage) per query,
+// least recently used entries are dropped first.
+class CitySearchCache
+{
+public:
+						CitySearchCache(int32 capacity);
+						~CitySearchCache();
+
+	static	CitySearchCache* Default();
+
+			bool		Lookup(const BString& query, BMessage& results);
+			// Answers from the longest cached prefix of the query, keeping
+			// only the cities whose name still matches. The service may know
+			// more of them, so the answer is only provisional.
+			bool		LookupPrefix(const BString& query, BMessage& results);
+			void		Put(const BString& query, const BMessage& results);
+
+private:
+			struct cache_entry {
+				BString		query;
+				BMessage	results;
+			};
+
+	static	BString		_Key(const BString& query);
+			void		_MoveToFront(int32 index);
+
+			BLocker		fLock;
+			cache_entry**	fEntries;
+			int32		fCount;
+			int32		fCapacity;
+};
+
+
+#endif // _CITYSEARCHCACHE_H_
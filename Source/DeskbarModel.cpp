@@ -0,0 +1,193 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#include <Entry.h>
+#include <FindDirectory.h>
+#include <NodeMonitor.h>
+#include <Path.h>
+
+#include "DeskbarModel.h"
+#include "ForecastCache.h"
+#include "ForecastStore.h"
+#include "ForecastView.h"
+#include "Util.h"
+
+
+DeskbarModel::DeskbarModel()
+	:
+	fLatitude(kDefaultLatitude),
+	fLongitude(kDefaultLongitude),
+	fUnit(CELSIUS),
+	fHasWeather(false),
+	fCondition(0),
+	fIsDay(true),
+	fTemperature(0),
+	fStoreSequence(0)
+{
+}
+
+
+DeskbarModel::~DeskbarModel()
+{
+	StopWatching();
+}
+
+
+bool
+DeskbarModel::ReloadSettings()
+{
+	BMessage settings;
+	LoadSettings(settings);
+
+	BString city;
+	if (settings.FindString("city", &city) != B_OK)
+		city = kDefaultCityName;
+
+	double latitude, longitude;
+	if (settings.FindDouble("latitude", &latitude) != B_OK)
+		latitude = kDefaultLatitude;
+	if (settings.FindDouble("longitude", &longitude) != B_OK)
+		longitude = kDefaultLongitude;
+
+	DisplayUnit unit;
+	int32 value;
+	bool fahrenheit;
+	if (settings.FindInt32("displayUnit", &value) == B_OK)
+		unit = (DisplayUnit) value;
+	else if (settings.FindBool("fahrenheit", &fahrenheit) == B_OK)
+		unit = fahrenheit ? FAHRENHEIT : CELSIUS;
+	else
+		unit = ForecastView::IsFahrenheitDefault() ? FAHRENHEIT : CELSIUS;
+
+	if (city == fCity && latitude == fLatitude && longitude == fLongitude
+		&& unit == fUnit)
+		return false;
+
+	fCity = city;
+	fLatitude = latitude;
+	fLongitude = longitude;
+	fUnit = unit;
+	return true;
+}
+
+
+bool
+DeskbarModel::Reload(bool* stale)
+{
+	ForecastStore* store = ForecastStore::Default();
+	if (store != NULL)
+		fStoreSequence = store->Sequence();
+
+	ForecastCache cache(fLatitude, fLongitude, fUnit);
+	BReference<ForecastSnapshot> snapshot(cache.Load(stale), true);
+	if (snapshot.Get() == NULL) {
+		bool changed = fHasWeather;
+		fHasWeather = false;
+		return changed;
+	}
+
+	return SetSnapshot(snapshot);
+}
+
+
+bool
+DeskbarModel::SetSnapshot(const ForecastSnapshot* snapshot)
+{
+	if (!snapshot->HasCurrentWeather())
+		return false;
+
+	int32 condition = snapshot->Condition();
+	bool isDay = snapshot->IsDay();
+	int32 temperature = snapshot->Temperature();
+	if (fHasWeather && condition == fCondition && isDay == fIsDay
+		&& temperature == fTemperature)
+		return false;
+
+	fHasWeather = true;
+	fCondition = condition;
+	fIsDay = isDay;
+	fTemperature = temperature;
+	return true;
+}
+
+
+status_t
+DeskbarModel::StartWatching(const BMessenger& target)
+{
+	StopWatching();
+	fTarget = target;
+
+	BPath path;
+	if (find_directory(B_USER_SETTINGS_DIRECTORY, &path) == B_OK
+		&& path.Append(kSettingsFileName) == B_OK)
+		_Watch(path.Path(), fSettingsNode);
+
+	ForecastStore* store = ForecastStore::Default();
+	if (store != NULL)
+		_Watch(store->Path(), fStoreNode);
+
+	return B_OK;
+}
+
+
+void
+DeskbarModel::StopWatching()
+{
+	_Unwatch(fSettingsNode);
+	_Unwatch(fStoreNode);
+}
+
+
+bool
+DeskbarModel::HandleNodeMonitor(const BMessage* message)
+{
+	node_ref node;
+	if (message->GetInt32("opcode", 0) != B_STAT_CHANGED
+		|| message->FindInt32("device", &node.device) != B_OK
+		|| message->FindInt64("node", &node.node) != B_OK)
+		return false;
+
+	bool changed = false;
+	if (node == fSettingsNode)
+		changed = ReloadSettings();
+
+	// Stat changes don't all mean new forecasts, the sequence does
+	ForecastStore* store = ForecastStore::Default();
+	if (node == fStoreNode && !changed && store != NULL
+		&& store->Sequence() == fStoreSequence)
+		return false;
+
+	if (node == fStoreNode || changed) {
+		changed |= Reload();
+
+		// A compacted store is replaced by a new file
+		node_ref storeNode;
+		if (store != NULL && BEntry(store->Path()).GetNodeRef(&storeNode)
+				== B_OK && storeNode != fStoreNode) {
+			_Unwatch(fStoreNode);
+			_Watch(store->Path(), fStoreNode);
+		}
+	}
+
+	return changed;
+}
+
+
+void
+DeskbarModel::_Watch(const char* path, node_ref& _node)
+{
+	if (BEntry(path).GetNodeRef(&_node) != B_OK
+		|| watch_node(&_node, B_WATCH_STAT, fTarget) != B_OK)
+		_node = node_ref();
+}
+
+
+void
+DeskbarModel::_Unwatch(node_ref& node)
+{
+	if (node.node >= 0)
+		watch_node(&node, B_STOP_WATCHING, fTarget);
+	node = node_ref();
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _DESKBARMODEL_H_
+#define _DESKBARMODEL_H_
+
+
+#include <Messenger.h>
+#include <Node.h>
+#include <String.h>
+
+#include "PreferencesWindow.h"
+
+
+class ForecastSnapshot;
+
+
+// The few values the Deskbar item shows: the current condition and
+// temperature of the city chosen in the Weather settings. They are read
+// from the shared forecast store, so no view, layout or icon of the
+// Weather window is needed.
+//
+// Changes of the settings and of the store are reported to the target as
+// B_NODE_MONITOR messages, which are to be passed to HandleNodeMonitor().
+// The methods that read values return true when anything shown changed.
+class DeskbarModel
+{
+public:
+						DeskbarModel();
+						~DeskbarModel();
+
+			bool		ReloadSettings();
+			// stale is set when the forecast should be fetched again
+			bool		Reload(bool* stale = NULL);
+			bool		SetSnapshot(const ForecastSnapshot* snapshot);
+
+			status_t	StartWatching(const BMessenger& target);
+			void		StopWatching();
+			bool		HandleNodeMonitor(const BMessage* message);
+
+			bool		HasWeather() const { return fHasWeather; }
+			int32		Condition() const { return fCondition; }
+			bool		IsDay() const { return fIsDay; }
+			int32		Temperature() const { return fTemperature; }
+
+			const BString& City() const { return fCity; }
+			double		Latitude() const { return fLatitude; }
+			double		Longitude() const { return fLongitude; }
+			DisplayUnit	Unit() const { return fUnit; }
+
+private:
+			void		_Watch(const char* path, node_ref& _node);
+			void		_Unwatch(node_ref& node);
+
+			BMessenger	fTarget;
+			node_ref	fSettingsNode;
+			node_ref	fStoreNode;
+
+			BString		fCity;
+			double		fLatitude;
+			double		fLongitude;
+			DisplayUnit	fUnit;
+
+			bool		fHasWeather;
+			int32		fCondition;
+			bool		fIsDay;
+			int32		fTemperature;
+			uint32		fStoreSequence;
+};
+
+
+#endif // _DESKBARMODEL_H_
@@ -0,0 +1,196 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#include <Button.h>
+#include <Catalog.h>
+#include <File.h>
+#include <FindDirectory.h>
+#include <LayoutBuilder.h>
+#include <Path.h>
+#include <ScrollView.h>
+
+#include <string.h>
+
+#include <new>
+
+#include "DiagnosticsWindow.h"
+#include "LatencyLog.h"
+
+#undef B_TRANSLATION_CONTEXT
+#define B_TRANSLATION_CONTEXT "DiagnosticsWindow"
+
+
+static const uint32 kUpdateDiagnosticsMessage = 'UDgn';
+static const uint32 kSaveDiagnosticsMessage = 'SDgn';
+
+static const bigtime_t kUpdateInterval = 1000000;
+static const int32 kRecentRefreshes = 10;
+static const char* kLatencyFileName = "Weather latency";
+
+
+DiagnosticsWindow::DiagnosticsWindow(BRect frame, BWindow* parent)
+	:
+	BWindow(frame, B_TRANSLATE("Diagnostics"), B_TITLED_WINDOW,
+		B_ASYNCHRONOUS_CONTROLS | B_CLOSE_ON_ESCAPE
+			| B_AUTO_UPDATE_SIZE_LIMITS),
+	fParent(parent),
+	fUpdateRunner(NULL)
+{
+	fTextView = new BTextView("latency");
+	fTextView->MakeEditable(false);
+	fTextView->SetStylable(false);
+	fTextView->SetFontAndColor(be_fixed_font);
+	fTextView->SetExplicitMinSize(BSize(
+		be_fixed_font->StringWidth("M") * 44, be_fixed_font->Size() * 24));
+
+	BScrollView* scrollView = new BScrollView("scroll", fTextView, 0, false,
+		true);
+
+	fStatusView = new BStringView("status", "");
+
+	BLayoutBuilder::Group<>(this, B_VERTICAL)
+		.SetInsets(B_USE_WINDOW_SPACING)
+		.Add(scrollView)
+		.AddGroup(B_HORIZONTAL)
+			.Add(fStatusView)
+			.AddGlue()
+			.Add(new BButton("save", B_TRANSLATE("Save to file"),
+				new BMessage(kSaveDiagnosticsMessage)))
+			.End()
+		.End();
+
+	CenterIn(frame);
+
+	_Update();
+	BMessage update(kUpdateDiagnosticsMessage);
+	fUpdateRunner = new BMessageRunner(BMessenger(this), &update,
+		kUpdateInterval);
+}
+
+
+DiagnosticsWindow::~DiagnosticsWindow()
+{
+	delete fUpdateRunner;
+}
+
+
+void
+DiagnosticsWindow::MessageReceived(BMessage* message)
+{
+	switch (message->what) {
+		case kUpdateDiagnosticsMessage:
+			_Update();
+			break;
+		case kSaveDiagnosticsMessage:
+			_Save();
+			break;
+		default:
+			BWindow::MessageReceived(message);
+	}
+}
+
+
+bool
+DiagnosticsWindow::QuitRequested()
+{
+	BMessenger(fParent).SendMessage(kCloseDiagnosticsWindowMessage);
+	return true;
+}
+
+
+void
+DiagnosticsWindow::_Update()
+{
+	LatencyLog* log = LatencyLog::Default();
+	refresh_latency* latencies
+		= new(std::nothrow) refresh_latency[LatencyLog::kCapacity];
+	if (log == NULL || latencies == NULL) {
+		delete[] latencies;
+		return;
+	}
+
+	int32 count = log->Get(latencies, LatencyLog::kCapacity);
+
+	BString text;
+	text.SetToFormat(B_TRANSLATE("Last %" B_PRId32 " refreshes, in ms\n\n"),
+		count);
+
+	BString line;
+	line.SetToFormat("%-12s %9s %9s %6s\n", "", "p50", "p95", "count");
+	text << line;
+	for (int32 phase = 0; phase <= kLatencyPhaseCount; phase++) {
+		int32 measured = 0;
+		for (int32 i = 0; i < count; i++) {
+			bigtime_t duration = phase < kLatencyPhaseCount
+				? LatencyLog::PhaseDuration(latencies[i], phase)
+				: LatencyLog::TotalDuration(latencies[i]);
+			if (duration >= 0)
+				measured++;
+		}
+
+		line.SetToFormat("%-12s %9s %9s %6" B_PRId32 "\n",
+			LatencyLog::PhaseName(phase),
+			FormatLatency(
+				LatencyLog::Percentile(latencies, count, phase, 50)).String(),
+			FormatLatency(
+				LatencyLog::Percentile(latencies, count, phase, 95)).String(),
+			measured);
+		text << line;
+	}
+
+	// The newest first
+	text << "\n" << B_TRANSLATE("Recent refreshes") << "\n";
+	line.SetToFormat("%-12s %9s %9s %6s\n", "", "total", "bytes",
+		"places");
+	text << line;
+	bigtime_t now = system_time();
+	for (int32 i = count - 1; i >= 0 && i >= count - kRecentRefreshes; i--) {
+		const refresh_latency& latency = latencies[i];
+		BString age;
+		age.SetToFormat(B_TRANSLATE("%" B_PRId64 " s ago"),
+			(now - latency.started) / 1000000);
+		line.SetToFormat("%-12s %9s %9" B_PRIu64 " %6" B_PRId32 "\n",
+			age.String(),
+			FormatLatency(LatencyLog::TotalDuration(latency)).String(),
+			latency.responseSize, latency.locations);
+		text << line;
+	}
+
+	delete[] latencies;
+
+	if (text != fTextView->Text())
+		fTextView->SetText(text.String());
+}
+
+
+void
+DiagnosticsWindow::_Save()
+{
+	LatencyLog* log = LatencyLog::Default();
+
+	BPath path;
+	status_t status = log != NULL ? B_OK : B_NO_MEMORY;
+	if (status == B_OK)
+		status = find_directory(B_USER_LOG_DIRECTORY, &path, true);
+	if (status == B_OK)
+		status = path.Append(kLatencyFileName);
+
+	BFile file;
+	if (status == B_OK) {
+		status = file.SetTo(path.Path(),
+			B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+	}
+	if (status == B_OK)
+		status = log->Dump(file);
+
+	BString message;
+	if (status == B_OK)
+		message.SetToFormat(B_TRANSLATE("Saved to %s"), path.Path());
+	else {
+		message.SetToFormat(B_TRANSLATE("Could not save: %s"),
+			strerror(status));
+	}
+	fStatusView->SetText(message.String());
+}
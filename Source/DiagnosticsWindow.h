@@ -0,0 +1,41 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _DIAGNOSTICSWINDOW_H_
+#define _DIAGNOSTICSWINDOW_H_
+
+
+#include <MessageRunner.h>
+#include <StringView.h>
+#include <TextView.h>
+#include <Window.h>
+
+
+const uint32 kCloseDiagnosticsWindowMessage = 'CDgW';
+
+
+// Shows where the time of the last refreshes of the team went, as the
+// median and the 95th percentile of every phase, and writes the whole
+// LatencyLog to a file
+class DiagnosticsWindow : public BWindow
+{
+public:
+						DiagnosticsWindow(BRect frame, BWindow* parent);
+	virtual				~DiagnosticsWindow();
+
+	virtual	void		MessageReceived(BMessage* message);
+	virtual	bool		QuitRequested();
+
+private:
+			void		_Update();
+			void		_Save();
+
+			BWindow*	fParent;
+			BTextView*	fTextView;
+			BStringView* fStatusView;
+			BMessageRunner* fUpdateRunner;
+};
+
+
+#endif // _DIAGNOSTICSWINDOW_H_
@@ -0,0 +1,946 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#include <Autolock.h>
+#include <Directory.h>
+#include <FindDirectory.h>
+#include <MessageRunner.h>
+#include <Path.h>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <new>
+
+#include "FetchCoordinator.h"
+#include "ForecastCache.h"
+#include "ForecastFetch.h"
+#include "ForecastStore.h"
+#include "LatencyLog.h"
+#include "MainWindow.h"
+
+
+enum {
+	kSubscribeMessage		= 'FCsb',
+	kUnsubscribeMessage		= 'FCus',
+	kRefreshMessage			= 'FCrf',
+	kRegisterMessage		= 'FCrg',
+	kRemoteRefreshMessage	= 'FCrr',
+	kPublishedMessage		= 'FCpb',
+	kFetchFailedMessage		= 'FCfl',
+	kStartFetchesMessage	= 'FCst',
+	kCheckPendingMessage	= 'FCck'
+};
+
+// Requests arriving within this time go out in one batch
+static const bigtime_t kCoalesceDelay = 200000;
+// A forecast this fresh is published again instead of being downloaded
+static const int64 kRecentFetch = 60;
+// Forwarded requests not answered in time are sent again, to another
+// leader if the old one went away, and given up after a few tries.
+// Downloads not answered in time fail, so that they can be asked for again.
+static const bigtime_t kPendingTimeout = 60000000;
+static const int32 kMaxForwardAttempts = 3;
+
+
+struct subscription {
+	BMessenger		target;
+	int64			locationId;
+	double			latitude;
+	double			longitude;
+	DisplayUnit		unit;
+};
+
+
+struct coordinated_fetch {
+	int64			locationId;
+	double			latitude;
+	double			longitude;
+	DisplayUnit		unit;
+	int32			timeToLive;
+	// -1 while queued
+	int32			batch;
+	int32			index;
+	bigtime_t		queued;
+	BReference<ForecastFetch> fetch;
+};
+
+
+struct pending_request {
+	int64			locationId;
+	double			latitude;
+	double			longitude;
+	DisplayUnit		unit;
+	int32			timeToLive;
+	bool			forced;
+	bigtime_t		deadline;
+	int32			attempts;
+};
+
+
+static BLocker sCoordinatorLock("fetch coordinator");
+static FetchCoordinator* sCoordinator = NULL;
+
+
+static void
+add_location(BMessage& message, int64 locationId, double latitude,
+	double longitude, DisplayUnit unit)
+{
+	message.AddInt64("location id", locationId);
+	message.AddDouble("latitude", latitude);
+	message.AddDouble("longitude", longitude);
+	message.AddInt32("unit", unit);
+}
+
+
+FetchCoordinator::FetchCoordinator()
+	:
+	BLooper("fetch coordinator"),
+	fUsers(0),
+	fLockFD(-1),
+	fLeading(false),
+	fRegistered(false),
+	fNextBatch(0),
+	fStartQueued(false),
+	fCheckQueued(false)
+{
+}
+
+
+FetchCoordinator::~FetchCoordinator()
+{
+	for (int32 i = 0; coordinated_fetch* fetch
+			= (coordinated_fetch*) fFetches.ItemAt(i); i++) {
+		if (fetch->fetch.Get() != NULL)
+			fetch->fetch->Cancel();
+		delete fetch;
+	}
+	for (int32 i = 0; ForecastFetch* fetch
+			= (ForecastFetch*) fRunning.ItemAt(i); i++)
+		fetch->ReleaseReference();
+	for (int32 i = 0; BMessenger* team = (BMessenger*) fTeams.ItemAt(i); i++)
+		delete team;
+	for (int32 i = 0; subscription* subscription
+			= (struct subscription*) fSubscriptions.ItemAt(i); i++)
+		delete subscription;
+	for (int32 i = 0; pending_request* request
+			= (pending_request*) fPending.ItemAt(i); i++)
+		delete request;
+
+	// Lets another team take over
+	if (fLockFD >= 0)
+		close(fLockFD);
+}
+
+
+/*static*/ FetchCoordinator*
+FetchCoordinator::Acquire()
+{
+	BAutolock locker(sCoordinatorLock);
+	if (sCoordinator == NULL) {
+		sCoordinator = new(std::nothrow) FetchCoordinator();
+		if (sCoordinator == NULL)
+			return NULL;
+		sCoordinator->Run();
+	}
+
+	sCoordinator->fUsers++;
+	return sCoordinator;
+}
+
+
+/*static*/ void
+FetchCoordinator::Release(FetchCoordinator* coordinator)
+{
+	if (coordinator == NULL)
+		return;
+
+	BAutolock locker(sCoordinatorLock);
+	if (--coordinator->fUsers > 0)
+		return;
+
+	if (sCoordinator == coordinator)
+		sCoordinator = NULL;
+
+	// Replicants may be unloaded with their code, so neither the looper
+	// nor the download threads may outlive its last user
+	if (coordinator->Lock()) {
+		coordinator->_StopFetches();
+		coordinator->Quit();
+	}
+}
+
+
+status_t
+FetchCoordinator::Subscribe(const BMessenger& target, double latitude,
+	double longitude, DisplayUnit unit)
+{
+	BMessage message(kSubscribeMessage);
+	message.AddMessenger("target", target);
+	add_location(message, ForecastLocationId(latitude, longitude, unit),
+		latitude, longitude, unit);
+	return PostMessage(&message);
+}
+
+
+status_t
+FetchCoordinator::Unsubscribe(const BMessenger& target)
+{
+	BMessage message(kUnsubscribeMessage);
+	message.AddMessenger("target", target);
+	return PostMessage(&message);
+}
+
+
+status_t
+FetchCoordinator::Refresh(const BMessenger& target, int32 timeToLive,
+	bool forced)
+{
+	BMessage message(kRefreshMessage);
+	message.AddMessenger("target", target);
+	message.AddInt32("ttl", timeToLive);
+	message.AddBool("forced", forced);
+	return PostMessage(&message);
+}
+
+
+void
+FetchCoordinator::MessageReceived(BMessage* message)
+{
+	switch (message->what) {
+		case kSubscribeMessage:
+			_HandleSubscribe(message);
+			break;
+		case kUnsubscribeMessage:
+			_HandleUnsubscribe(message);
+			break;
+		case kRefreshMessage:
+			_HandleRefresh(message);
+			break;
+
+		case kRegisterMessage:
+		{
+			BMessenger team;
+			if (message->FindMessenger("team", &team) == B_OK)
+				_AddTeam(team);
+			break;
+		}
+		case kRemoteRefreshMessage:
+			_HandleRemoteRefresh(message);
+			break;
+		case kStartFetchesMessage:
+			_StartFetches();
+			break;
+		case kForecastSnapshotMessage:
+			_HandleSnapshot(message);
+			break;
+		case kFailureMessage:
+			_HandleFailure(message);
+			break;
+
+		case kPublishedMessage:
+			_HandlePublished(message);
+			break;
+		case kFetchFailedMessage:
+		{
+			int64 locationId = message->GetInt64("location id", 0);
+			for (int32 i = fPending.CountItems() - 1; i >= 0; i--) {
+				pending_request* request
+					= (pending_request*) fPending.ItemAt(i);
+				if (request->locationId == locationId)
+					delete (pending_request*) fPending.RemoveItem(i);
+			}
+			_Deliver(locationId, kFailureMessage, NULL, NULL,
+				message->GetInt32("retry after", 0));
+			break;
+		}
+		case kCheckPendingMessage:
+			fCheckQueued = false;
+			_CheckPending();
+			break;
+
+		default:
+			BLooper::MessageReceived(message);
+	}
+}
+
+
+// Takes the lock file if nobody holds it, otherwise finds the looper of
+// the team holding it in the file
+bool
+FetchCoordinator::_Elect()
+{
+	BMessenger leader = fLeader;
+	fLeading = false;
+	fLeader = BMessenger();
+
+	if (fLockFD < 0) {
+		BPath path;
+		if (find_directory(B_USER_CACHE_DIRECTORY, &path, true) != B_OK
+			|| path.Append("Weather") != B_OK
+			|| create_directory(path.Path(), 0755) != B_OK
+			|| path.Append("Fetcher") != B_OK)
+			return false;
+
+		fLockFD = open(path.Path(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+		if (fLockFD < 0)
+			return false;
+	}
+
+	if (flock(fLockFD, LOCK_EX | LOCK_NB) == 0) {
+		BMessage address;
+		address.AddMessenger("leader", BMessenger(this));
+		ssize_t size = address.FlattenedSize();
+		char* buffer = new(std::nothrow) char[size];
+		if (buffer != NULL && address.Flatten(buffer, size) == B_OK
+			&& ftruncate(fLockFD, 0) == 0)
+			pwrite(fLockFD, buffer, size, 0);
+		delete[] buffer;
+
+		fLeading = true;
+		return true;
+	}
+
+	// The leader writes its address right after taking the lock, until
+	// then the old one is in there, which isn't valid anymore
+	struct stat info;
+	if (fstat(fLockFD, &info) != 0 || info.st_size <= 0
+		|| info.st_size > 4096)
+		return false;
+
+	char buffer[4096];
+	BMessage address;
+	if (pread(fLockFD, buffer, info.st_size, 0) != info.st_size
+		|| address.Unflatten(buffer) != B_OK
+		|| address.FindMessenger("leader", &fLeader) != B_OK
+		|| !fLeader.IsValid()) {
+		fLeader = BMessenger();
+		return false;
+	}
+
+	if (fLeader != leader)
+		fRegistered = false;
+	return true;
+}
+
+
+void
+FetchCoordinator::_HandleSubscribe(BMessage* message)
+{
+	BMessenger target;
+	if (message->FindMessenger("target", &target) != B_OK)
+		return;
+
+	subscription* subscription = NULL;
+	for (int32 i = 0; i < fSubscriptions.CountItems(); i++) {
+		struct subscription* item
+			= (struct subscription*) fSubscriptions.ItemAt(i);
+		if (item->target == target) {
+			subscription = item;
+			break;
+		}
+	}
+	if (subscription == NULL) {
+		subscription = new(std::nothrow) struct subscription;
+		if (subscription == NULL || !fSubscriptions.AddItem(subscription)) {
+			delete subscription;
+			return;
+		}
+		subscription->target = target;
+	}
+
+	subscription->locationId = message->GetInt64("location id", 0);
+	subscription->latitude = message->GetDouble("latitude", 0);
+	subscription->longitude = message->GetDouble("longitude", 0);
+	subscription->unit = (DisplayUnit) message->GetInt32("unit", CELSIUS);
+
+	// Get what the others download for this location too
+	if (!fLeading && !fLeader.IsValid())
+		_Elect();
+	_Register();
+}
+
+
+void
+FetchCoordinator::_HandleUnsubscribe(BMessage* message)
+{
+	BMessenger target;
+	if (message->FindMessenger("target", &target) != B_OK)
+		return;
+
+	for (int32 i = fSubscriptions.CountItems() - 1; i >= 0; i--) {
+		subscription* item = (subscription*) fSubscriptions.ItemAt(i);
+		if (item->target == target)
+			delete (subscription*) fSubscriptions.RemoveItem(i);
+	}
+}
+
+
+void
+FetchCoordinator::_HandleRefresh(BMessage* message)
+{
+	BMessenger target;
+	if (message->FindMessenger("target", &target) != B_OK)
+		return;
+
+	subscription* subscription = NULL;
+	for (int32 i = 0; i < fSubscriptions.CountItems(); i++) {
+		struct subscription* item
+			= (struct subscription*) fSubscriptions.ItemAt(i);
+		if (item->target == target) {
+			subscription = item;
+			break;
+		}
+	}
+	if (subscription == NULL)
+		return;
+
+	int32 timeToLive = message->GetInt32("ttl", 0);
+	bool forced = message->GetBool("forced", false);
+
+	if (!fLeading && !fLeader.IsValid())
+		_Elect();
+	if (fLeading) {
+		_Queue(subscription->locationId, subscription->latitude,
+			subscription->longitude, subscription->unit, timeToLive, forced);
+		return;
+	}
+
+	for (int32 i = 0; i < fPending.CountItems(); i++) {
+		pending_request* request = (pending_request*) fPending.ItemAt(i);
+		if (request->locationId == subscription->locationId && !forced)
+			return;
+	}
+
+	pending_request* request = new(std::nothrow) pending_request;
+	if (request == NULL || !fPending.AddItem(request)) {
+		delete request;
+		return;
+	}
+	request->locationId = subscription->locationId;
+	request->latitude = subscription->latitude;
+	request->longitude = subscription->longitude;
+	request->unit = subscription->unit;
+	request->timeToLive = timeToLive;
+	request->forced = forced;
+	request->attempts = 0;
+	request->deadline = 0;
+
+	// Sent by _CheckPending(), which also deals with a missing leader
+	_CheckPending();
+}
+
+
+void
+FetchCoordinator::_HandleRemoteRefresh(BMessage* message)
+{
+	BMessenger team;
+	if (message->FindMessenger("team", &team) == B_OK)
+		_AddTeam(team);
+
+	if (!fLeading) {
+		// Sent to a former leader. Passed on once to the one we know of,
+		// otherwise the sender is told right away instead of waiting for
+		// its request to time out.
+		if (!message->GetBool("passed on", false)) {
+			BMessage forward(*message);
+			forward.AddBool("passed on", true);
+			if (_Forward(&forward) == B_OK)
+				return;
+		}
+
+		BMessage failed(kFetchFailedMessage);
+		failed.AddInt64("location id", message->GetInt64("location id", 0));
+		if (team.IsValid())
+			team.SendMessage(&failed, (BHandler*) NULL, 0);
+		return;
+	}
+
+	_Queue(message->GetInt64("location id", 0),
+		message->GetDouble("latitude", 0), message->GetDouble("longitude", 0),
+		(DisplayUnit) message->GetInt32("unit", CELSIUS),
+		message->GetInt32("ttl", 0), message->GetBool("forced", false));
+}
+
+
+void
+FetchCoordinator::_HandleSnapshot(BMessage* message)
+{
+	BReference<ForecastSnapshot> snapshot = SnapshotMailbox::Receive(*message);
+	if (snapshot.Get() == NULL)
+		return;
+
+	refresh_latency latency;
+	bool timed = FindLatency(*message, latency);
+
+	int32 batch = message->GetInt32("batch", -1);
+	int32 index = message->GetInt32("location", 0);
+	for (int32 i = 0; i < fFetches.CountItems(); i++) {
+		coordinated_fetch* fetch = (coordinated_fetch*) fFetches.ItemAt(i);
+		if (fetch->batch != batch || fetch->index != index)
+			continue;
+
+		fFetches.RemoveItem(i);
+		_Publish(fetch->locationId, fetch->latitude, fetch->longitude,
+			fetch->unit, snapshot.Get(), timed ? &latency : NULL);
+		delete fetch;
+		break;
+	}
+}
+
+
+void
+FetchCoordinator::_HandleFailure(BMessage* message)
+{
+	// Without a location, the whole batch failed
+	int32 batch = message->GetInt32("batch", -1);
+	int32 index = message->GetInt32("location", -1);
+	int32 retryAfter = message->GetInt32("retry after", 0);
+	for (int32 i = fFetches.CountItems() - 1; i >= 0; i--) {
+		coordinated_fetch* fetch = (coordinated_fetch*) fFetches.ItemAt(i);
+		if (fetch->batch != batch || (index >= 0 && fetch->index != index))
+			continue;
+
+		fFetches.RemoveItem(i);
+		_PublishFailure(fetch->locationId, retryAfter);
+		delete fetch;
+	}
+}
+
+
+void
+FetchCoordinator::_HandlePublished(BMessage* message)
+{
+	int64 locationId = message->GetInt64("location id", 0);
+	for (int32 i = fPending.CountItems() - 1; i >= 0; i--) {
+		pending_request* request = (pending_request*) fPending.ItemAt(i);
+		if (request->locationId == locationId)
+			delete (pending_request*) fPending.RemoveItem(i);
+	}
+
+	refresh_latency latency;
+	bool timed = FindLatency(*message, latency);
+
+	_Publish(locationId, message->GetDouble("latitude", 0),
+		message->GetDouble("longitude", 0),
+		(DisplayUnit) message->GetInt32("unit", CELSIUS), NULL,
+		timed ? &latency : NULL);
+}
+
+
+void
+FetchCoordinator::_CheckPending()
+{
+	bigtime_t now = system_time();
+	_ExpireFetches(now);
+
+	for (int32 i = fPending.CountItems() - 1; i >= 0; i--) {
+		pending_request* request = (pending_request*) fPending.ItemAt(i);
+		if (request->deadline > now)
+			continue;
+
+		if (request->attempts >= kMaxForwardAttempts) {
+			fPending.RemoveItem(i);
+			_Deliver(request->locationId, kFailureMessage, NULL);
+			delete request;
+			continue;
+		}
+
+		// The leader may have gone away since
+		if (request->attempts > 0 || !fLeader.IsValid())
+			_Elect();
+		if (fLeading) {
+			fPending.RemoveItem(i);
+			_Queue(request->locationId, request->latitude,
+				request->longitude, request->unit, request->timeToLive,
+				request->forced);
+			delete request;
+			continue;
+		}
+
+		BMessage forward(kRemoteRefreshMessage);
+		forward.AddMessenger("team", BMessenger(this));
+		add_location(forward, request->locationId, request->latitude,
+			request->longitude, request->unit);
+		forward.AddInt32("ttl", request->timeToLive);
+		forward.AddBool("forced", request->forced);
+		_Forward(&forward);
+
+		// Also when it couldn't be sent, the lock may be taken over
+		// by then
+		request->attempts++;
+		request->deadline = now + kPendingTimeout;
+	}
+
+	_ScheduleCheck();
+}
+
+
+status_t
+FetchCoordinator::_Forward(BMessage* request)
+{
+	if (!fLeader.IsValid())
+		return B_BAD_PORT_ID;
+
+	status_t status = fLeader.SendMessage(request, (BHandler*) NULL, 0);
+	if (status != B_OK)
+		fLeader = BMessenger();
+	return status;
+}
+
+
+void
+FetchCoordinator::_Register()
+{
+	if (fLeading || fRegistered || fSubscriptions.IsEmpty())
+		return;
+
+	BMessage message(kRegisterMessage);
+	message.AddMessenger("team", BMessenger(this));
+	fRegistered = _Forward(&message) == B_OK;
+}
+
+
+void
+FetchCoordinator::_AddTeam(const BMessenger& team)
+{
+	for (int32 i = 0; i < fTeams.CountItems(); i++) {
+		if (*(BMessenger*) fTeams.ItemAt(i) == team)
+			return;
+	}
+
+	BMessenger* messenger = new(std::nothrow) BMessenger(team);
+	if (messenger != NULL && !fTeams.AddItem(messenger))
+		delete messenger;
+}
+
+
+void
+FetchCoordinator::_Queue(int64 locationId, double latitude, double longitude,
+	DisplayUnit unit, int32 timeToLive, bool forced)
+{
+	// A download that never answered is not waited for again
+	_ExpireFetches(system_time());
+
+	for (int32 i = 0; i < fFetches.CountItems(); i++) {
+		coordinated_fetch* fetch = (coordinated_fetch*) fFetches.ItemAt(i);
+		if (fetch->locationId != locationId)
+			continue;
+
+		// Already asked for, everyone gets that one
+		if (timeToLive > fetch->timeToLive)
+			fetch->timeToLive = timeToLive;
+
+		// Unless it's forced: the download may hang, so it is aborted
+		// and its locations are asked for again right away
+		if (forced && fetch->batch >= 0) {
+			fetch->queued = system_time();
+			_RestartBatch(fetch->batch);
+			_ScheduleStart();
+		}
+		return;
+	}
+
+	if (!forced) {
+		ForecastStore* store = ForecastStore::Default();
+		if (store != NULL && store->Lock()) {
+			const forecast_record* record = store->Lookup(locationId);
+			bool recent = record != NULL
+				&& time(NULL) - record->fetchTime < kRecentFetch;
+			store->Unlock();
+
+			if (recent) {
+				_Publish(locationId, latitude, longitude, unit);
+				return;
+			}
+		}
+	}
+
+	coordinated_fetch* fetch = new(std::nothrow) coordinated_fetch;
+	if (fetch == NULL || !fFetches.AddItem(fetch)) {
+		delete fetch;
+		_PublishFailure(locationId);
+		return;
+	}
+	fetch->locationId = locationId;
+	fetch->latitude = latitude;
+	fetch->longitude = longitude;
+	fetch->unit = unit;
+	fetch->timeToLive = timeToLive;
+	fetch->batch = -1;
+	fetch->index = 0;
+	fetch->queued = system_time();
+
+	_ScheduleStart();
+}
+
+
+void
+FetchCoordinator::_ScheduleStart()
+{
+	if (fStartQueued)
+		return;
+
+	BMessage start(kStartFetchesMessage);
+	fStartQueued = BMessageRunner::StartSending(BMessenger(this), &start,
+		kCoalesceDelay, 1) == B_OK;
+	if (!fStartQueued)
+		_StartFetches();
+}
+
+
+// Cancels the download of the batch and queues its locations again. Late
+// replies to it are stale: no fetch has its batch number any more.
+void
+FetchCoordinator::_RestartBatch(int32 batch)
+{
+	for (int32 i = 0; i < fFetches.CountItems(); i++) {
+		coordinated_fetch* fetch = (coordinated_fetch*) fFetches.ItemAt(i);
+		if (fetch->batch != batch)
+			continue;
+
+		if (fetch->fetch.Get() != NULL)
+			fetch->fetch->Cancel();
+		fetch->fetch.Unset();
+		fetch->batch = -1;
+		fetch->index = 0;
+	}
+}
+
+
+void
+FetchCoordinator::_StartFetches()
+{
+	fStartQueued = false;
+	_ReapFetches();
+
+	// One batch per unit, Open-Meteo takes it per request
+	for (;;) {
+		coordinated_fetch* first = NULL;
+		int32 timeToLive = 0;
+		for (int32 i = 0; i < fFetches.CountItems(); i++) {
+			coordinated_fetch* fetch = (coordinated_fetch*) fFetches.ItemAt(i);
+			if (fetch->batch >= 0
+				|| (first != NULL && fetch->unit != first->unit))
+				continue;
+			if (first == NULL)
+				first = fetch;
+			if (fetch->timeToLive > timeToLive)
+				timeToLive = fetch->timeToLive;
+		}
+		if (first == NULL)
+			break;
+
+		DisplayUnit unit = first->unit;
+		int32 batch = fNextBatch++;
+		BReference<ForecastFetch> refresh(new(std::nothrow) ForecastFetch(
+			BMessenger(this), unit, timeToLive), true);
+
+		BMessage replyFields;
+		replyFields.AddInt32("batch", batch);
+		if (refresh.Get() != NULL)
+			refresh->SetReplyFields(replyFields);
+
+		bool added = true;
+		for (int32 i = 0; i < fFetches.CountItems(); i++) {
+			coordinated_fetch* fetch = (coordinated_fetch*) fFetches.ItemAt(i);
+			if (fetch->batch >= 0 || fetch->unit != unit)
+				continue;
+
+			fetch->batch = batch;
+			if (refresh.Get() == NULL)
+				continue;
+			fetch->index = refresh->CountLocations();
+			fetch->fetch = refresh;
+			added &= refresh->AddLocation(fetch->latitude, fetch->longitude)
+				== B_OK;
+		}
+
+		if (refresh.Get() == NULL || !added || refresh->Run() != B_OK) {
+			BMessage failure(kFailureMessage);
+			failure.AddInt32("batch", batch);
+			_HandleFailure(&failure);
+			continue;
+		}
+
+		if (fRunning.AddItem(refresh.Get()))
+			refresh->AcquireReference();
+	}
+
+	_ScheduleCheck();
+}
+
+
+// Forgets the downloads whose threads are done
+void
+FetchCoordinator::_ReapFetches()
+{
+	for (int32 i = fRunning.CountItems() - 1; i >= 0; i--) {
+		ForecastFetch* fetch = (ForecastFetch*) fRunning.ItemAt(i);
+		thread_info info;
+		if (get_thread_info(fetch->Thread(), &info) == B_OK)
+			continue;
+
+		fRunning.RemoveItem(i);
+		fetch->ReleaseReference();
+	}
+}
+
+
+// Cancels the downloads and waits for their threads, which the
+// cancellation wakes up by shutting their socket down
+void
+FetchCoordinator::_StopFetches()
+{
+	for (int32 i = 0; ForecastFetch* fetch
+			= (ForecastFetch*) fRunning.ItemAt(i); i++)
+		fetch->Cancel();
+
+	for (int32 i = 0; ForecastFetch* fetch
+			= (ForecastFetch*) fRunning.ItemAt(i); i++) {
+		status_t result;
+		wait_for_thread(fetch->Thread(), &result);
+		fetch->ReleaseReference();
+	}
+	fRunning.MakeEmpty();
+}
+
+
+// Gives up on the downloads that did not answer in time, and tells those
+// waiting for them
+void
+FetchCoordinator::_ExpireFetches(bigtime_t now)
+{
+	for (int32 i = fFetches.CountItems() - 1; i >= 0; i--) {
+		coordinated_fetch* fetch = (coordinated_fetch*) fFetches.ItemAt(i);
+		if (now - fetch->queued <= kPendingTimeout)
+			continue;
+
+		if (fetch->fetch.Get() != NULL)
+			fetch->fetch->Cancel();
+		fFetches.RemoveItem(i);
+		_PublishFailure(fetch->locationId);
+		delete fetch;
+	}
+}
+
+
+// Hands the forecast to the views of this team subscribed to it, and if
+// we lead, tells the other teams to take it from the store
+void
+FetchCoordinator::_Publish(int64 locationId, double latitude,
+	double longitude, DisplayUnit unit, ForecastSnapshot* snapshot,
+	const refresh_latency* latency)
+{
+	BReference<ForecastSnapshot> reference;
+	if (snapshot == NULL) {
+		bool subscribed = false;
+		for (int32 i = 0; i < fSubscriptions.CountItems(); i++) {
+			if (((subscription*) fSubscriptions.ItemAt(i))->locationId
+					== locationId) {
+				subscribed = true;
+				break;
+			}
+		}
+		if (subscribed) {
+			ForecastCache cache(latitude, longitude, unit);
+			snapshot = cache.Load();
+			reference.SetTo(snapshot, true);
+		}
+	}
+	if (snapshot != NULL)
+		_Deliver(locationId, kForecastSnapshotMessage, snapshot, latency);
+
+	if (!fLeading)
+		return;
+
+	BMessage published(kPublishedMessage);
+	add_location(published, locationId, latitude, longitude, unit);
+	if (latency != NULL)
+		AddLatency(published, *latency);
+	for (int32 i = fTeams.CountItems() - 1; i >= 0; i--) {
+		BMessenger* team = (BMessenger*) fTeams.ItemAt(i);
+		if (team->SendMessage(&published, (BHandler*) NULL, 0) != B_OK)
+			delete (BMessenger*) fTeams.RemoveItem(i);
+	}
+}
+
+
+void
+FetchCoordinator::_PublishFailure(int64 locationId, int32 retryAfter)
+{
+	_Deliver(locationId, kFailureMessage, NULL, NULL, retryAfter);
+
+	if (!fLeading)
+		return;
+
+	BMessage failed(kFetchFailedMessage);
+	failed.AddInt64("location id", locationId);
+	if (retryAfter > 0)
+		failed.AddInt32("retry after", retryAfter);
+	for (int32 i = fTeams.CountItems() - 1; i >= 0; i--) {
+		BMessenger* team = (BMessenger*) fTeams.ItemAt(i);
+		if (team->SendMessage(&failed, (BHandler*) NULL, 0) != B_OK)
+			delete (BMessenger*) fTeams.RemoveItem(i);
+	}
+}
+
+
+void
+FetchCoordinator::_Deliver(int64 locationId, uint32 what,
+	ForecastSnapshot* snapshot, const refresh_latency* latency,
+	int32 retryAfter)
+{
+	for (int32 i = fSubscriptions.CountItems() - 1; i >= 0; i--) {
+		subscription* subscription
+			= (struct subscription*) fSubscriptions.ItemAt(i);
+		if (subscription->locationId != locationId)
+			continue;
+
+		BMessage message(what);
+		message.AddInt64("location id", locationId);
+		if (snapshot != NULL
+			&& SnapshotMailbox::Post(message, locationId, snapshot) != B_OK)
+			continue;
+		if (latency != NULL)
+			AddLatency(message, *latency);
+		if (retryAfter > 0)
+			message.AddInt32("retry after", retryAfter);
+
+		if (subscription->target.SendMessage(&message, (BHandler*) NULL, 0)
+				!= B_OK) {
+			// The view is gone
+			delete (struct subscription*) fSubscriptions.RemoveItem(i);
+		}
+	}
+}
+
+
+void
+FetchCoordinator::_ScheduleCheck()
+{
+	if (fCheckQueued || (fPending.IsEmpty() && fFetches.IsEmpty()))
+		return;
+
+	bigtime_t next = B_INFINITE_TIMEOUT;
+	for (int32 i = 0; i < fPending.CountItems(); i++) {
+		pending_request* request = (pending_request*) fPending.ItemAt(i);
+		if (request->deadline < next)
+			next = request->deadline;
+	}
+	for (int32 i = 0; i < fFetches.CountItems(); i++) {
+		coordinated_fetch* fetch = (coordinated_fetch*) fFetches.ItemAt(i);
+		if (fetch->queued + kPendingTimeout < next)
+			next = fetch->queued + kPendingTimeout;
+	}
+
+	BMessage check(kCheckPendingMessage);
+	bigtime_t delay = next - system_time();
+	fCheckQueued = BMessageRunner::StartSending(BMessenger(this), &check,
+		delay > kCoalesceDelay ? delay : kCoalesceDelay, 1) == B_OK;
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _FETCHCOORDINATOR_H_
+#define _FETCHCOORDINATOR_H_
+
+
+#include <List.h>
+#include <Looper.h>
+#include <Messenger.h>
+
+#include "PreferencesWindow.h"
+
+
+class ForecastSnapshot;
+struct refresh_latency;
+
+
+// Does the forecast downloads of all the weather views of the user: the
+// main window, the replicants and the Deskbar item, which run in different
+// teams. Every team has one coordinator, the first one to take the lock
+// file next to the forecast store downloads for all of them; the others
+// forward their requests to it. When it goes away, the next request that
+// can't be delivered or isn't answered makes another team take over.
+//
+// Views subscribe to a location and unit. Requests for the same location
+// and unit are downloaded once, and requests arriving together are sent
+// in one batch. Every view subscribed to the location gets the result:
+// a kForecastSnapshotMessage naming the snapshot in the SnapshotMailbox,
+// or a kFailureMessage. Both carry the
+// ForecastLocationId() in their "location id" field. A failure carries
+// the seconds the server asked to wait in "retry after", if it did.
+//
+// There is one coordinator per team while it has users. All methods may
+// be called from any thread.
+class FetchCoordinator : public BLooper
+{
+public:
+	static	FetchCoordinator* Acquire();
+	static	void		Release(FetchCoordinator* coordinator);
+
+			// A target only has one subscription, subscribing again
+			// replaces it
+			status_t	Subscribe(const BMessenger& target, double latitude,
+							double longitude, DisplayUnit unit);
+			status_t	Unsubscribe(const BMessenger& target);
+
+			// Asks for the forecast of the location the target subscribed
+			// to. Unless forced, a forecast fetched a moment ago is
+			// published again instead.
+			status_t	Refresh(const BMessenger& target, int32 timeToLive,
+							bool forced = false);
+
+	virtual	void		MessageReceived(BMessage* message);
+
+private:
+						FetchCoordinator();
+	virtual				~FetchCoordinator();
+
+			bool		_Elect();
+
+			void		_HandleSubscribe(BMessage* message);
+			void		_HandleUnsubscribe(BMessage* message);
+			void		_HandleRefresh(BMessage* message);
+			void		_HandleRemoteRefresh(BMessage* message);
+			void		_HandleSnapshot(BMessage* message);
+			void		_HandleFailure(BMessage* message);
+			void		_HandlePublished(BMessage* message);
+			void		_CheckPending();
+			void		_ExpireFetches(bigtime_t now);
+
+			status_t	_Forward(BMessage* request);
+			void		_Register();
+			void		_AddTeam(const BMessenger& team);
+
+			void		_Queue(int64 locationId, double latitude,
+							double longitude, DisplayUnit unit,
+							int32 timeToLive, bool forced);
+			void		_ScheduleStart();
+			void		_StartFetches();
+			void		_RestartBatch(int32 batch);
+			void		_ReapFetches();
+			void		_StopFetches();
+
+			void		_Publish(int64 locationId, double latitude,
+							double longitude, DisplayUnit unit,
+							ForecastSnapshot* snapshot = NULL,
+							const refresh_latency* latency = NULL);
+			void		_PublishFailure(int64 locationId,
+							int32 retryAfter = 0);
+			void		_Deliver(int64 locationId, uint32 what,
+							ForecastSnapshot* snapshot,
+							const refresh_latency* latency = NULL,
+							int32 retryAfter = 0);
+			void		_ScheduleCheck();
+
+			int32		fUsers;
+			int			fLockFD;
+			bool		fLeading;
+			BMessenger	fLeader;
+			bool		fRegistered;
+
+			// Leader: queued and running downloads, the other teams
+			BList		fFetches;
+			BList		fTeams;
+			int32		fNextBatch;
+			bool		fStartQueued;
+			// The downloads whose threads may still run, referenced
+			BList		fRunning;
+
+			// Every team: the views, and requests forwarded to the leader
+			BList		fSubscriptions;
+			BList		fPending;
+			bool		fCheckQueued;
+};
+
+
+#endif // _FETCHCOORDINATOR_H_
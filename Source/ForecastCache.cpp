@@ -0,0 +1,63 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#include <time.h>
+
+#include <new>
+
+#include "ForecastCache.h"
+#include "ForecastStore.h"
+
+
+ForecastCache::ForecastCache(double latitude, double longitude, int32 unit)
+	:
+	fLocationId(ForecastLocationId(latitude, longitude, unit))
+{
+}
+
+
+ForecastSnapshot*
+ForecastCache::Load(bool* stale) const
+{
+	if (stale != NULL)
+		*stale = true;
+
+	ForecastStore* store = ForecastStore::Default();
+	if (store == NULL || !store->Lock())
+		return NULL;
+
+	// A record is never modified once the index points to it, and Lookup()
+	// checks that it belongs to the location, so whatever it returns is a
+	// complete forecast without asking another team. The snapshot takes a
+	// copy, which it completes with the daily and current weather.
+	ForecastSnapshot* snapshot = NULL;
+	int64 fetchTime = 0;
+	int32 timeToLive = 0;
+	const forecast_record* record = store->Lookup(fLocationId);
+	if (record != NULL) {
+		fetchTime = record->fetchTime;
+		timeToLive = record->timeToLive;
+		snapshot = new(std::nothrow) ForecastSnapshot(record->data, fetchTime);
+	}
+	store->Unlock();
+
+	if (snapshot != NULL && stale != NULL) {
+		int64 now = time(NULL);
+		*stale = now < fetchTime || now - fetchTime >= timeToLive;
+	}
+	return snapshot;
+}
+
+
+status_t
+ForecastCache::Store(const ForecastSnapshot* snapshot, int32 timeToLive) const
+{
+	ForecastStore* store = ForecastStore::Default();
+	if (store == NULL)
+		return B_NO_MEMORY;
+
+	return store->Append(fLocationId, snapshot->FetchTime(), timeToLive,
+		snapshot->Data());
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _FORECASTCACHE_H_
+#define _FORECASTCACHE_H_
+
+
+#include "ForecastSnapshot.h"
+
+
+// The last forecast fetched for a location, kept in the shared
+// ForecastStore so that views can show it at once on startup or while
+// offline. Nearby cities share an entry, see ForecastLocationId().
+class ForecastCache
+{
+public:
+						ForecastCache(double latitude, double longitude,
+							int32 unit);
+
+			// Returns a new reference, or NULL if there is no usable entry.
+			// stale is set when the entry outlived its time to live.
+			ForecastSnapshot* Load(bool* stale = NULL) const;
+			status_t	Store(const ForecastSnapshot* snapshot,
+							int32 timeToLive) const;
+
+private:
+			int64		fLocationId;
+};
+
+
+#endif // _FORECASTCACHE_H_
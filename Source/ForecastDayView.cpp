@@ -7,6 +7,10 @@
 #include <Screen.h>
 #include <String.h>
 
+#include <string.h>
+
+#include <new>
+
 
 ForecastDayView::ForecastDayView(BRect frame)
 	:
@@ -14,9 +18,12 @@ ForecastDayView::ForecastDayView(BRect frame)
 		frame, "ForecastDayView", B_FOLLOW_NONE, B_WILL_DRAW | B_FRAME_EVENTS),
 	fHigh(0),
 	fLow(0),
-	fIcon(NULL)
+	fTile(NULL),
+	fTileDesktopColor(make_color(0, 0, 0, 0))
 {
+	fIcon.bitmap = NULL;
 	fTextColor = ui_color(B_PANEL_TEXT_COLOR);
+	_InitFonts();
 }
 
 
@@ -32,8 +39,14 @@ ForecastDayView::Instantiate(BMessage* archive)
 
 ForecastDayView::ForecastDayView(BMessage* archive)
 	:
-	BView(archive)
+	BView(archive),
+	fTile(NULL),
+	fTileDesktopColor(make_color(0, 0, 0, 0))
 {
+	fIcon.bitmap = NULL;
+	fTextColor = ui_color(B_PANEL_TEXT_COLOR);
+	_InitFonts();
+
 	if (archive->FindString("dayLabel", &fDayLabel) != B_OK)
 		fDayLabel = "";
 
@@ -88,125 +101,81 @@ ForecastDayView::AttachedToWindow()
 {
 	if (Parent() != NULL)
 		SetViewColor(Parent()->ViewColor());
+	_InvalidateTile();
+}
+
+
+void
+ForecastDayView::SetViewColor(rgb_color color)
+{
+	BView::SetViewColor(color);
+	_InvalidateTile();
 }
 
 
 ForecastDayView::~ForecastDayView(void)
 {
+	delete fTile;
 }
 
 
 void
 ForecastDayView::FrameResized(float width, float height)
 {
-	Invalidate();
+	_InvalidateTile();
 }
 
 
 void
 ForecastDayView::Draw(BRect urect)
 {
-	BFont labelFont = be_bold_font;
-	font_height finfo;
-	labelFont.SetSize(12);
-	labelFont.GetHeight(&finfo);
-	SetFont(&labelFont);
-	rgb_color boxColor;
-	rgb_color color = fTextColor;
+	// A replicant is only told that the desktop changed its color by
+	// being drawn again, its tile is then rendered anew
+	rgb_color desktop = fTileDesktopColor;
 	if (ViewColor() == B_TRANSPARENT_COLOR) {
-		rgb_color low = BScreen(Window()).DesktopColor();
-		if (low.red + low.green + low.blue > 128 * 3) {
-			color = tint_color(low, B_DARKEN_MAX_TINT);
-			boxColor = make_color(255, 255, 255);
-		} else {
-			color = tint_color(low, B_LIGHTEN_MAX_TINT);
-			boxColor = make_color(55, 55, 55);
+		desktop = BScreen(Window()).DesktopColor();
+		if (fTile != NULL && desktop != fTileDesktopColor) {
+			delete fTile;
+			fTile = NULL;
 		}
 	}
-	BRect boxRect = Bounds();
-	// Full Box
-	if (ViewColor() == B_TRANSPARENT_COLOR) {
-		SetDrawingMode(B_OP_ALPHA);
-		boxColor.alpha = 86;
-		SetHighColor(boxColor);
-	} else {
-		SetDrawingMode(B_OP_COPY);
-		SetHighColor(tint_color(ViewColor(), 0.7));
-	}
-	FillRect(Bounds());
-	// Header Box
-	if (ViewColor() == B_TRANSPARENT_COLOR) {
-		SetDrawingMode(B_OP_ALPHA);
-		boxColor.alpha = 66;
-		SetHighColor(boxColor);
-	} else {
-		SetDrawingMode(B_OP_COPY);
-		SetHighColor(tint_color(ViewColor(), 1.1));
+
+	if (fTile == NULL)
+		_RenderTile(desktop);
+
+	if (fTile == NULL) {
+		// Out of memory, draw without the cache
+		_DrawTile(this, _TextColor(desktop), _BoxColor(desktop));
+		return;
 	}
 
-	BRect boxBRect = Bounds();
-	boxBRect.bottom
-		= boxBRect.top + finfo.ascent + finfo.descent + finfo.leading + 10;
-	FillRect(boxBRect);
-	if (ViewColor() == B_TRANSPARENT_COLOR)
+	if (ViewColor() == B_TRANSPARENT_COLOR) {
 		SetDrawingMode(B_OP_ALPHA);
-	else
+		SetBlendingMode(B_PIXEL_ALPHA, B_ALPHA_OVERLAY);
+	} else
 		SetDrawingMode(B_OP_COPY);
-	MovePenTo((Bounds().Width() - StringWidth(fDayLabel)) / 2,
-		20 + boxRect.top + (finfo.descent + finfo.leading) - 5);
-	SetHighColor(color);
-	SetLowColor(tint_color(ViewColor(), 1.1));
-	DrawString(fDayLabel);
-
-	BFont tempFont = be_plain_font;
-	tempFont.SetSize(15);
-	tempFont.GetHeight(&finfo);
-	SetFont(&tempFont);
-	SetLowColor(tint_color(ViewColor(), 0.7));
-
-	BString highString = FormatString(fDisplayUnit, fHigh);
-
-	BString lowString = FormatString(fDisplayUnit, fLow);
-
-	float space = 7;
-	if (fDayLabel == "")
-		lowString = highString = "--";
-
-	SetHighColor(color);
-
-	MovePenTo((Bounds().Width() - StringWidth(highString)) / 2,
-		boxRect.bottom - (finfo.descent + finfo.leading + space) * 2 - 5);
-
-	DrawString(highString);
-
-	MovePenTo((Bounds().Width() - StringWidth(lowString)) / 2,
-		boxRect.bottom - (finfo.descent + finfo.leading) - 5);
-
-	tempFont.SetSize(14);
-	SetFont(&tempFont);
+	DrawBitmap(fTile, urect, urect);
+	SetDrawingMode(B_OP_COPY);
+}
 
-	DrawString(lowString);
 
-	if (fIcon) {
-		SetDrawingMode(B_OP_OVER);
-		float hOffset = (Bounds().Width() - fIcon->Bounds().Width()) / 2;
-		float vOffset = (Bounds().Height()
-			- (finfo.ascent + finfo.descent + finfo.leading) * 2
-			- fIcon->Bounds().Height())
-			/ 2;
-		vOffset += boxBRect.bottom / 2;
-		DrawBitmap(
-			fIcon, BPoint(boxRect.left + hOffset, boxRect.top + vOffset));
-		SetDrawingMode(B_OP_COPY);
-	}
+void
+ForecastDayView::SetForecast(const BString& dayLabel,
+	const atlas_icon& icon, int32 high, int32 low)
+{
+	fDayLabel = dayLabel;
+	fIcon = icon;
+	fHigh = high;
+	fLow = low;
+	_InvalidateTile();
 }
 
 
 void
-ForecastDayView::SetIcon(BBitmap* icon)
+ForecastDayView::SetIcon(const atlas_icon& icon)
 {
 	fIcon = icon;
-	Invalidate();
+	_InvalidateTile();
 }
 
 
@@ -214,7 +183,7 @@ void
 ForecastDayView::SetDayLabel(BString& dayLabel)
 {
 	fDayLabel = dayLabel;
-	Invalidate();
+	_InvalidateTile();
 }
 
 
@@ -222,7 +191,7 @@ void
 ForecastDayView::SetTemp(BString& temp)
 {
 	fTemp = temp;
-	Invalidate();
+	_InvalidateTile();
 }
 
 
@@ -230,7 +199,7 @@ void
 ForecastDayView::SetHighTemp(int32 temp)
 {
 	fHigh = temp;
-	Invalidate();
+	_InvalidateTile();
 }
 
 
@@ -238,7 +207,7 @@ void
 ForecastDayView::SetLowTemp(int32 temp)
 {
 	fLow = temp;
-	Invalidate();
+	_InvalidateTile();
 }
 
 
@@ -246,7 +215,7 @@ void
 ForecastDayView::SetDisplayUnit(DisplayUnit unit)
 {
 	fDisplayUnit = unit;
-	Invalidate();
+	_InvalidateTile();
 }
 
 
@@ -261,5 +230,186 @@ void
 ForecastDayView::SetTextColor(rgb_color color)
 {
 	fTextColor = color;
+	_InvalidateTile();
+}
+
+
+void
+ForecastDayView::_InitFonts()
+{
+	fLabelFont = be_bold_font;
+	fLabelFont.SetSize(12);
+	fLabelFont.GetHeight(&fLabelHeight);
+
+	fHighFont = be_plain_font;
+	fHighFont.SetSize(15);
+	fHighFont.GetHeight(&fHighHeight);
+
+	fLowFont = fHighFont;
+	fLowFont.SetSize(14);
+}
+
+
+void
+ForecastDayView::_InvalidateTile()
+{
+	delete fTile;
+	fTile = NULL;
 	Invalidate();
 }
+
+
+rgb_color
+ForecastDayView::_TextColor(rgb_color desktop) const
+{
+	if (ViewColor() != B_TRANSPARENT_COLOR)
+		return fTextColor;
+
+	rgb_color low = desktop;
+	if (low.red + low.green + low.blue > 128 * 3)
+		return tint_color(low, B_DARKEN_MAX_TINT);
+	return tint_color(low, B_LIGHTEN_MAX_TINT);
+}
+
+
+rgb_color
+ForecastDayView::_BoxColor(rgb_color desktop) const
+{
+	rgb_color low = desktop;
+	if (low.red + low.green + low.blue > 128 * 3)
+		return make_color(255, 255, 255);
+	return make_color(55, 55, 55);
+}
+
+
+void
+ForecastDayView::_RenderTile(rgb_color desktop)
+{
+	// Only done when the content, the colors or the size changed, exposing
+	// the view just copies the result
+	BRect bounds = Bounds();
+	BBitmap* tile = new(std::nothrow) BBitmap(bounds,
+		B_BITMAP_ACCEPTS_VIEWS, B_RGBA32);
+	if (tile == NULL || tile->InitCheck() != B_OK) {
+		delete tile;
+		return;
+	}
+
+	bool transparent = ViewColor() == B_TRANSPARENT_COLOR;
+	rgb_color textColor = fTextColor;
+	rgb_color boxColor = make_color(0, 0, 0);
+	if (transparent && Window() != NULL) {
+		textColor = _TextColor(desktop);
+		boxColor = _BoxColor(desktop);
+		fTileDesktopColor = desktop;
+	}
+
+	BView* view = new BView(bounds, "tile", B_FOLLOW_NONE, 0);
+	tile->AddChild(view);
+	if (tile->Lock()) {
+		if (transparent) {
+			// Starts fully transparent, the boxes are blended onto the
+			// desktop when the tile is drawn
+			memset(tile->Bits(), 0, tile->BitsLength());
+			view->SetBlendingMode(B_PIXEL_ALPHA, B_ALPHA_COMPOSITE);
+			view->SetViewColor(B_TRANSPARENT_COLOR);
+		} else {
+			view->SetHighColor(ViewColor());
+			view->FillRect(bounds);
+		}
+		_DrawTile(view, textColor, boxColor);
+		view->Sync();
+		tile->Unlock();
+	}
+	tile->RemoveChild(view);
+	delete view;
+
+	delete fTile;
+	fTile = tile;
+}
+
+
+void
+ForecastDayView::_DrawTile(BView* view, rgb_color color, rgb_color boxColor)
+{
+	bool transparent = ViewColor() == B_TRANSPARENT_COLOR;
+	const font_height& finfo = fLabelHeight;
+	view->SetFont(&fLabelFont);
+	BRect boxRect = view->Bounds();
+	// Full Box
+	if (transparent) {
+		view->SetDrawingMode(B_OP_ALPHA);
+		boxColor.alpha = 86;
+		view->SetHighColor(boxColor);
+	} else {
+		view->SetDrawingMode(B_OP_COPY);
+		view->SetHighColor(tint_color(ViewColor(), 0.7));
+	}
+	view->FillRect(boxRect);
+	// Header Box
+	if (transparent) {
+		view->SetDrawingMode(B_OP_ALPHA);
+		boxColor.alpha = 66;
+		view->SetHighColor(boxColor);
+	} else {
+		view->SetDrawingMode(B_OP_COPY);
+		view->SetHighColor(tint_color(ViewColor(), 1.1));
+	}
+
+	BRect boxBRect = boxRect;
+	boxBRect.bottom
+		= boxBRect.top + finfo.ascent + finfo.descent + finfo.leading + 10;
+	view->FillRect(boxBRect);
+	if (transparent)
+		view->SetDrawingMode(B_OP_ALPHA);
+	else
+		view->SetDrawingMode(B_OP_COPY);
+	view->MovePenTo((boxRect.Width() - view->StringWidth(fDayLabel)) / 2,
+		20 + boxRect.top + (finfo.descent + finfo.leading) - 5);
+	view->SetHighColor(color);
+	view->SetLowColor(tint_color(ViewColor(), 1.1));
+	view->DrawString(fDayLabel);
+
+	const font_height& tinfo = fHighHeight;
+	view->SetFont(&fHighFont);
+	view->SetLowColor(tint_color(ViewColor(), 0.7));
+
+	BString highString = FormatString(fDisplayUnit, fHigh);
+
+	BString lowString = FormatString(fDisplayUnit, fLow);
+
+	float space = 7;
+	if (fDayLabel == "")
+		lowString = highString = "--";
+
+	view->SetHighColor(color);
+
+	view->MovePenTo((boxRect.Width() - view->StringWidth(highString)) / 2,
+		boxRect.bottom - (tinfo.descent + tinfo.leading + space) * 2 - 5);
+
+	view->DrawString(highString);
+
+	view->MovePenTo((boxRect.Width() - view->StringWidth(lowString)) / 2,
+		boxRect.bottom - (tinfo.descent + tinfo.leading) - 5);
+
+	view->SetFont(&fLowFont);
+
+	view->DrawString(lowString);
+
+	if (fIcon.bitmap != NULL) {
+		if (transparent)
+			view->SetDrawingMode(B_OP_ALPHA);
+		else
+			view->SetDrawingMode(B_OP_OVER);
+		float hOffset = (boxRect.Width() - fIcon.frame.Width()) / 2;
+		float vOffset = (boxRect.Height()
+			- (tinfo.ascent + tinfo.descent + tinfo.leading) * 2
+			- fIcon.frame.Height())
+			/ 2;
+		vOffset += boxBRect.bottom / 2;
+		view->DrawBitmap(fIcon.bitmap, fIcon.frame,
+			fIcon.frame.OffsetToCopy(boxRect.left + hOffset,
+				boxRect.top + vOffset));
+	}
+	view->SetDrawingMode(B_OP_COPY);
+}
@@ -1,8 +1,10 @@
 #ifndef _FORECASTDAYVIEW_H_
 #define _FORECASTDAYVIEW_H_
 
+#include "IconAtlas.h"
 #include "PreferencesWindow.h"
 #include <Bitmap.h>
+#include <Font.h>
 #include <String.h>
 #include <View.h>
 
@@ -17,11 +19,15 @@ public:
 	virtual void	FrameResized(float, float);
 	virtual void	Draw(BRect);
 	virtual void	AttachedToWindow();
+	virtual void	SetViewColor(rgb_color color);
+			using BView::SetViewColor;
 virtual status_t	Archive(BMessage* into, bool deep = true) const;
 static BArchivable*	Instantiate(BMessage* archive);
 		status_t	SaveState(BMessage* into, bool deep = true) const;
 
-			void	SetIcon(BBitmap* icon);
+			void	SetForecast(const BString& dayLabel,
+						const atlas_icon& icon, int32 high, int32 low);
+			void	SetIcon(const atlas_icon& icon);
 			void	SetDayLabel(BString& dayLabel);
 			void	SetTemp(BString& temp);
 			void	SetHighTemp(int32 high);
@@ -31,13 +37,31 @@ static BArchivable*	Instantiate(BMessage* archive);
 			void	SetTextColor(rgb_color color);
 
 private:
+			void	_InitFonts();
+			void	_InvalidateTile();
+		rgb_color	_TextColor(rgb_color desktop) const;
+		rgb_color	_BoxColor(rgb_color desktop) const;
+			void	_RenderTile(rgb_color desktop);
+			void	_DrawTile(BView* view, rgb_color color,
+						rgb_color boxColor);
+
 	DisplayUnit		fDisplayUnit;
 	int32			fHigh;
 	int32			fLow;
 	BString			fDayLabel;
 	BString			fTemp;
-	BBitmap*		fIcon;
+	atlas_icon		fIcon;
 	rgb_color		fTextColor;
+
+	// The whole tile, drawn again only when something in it changed
+	BBitmap*		fTile;
+	// What the tile of a transparent view was rendered for
+	rgb_color		fTileDesktopColor;
+	BFont			fLabelFont;
+	BFont			fHighFont;
+	BFont			fLowFont;
+	font_height		fLabelHeight;
+	font_height		fHighHeight;
 };
 
 #endif // _FORECASTDAYVIEW_H_
@@ -6,42 +6,57 @@
 #include <Alert.h>
 #include <Bitmap.h>
 #include <Catalog.h>
-#include <IconUtils.h>
 #include <Looper.h>
 #include <MessageRunner.h>
+#include <NodeMonitor.h>
 #include <Roster.h>
 #include <String.h>
-#include <StringView.h>
+
+#include <time.h>
+
+#include <new>
 
 #include "App.h"
 #include "ForecastDeskbarView.h"
+#include "FetchCoordinator.h"
+#include "ForecastStore.h"
 #include "ForecastView.h"
+#include "WeatherCondition.h"
 
 #undef B_TRANSLATION_CONTEXT
 #define B_TRANSLATION_CONTEXT "ForecastDeskbarView"
 
-const uint32 kUpdateForecastMessage = 'Updt';
-const float kToolTipDelay = 1000000; /*1000000ms = 1s*/
+// The current conditions are the ones of the present hour
+const uint32 kHourChangedMessage = 'HrCh';
+// Like the Weather window
+const int32 kForecastTimeToLive = 4 * 60 * 60;
 
 ForecastDeskbarView::ForecastDeskbarView(BRect viewSize)
 	:
-	BView(viewSize, "ForecastDeskbarView", B_FOLLOW_ALL, B_WILL_DRAW)
+	BView(viewSize, "ForecastDeskbarView", B_FOLLOW_ALL, B_WILL_DRAW),
+	fIcons(IconAtlas::Acquire()),
+	fIconSize(viewSize.IntegerHeight() + 1),
+	fHourRunner(NULL),
+	fCoordinator(NULL)
 {
-	// forecastview is only needed to get the weather icon
-	fForecastView = new ForecastView(BRect(0, 0, 0, 0));
-	fForecastView->SetDeskbarIconSize(viewSize.IntegerHeight());
-	AddChild(fForecastView);
-	fMessageRunner = NULL;
 }
 
 
 ForecastDeskbarView::ForecastDeskbarView(BMessage* archive)
 	:
 	BView(archive),
-	fMessageRunner(NULL)
+	fIcons(IconAtlas::Acquire()),
+	fIconSize(Bounds().IntegerHeight() + 1),
+	fHourRunner(NULL),
+	fCoordinator(NULL)
 {
-	// fForecastView is unarchived and already added to the view hierarchy
-	fForecastView = static_cast<ForecastView*>(FindView("Weather"));
+	// Archived by older versions, along with the whole weather view
+	BView* forecastView = FindView("Weather");
+	if (forecastView != NULL) {
+		RemoveChild(forecastView);
+		delete forecastView;
+	}
+
 	entry_ref appRef;
 	SetAppLocation(appRef);
 	archive->FindRef("appLocation", &appRef);
@@ -51,20 +66,36 @@ ForecastDeskbarView::ForecastDeskbarView(BMessage* archive)
 
 ForecastDeskbarView::~ForecastDeskbarView()
 {
-	delete fMessageRunner;
-	delete fForecastView;
+	_StopRefresh();
+	FetchCoordinator::Release(fCoordinator);
+	delete fHourRunner;
+	IconAtlas::Release(fIcons);
 }
 
 
 void
 ForecastDeskbarView::AttachedToWindow()
 {
-	fMessageRunner = new BMessageRunner(BMessenger(this),
-		new BMessage(kUpdateForecastMessage), kToolTipDelay, -1);
+	AdoptParentColors();
 
-	fForecastView->SetShowForecast(true);
+	if (fCoordinator == NULL)
+		fCoordinator = FetchCoordinator::Acquire();
 
-	AdoptParentColors();
+	fModel.ReloadSettings();
+	fModel.StartWatching(BMessenger(this));
+	_Reload();
+}
+
+
+void
+ForecastDeskbarView::DetachedFromWindow()
+{
+	fModel.StopWatching();
+	_StopRefresh();
+	FetchCoordinator::Release(fCoordinator);
+	fCoordinator = NULL;
+	delete fHourRunner;
+	fHourRunner = NULL;
 }
 
 
@@ -72,12 +103,20 @@ void
 ForecastDeskbarView::Draw(BRect drawRect)
 {
 	BView::Draw(drawRect);
+	if (fIcons == NULL || !fModel.HasWeather())
+		return;
+
+	const weather_condition& condition
+		= WeatherCondition(fModel.Condition());
+	atlas_icon icon;
+	if (!fIcons->GetIcon(fModel.IsDay() ? condition.icon
+			: condition.nightIcon, fIconSize, icon))
+		return;
+
 	SetDrawingMode(B_OP_OVER);
 		// TO-DO: Try with
 		// SetBlendingMode(B_PIXEL_ALPHA, B_ALPHA_OVERLAY);
-	BBitmap* icon = fForecastView->GetWeatherIcon();
-	if (icon != NULL)
-		DrawBitmap(icon, B_ORIGIN);
+	DrawBitmap(icon.bitmap, icon.frame, icon.frame.OffsetToCopy(B_ORIGIN));
 	SetDrawingMode(B_OP_COPY);
 }
 
@@ -109,17 +148,38 @@ ForecastDeskbarView::Instantiate(BMessage* archive)
 void
 ForecastDeskbarView::MessageReceived(BMessage* message)
 {
-	if (message->what == kUpdateForecastMessage) {
-		BString weatherDetailsText;
-		weatherDetailsText.SetToFormat(B_TRANSLATE("Temperature: %s\nCondition: %s\nLocation: %s"),
-			FormatString(fForecastView->Unit(), fForecastView->Temperature()).String(),
-			fForecastView->GetStatus().String(),
-			fForecastView->CityName().String());
-		SetToolTip(weatherDetailsText);
-
-		Invalidate();
-	} else
-		BView::MessageReceived(message);
+	switch (message->what) {
+		case B_NODE_MONITOR:
+			if (fModel.HandleNodeMonitor(message))
+				_Update();
+			break;
+
+		case kHourChangedMessage:
+			_Reload();
+			break;
+
+		case kForecastSnapshotMessage:
+		{
+			BReference<ForecastSnapshot> snapshot
+				= SnapshotMailbox::Receive(*message);
+			if (snapshot.Get() == NULL)
+				break;
+
+			if (message->GetInt64("location id", 0) != ForecastLocationId(
+					fModel.Latitude(), fModel.Longitude(), fModel.Unit()))
+				break;
+			if (fModel.SetSnapshot(snapshot.Get()))
+				_Update();
+			break;
+		}
+
+		case kFailureMessage:
+			// Tried again when the hour changes
+			break;
+
+		default:
+			BView::MessageReceived(message);
+	}
 }
 
 
@@ -153,6 +213,69 @@ ForecastDeskbarView::SetAppLocation(entry_ref location)
 }
 
 
+void
+ForecastDeskbarView::_Reload()
+{
+	bool stale;
+	bool changed = fModel.Reload(&stale);
+	if (stale)
+		_StartRefresh();
+
+	// Nothing happens in between, unless the settings or the store change
+	delete fHourRunner;
+	bigtime_t delay = (bigtime_t) (3600 - time(NULL) % 3600 + 1) * 1000000;
+	BMessage hourChanged(kHourChangedMessage);
+	fHourRunner = new(std::nothrow) BMessageRunner(BMessenger(this),
+		&hourChanged, delay, 1);
+
+	if (changed || ToolTip() == NULL)
+		_Update();
+}
+
+
+void
+ForecastDeskbarView::_Update()
+{
+	const char* condition = B_TRANSLATE_NOCOLLECT_ALL(
+		WeatherCondition(fModel.Condition()).text, "ForecastView", NULL);
+	BString temperature = "--";
+	if (fModel.HasWeather())
+		temperature = FormatString(fModel.Unit(), fModel.Temperature());
+	else
+		condition = B_TRANSLATE_NOCOLLECT_ALL("Not available", "ForecastView",
+			NULL);
+
+	BString weatherDetailsText;
+	weatherDetailsText.SetToFormat(B_TRANSLATE("Temperature: %s\nCondition: %s\nLocation: %s"),
+		temperature.String(), condition, fModel.City().String());
+	SetToolTip(weatherDetailsText);
+
+	Invalidate();
+}
+
+
+void
+ForecastDeskbarView::_StartRefresh()
+{
+	if (fCoordinator == NULL)
+		return;
+
+	// The Weather window or a replicant may be asking for the same
+	BMessenger target(this);
+	fCoordinator->Subscribe(target, fModel.Latitude(), fModel.Longitude(),
+		fModel.Unit());
+	fCoordinator->Refresh(target, kForecastTimeToLive);
+}
+
+
+void
+ForecastDeskbarView::_StopRefresh()
+{
+	if (fCoordinator != NULL)
+		fCoordinator->Unsubscribe(BMessenger(this));
+}
+
+
 extern "C" BView* instantiate_deskbar_item(float maxWidth, float maxHeight);
 
 
@@ -9,10 +9,15 @@
 #include <Entry.h>
 #include <Looper.h>
 #include <MessageRunner.h>
+#include <Referenceable.h>
 #include <SupportDefs.h>
 #include <View.h>
 
-#include "ForecastView.h"
+#include "DeskbarModel.h"
+#include "IconAtlas.h"
+
+
+class FetchCoordinator;
 
 
 class ForecastDeskbarView : public BView
@@ -24,6 +29,7 @@ public:
 					~ForecastDeskbarView();
 
 	virtual void	AttachedToWindow();
+	virtual void	DetachedFromWindow();
 	virtual void	MouseDown(BPoint point);
 	virtual void	MouseMoved(
 						BPoint point, 
@@ -36,8 +42,16 @@ public:
 	void 			SetAppLocation(entry_ref location);
 
 private:
-	ForecastView*	fForecastView;
-	BMessageRunner*	fMessageRunner;
+	void			_Reload();
+	void			_Update();
+	void			_StartRefresh();
+	void			_StopRefresh();
+
+	DeskbarModel	fModel;
+	IconAtlas*		fIcons;
+	uint32			fIconSize;
+	BMessageRunner*	fHourRunner;
+	FetchCoordinator*	fCoordinator;
 	entry_ref		fAppRef;
 };
 
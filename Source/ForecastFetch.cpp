@@ -0,0 +1,174 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#include <Url.h>
+
+#include <stdlib.h>
+
+#include <new>
+
+#include "ForecastFetch.h"
+#include "MainWindow.h"
+
+
+ForecastFetch::ForecastFetch(const BMessenger& target, DisplayUnit unit,
+	int32 timeToLive)
+	:
+	fTarget(target),
+	fUnit(unit),
+	fTimeToLive(timeToLive),
+	fLocations(NULL),
+	fCount(0),
+	fCapacity(0),
+	fThread(-1)
+{
+}
+
+
+ForecastFetch::~ForecastFetch()
+{
+	free(fLocations);
+}
+
+
+status_t
+ForecastFetch::AddLocation(double latitude, double longitude)
+{
+	if (fCount == fCapacity) {
+		int32 capacity = fCapacity > 0 ? fCapacity * 2 : 4;
+		forecast_location* locations = static_cast<forecast_location*>(
+			realloc(fLocations, capacity * sizeof(forecast_location)));
+		if (locations == NULL)
+			return B_NO_MEMORY;
+
+		fLocations = locations;
+		fCapacity = capacity;
+	}
+
+	fLocations[fCount].latitude = latitude;
+	fLocations[fCount].longitude = longitude;
+	fCount++;
+	return B_OK;
+}
+
+
+void
+ForecastFetch::SetReplyFields(const BMessage& fields)
+{
+	fReplyFields = fields;
+}
+
+
+status_t
+ForecastFetch::Run()
+{
+	// The thread keeps the fetch alive until it's done
+	AcquireReference();
+
+	thread_id thread
+		= spawn_thread(&_RunFunc, "Download Data", B_NORMAL_PRIORITY, this);
+	if (thread < 0) {
+		ReleaseReference();
+		return thread;
+	}
+
+	fThread = thread;
+	return resume_thread(thread);
+}
+
+
+int32
+ForecastFetch::_RunFunc(void* cookie)
+{
+	ForecastFetch* fetch = static_cast<ForecastFetch*>(cookie);
+	fetch->_Fetch();
+	fetch->ReleaseReference();
+	return 0;
+}
+
+
+void
+ForecastFetch::_Fetch()
+{
+	int32 batchCount = (fCount + kMaxBatchLocations - 1) / kMaxBatchLocations;
+	if (batchCount == 0)
+		return;
+
+	WSOpenMeteo** listeners = new(std::nothrow) WSOpenMeteo*[batchCount];
+	HttpRequest** requests = new(std::nothrow) HttpRequest*[batchCount];
+	if (listeners == NULL || requests == NULL) {
+		delete[] listeners;
+		delete[] requests;
+		_SendFailures(0);
+		return;
+	}
+
+	int32 created = 0;
+	for (; created < batchCount; created++) {
+		int32 first = created * kMaxBatchLocations;
+		int32 count = fCount - first;
+		if (count > kMaxBatchLocations)
+			count = kMaxBatchLocations;
+
+		WSOpenMeteo* listener
+			= new(std::nothrow) WSOpenMeteo(fTarget, WEATHER_REQUEST);
+		if (listener == NULL)
+			break;
+		if (listener->SetLocations(fLocations + first, count, fUnit, first)
+				!= B_OK) {
+			delete listener;
+			break;
+		}
+
+		BString urlString = listener->GetUrl();
+		listener->SetCacheTimeToLive(fTimeToLive);
+		listener->SetReplyFields(fReplyFields);
+
+#if B_HAIKU_VERSION < B_HAIKU_VERSION_1_PRE_BETA_6
+		BUrl url(urlString.String());
+#else
+		BUrl url(urlString.String(), true);
+#endif
+		HttpRequest* request = new(std::nothrow) HttpRequest(url, listener);
+		if (request == NULL) {
+			delete listener;
+			break;
+		}
+
+		listeners[created] = listener;
+		requests[created] = request;
+	}
+
+	// The batches go out together on one kept alive connection, each one
+	// is replied to as soon as its response is complete
+	HttpSession* session = HttpSession::Default();
+	if (session != NULL) {
+		session->Run(requests, created, this);
+		// The locations of the batches that couldn't be made
+		if (created < batchCount)
+			_SendFailures(created * kMaxBatchLocations);
+	} else
+		_SendFailures(0);
+
+	for (int32 i = 0; i < created; i++) {
+		delete requests[i];
+		delete listeners[i];
+	}
+	delete[] listeners;
+	delete[] requests;
+}
+
+
+void
+ForecastFetch::_SendFailures(int32 first)
+{
+	// Every location gets its reply, otherwise it would wait for one forever
+	for (int32 location = first; location < fCount; location++) {
+		BMessage message(kFailureMessage);
+		message.AddInt32("location", location);
+		message.Append(fReplyFields);
+		fTarget.SendMessage(&message);
+	}
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _FORECASTFETCH_H_
+#define _FORECASTFETCH_H_
+
+
+#include <Message.h>
+#include <Messenger.h>
+
+#include "CancellationToken.h"
+#include "WSOpenMeteo.h"
+
+
+// Downloads the forecasts of any number of locations in a thread of its
+// own, kMaxBatchLocations per request, all requests pipelined through the
+// HttpSession. The replies are the ones of
+// WSOpenMeteo: a kForecastSnapshotMessage per location, with its index in
+// the "location" field, or a kFailureMessage for each location of a
+// request that failed or couldn't be made.
+class ForecastFetch : public CancellationToken
+{
+public:
+						ForecastFetch(const BMessenger& target,
+							DisplayUnit unit, int32 timeToLive);
+	virtual				~ForecastFetch();
+
+			status_t	AddLocation(double latitude, double longitude);
+			int32		CountLocations() const { return fCount; }
+
+			// Copied into every reply
+			void		SetReplyFields(const BMessage& fields);
+
+			status_t	Run();
+			// Valid once Run() succeeded
+			thread_id	Thread() const { return fThread; }
+
+private:
+	static	int32		_RunFunc(void* cookie);
+			void		_Fetch();
+			void		_SendFailures(int32 first);
+
+			BMessenger	fTarget;
+			DisplayUnit	fUnit;
+			int32		fTimeToLive;
+			BMessage	fReplyFields;
+			forecast_location* fLocations;
+			int32		fCount;
+			int32		fCapacity;
+			thread_id	fThread;
+};
+
+
+#endif // _FORECASTFETCH_H_
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#include <new>
+#include <time.h>
+
+#include <Autolock.h>
+#include <List.h>
+#include <Locker.h>
+
+#include "ForecastSnapshot.h"
+
+#include "HourlyForecast.h"
+
+
+static const int64 kSecondsPerDay = 24 * 60 * 60;
+
+
+struct mailbox_entry {
+	int64		locationId;
+	BReference<ForecastSnapshot> snapshot;
+};
+
+// One entry per location the team fetched, which are few
+static BLocker sMailboxLock("snapshot mailbox");
+static BList sMailbox;
+
+
+ForecastSnapshot::ForecastSnapshot(const forecast_data& data, int64 fetchTime,
+	int64 currentTime)
+	:
+	fData(data),
+	fFetchTime(fetchTime),
+	fCurrentTime(currentTime >= 0 ? currentTime : time(NULL))
+{
+	// The current conditions always follow the present hour, also when
+	// the data comes from the cache
+	if (fData.hourly.count > 0) {
+		if (fData.daily.count == 0)
+			DeriveDailyWeather(fData.hourly, fData.utcOffset, fData.daily);
+		DeriveCurrentWeather(fData.hourly, fCurrentTime, fData.current);
+	}
+
+	if (fData.daily.count > kMaxForecastDays)
+		fData.daily.count = kMaxForecastDays;
+
+	// Daily times are the local midnight of the forecast location, so
+	// the weekday is taken in its time zone rather than in ours.
+	// 1970-01-01 was a Thursday, weekdays count from Monday = 1.
+	for (int32 day = 0; day < fData.daily.count; day++) {
+		int64 days = (fData.daily.time[day] + fData.utcOffset) / kSecondsPerDay;
+		fDayOfWeek[day] = (days + 3) % 7 + 1;
+	}
+}
+
+
+bool
+ForecastSnapshot::HasCurrentWeather() const
+{
+	return fData.current.valid;
+}
+
+
+int32
+ForecastSnapshot::Temperature() const
+{
+	return (int32) fData.current.temperature;
+}
+
+
+int32
+ForecastSnapshot::Condition() const
+{
+	return fData.current.weatherCode;
+}
+
+
+bool
+ForecastSnapshot::IsDay() const
+{
+	return fData.current.isDay;
+}
+
+
+int32
+ForecastSnapshot::CountDays() const
+{
+	return fData.daily.count;
+}
+
+
+int32
+ForecastSnapshot::FirstDay() const
+{
+	// A day ends where the next one starts, which isn't always 24 hours
+	// later when the clocks change
+	int32 day = 0;
+	for (; day < fData.daily.count; day++) {
+		int64 end = day + 1 < fData.daily.count ? fData.daily.time[day + 1]
+			: fData.daily.time[day] + kSecondsPerDay;
+		if (end > fCurrentTime)
+			break;
+	}
+	return day;
+}
+
+
+int32
+ForecastSnapshot::DayOfWeek(int32 day) const
+{
+	return fDayOfWeek[day];
+}
+
+
+int32
+ForecastSnapshot::HighTemperature(int32 day) const
+{
+	return (int32) fData.daily.maxTemperature[day];
+}
+
+
+int32
+ForecastSnapshot::LowTemperature(int32 day) const
+{
+	return (int32) fData.daily.minTemperature[day];
+}
+
+
+int32
+ForecastSnapshot::DayCondition(int32 day) const
+{
+	return fData.daily.weatherCode[day];
+}
+
+
+status_t
+SnapshotMailbox::Post(BMessage& message, int64 locationId,
+	ForecastSnapshot* snapshot)
+{
+	BAutolock locker(sMailboxLock);
+
+	mailbox_entry* entry = NULL;
+	for (int32 i = 0; i < sMailbox.CountItems(); i++) {
+		mailbox_entry* item = (mailbox_entry*) sMailbox.ItemAt(i);
+		if (item->locationId == locationId) {
+			entry = item;
+			break;
+		}
+	}
+	if (entry == NULL) {
+		entry = new(std::nothrow) mailbox_entry;
+		if (entry == NULL)
+			return B_NO_MEMORY;
+		if (!sMailbox.AddItem(entry)) {
+			delete entry;
+			return B_NO_MEMORY;
+		}
+		entry->locationId = locationId;
+	}
+	entry->snapshot.SetTo(snapshot);
+
+	return message.AddInt64("snapshot", locationId);
+}
+
+
+BReference<ForecastSnapshot>
+SnapshotMailbox::Receive(const BMessage& message)
+{
+	BReference<ForecastSnapshot> snapshot;
+
+	int64 locationId;
+	if (message.FindInt64("snapshot", &locationId) != B_OK)
+		return snapshot;
+
+	BAutolock locker(sMailboxLock);
+	for (int32 i = 0; i < sMailbox.CountItems(); i++) {
+		mailbox_entry* entry = (mailbox_entry*) sMailbox.ItemAt(i);
+		if (entry->locationId == locationId) {
+			snapshot = entry->snapshot;
+			break;
+		}
+	}
+	return snapshot;
+}
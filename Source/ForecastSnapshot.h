@@ -0,0 +1,68 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _FORECASTSNAPSHOT_H_
+#define _FORECASTSNAPSHOT_H_
+
+
+#include <Message.h>
+#include <Referenceable.h>
+
+#include "ForecastData.h"
+
+
+// The complete result of one refresh. It is never modified once built, so
+// it can be handed from the download thread to any number of views, which
+// keep it alive by holding a BReference to it.
+// When only hourly data was fetched, the daily and current values are
+// derived from it, the current ones for the time the snapshot is built
+// unless another one is given.
+class ForecastSnapshot : public BReferenceable
+{
+public:
+						ForecastSnapshot(const forecast_data& data,
+							int64 fetchTime, int64 currentTime = -1);
+
+			const forecast_data& Data() const { return fData; }
+			int64		FetchTime() const { return fFetchTime; }
+
+			bool		HasCurrentWeather() const;
+			int32		Temperature() const;
+			int32		Condition() const;
+			bool		IsDay() const;
+
+			int32		CountDays() const;
+			// The first day that isn't over at the time of the current
+			// weather, a cached forecast may start days earlier
+			int32		FirstDay() const;
+			int32		DayOfWeek(int32 day) const;
+			int32		HighTemperature(int32 day) const;
+			int32		LowTemperature(int32 day) const;
+			int32		DayCondition(int32 day) const;
+
+private:
+			forecast_data fData;
+			int64		fFetchTime;
+			int64		fCurrentTime;
+			int8		fDayOfWeek[kMaxForecastDays];
+};
+
+
+// Hands snapshots from looper to looper within the team. A message holding
+// a pointer that owns a reference would leak it whenever the message is
+// never handled, because its looper quit or its handler went away, so the
+// mailbox keeps the references instead: the latest snapshot of every
+// location, which the messages only name.
+class SnapshotMailbox
+{
+public:
+	static	status_t	Post(BMessage& message, int64 locationId,
+							ForecastSnapshot* snapshot);
+			// The latest snapshot of the location the message names, which
+			// may be newer than the one that was posted with it
+	static	BReference<ForecastSnapshot> Receive(const BMessage& message);
+};
+
+
+#endif // _FORECASTSNAPSHOT_H_
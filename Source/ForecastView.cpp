@@ -11,10 +11,10 @@
 #include <Bitmap.h>
 #include <Catalog.h>
 #include <ControlLook.h>
+#include <DurationFormat.h>
 #include <FindDirectory.h>
 #include <Font.h>
 #include <GroupLayout.h>
-#include <IconUtils.h>
 #include <LayoutBuilder.h>
 #include <Locale.h>
 #include <Menu.h>
@@ -27,14 +27,21 @@
 #include <TranslationUtils.h>
 #include <DataIO.h>
 #include <Url.h>
-#include <UrlProtocolRoster.h>
-#include <UrlRequest.h>
+
+#include <time.h>
+
+#include <new>
 
 #include "App.h"
+#include "FetchCoordinator.h"
+#include "ForecastCache.h"
+#include "ForecastStore.h"
 #include "ForecastView.h"
+#include "HourlyChartView.h"
 #include "MainWindow.h"
 #include "PreferencesWindow.h"
 #include "Util.h"
+#include "WeatherCondition.h"
 #include "WSOpenMeteo.h"
 
 
@@ -51,7 +58,11 @@ const double kDefaultLatitude = 37.45383;
 const int32 kMaxUpdateDelay = 240;
 const int32 kMaxForecastDay = 5;
 const int32 kReconnectionDelay = 5;
-int32 fSizeDeskBarIcon = 10;
+// Reloads asked for within this time are done as one
+const bigtime_t kReloadCoalesceDelay = 200000;
+
+const uint32 kStartReloadMessage = 'StRl';
+const uint32 kLatencyPaintedMessage = 'LtPt';
 
 
 #undef B_TRANSLATION_CONTEXT
@@ -103,17 +114,25 @@ ForecastView::ForecastView(BRect frame)
 	:
 	BView(frame, B_TRANSLATE_SYSTEM_NAME("Weather"), B_FOLLOW_NONE,
 		B_WILL_DRAW | B_FRAME_EVENTS | B_DRAW_ON_CHILDREN),
-	fDownloadThread(-1),
+	fForcedForecast(false),
+	fReloadRunner(NULL),
+	fCoordinator(NULL),
 	fReplicated(false),
+	fHeadless(false),
 	fUpdateDelay(kMaxUpdateDelay),
 	fShowForecast(true),
 	fLatitude(0),
 	fLongitude(0),
 	fTemperature(0),
 	fCondition(0),
+	fIsDay(true),
 	fAutoUpdate(NULL),
+	fScheduler(kMaxUpdateDelay * 60),
+	fStoreSequence(0),
+	fLatencyPending(false),
 	fDelayUpdateAfterReconnection(NULL),
-	fConnected(false)
+	fConnected(false),
+	fIcons(IconAtlas::Acquire())
 {
 	BMessage settings;
 	LoadSettings(settings);
@@ -122,22 +141,60 @@ ForecastView::ForecastView(BRect frame)
 }
 
 
+ForecastView::ForecastView(BRect frame, BMessage* settings,
+	ForecastSnapshot* snapshot)
+	:
+	BView(frame, B_TRANSLATE_SYSTEM_NAME("Weather"), B_FOLLOW_NONE,
+		B_WILL_DRAW | B_FRAME_EVENTS | B_DRAW_ON_CHILDREN),
+	fForcedForecast(false),
+	fReloadRunner(NULL),
+	fCoordinator(NULL),
+	fReplicated(false),
+	fHeadless(true),
+	fUpdateDelay(kMaxUpdateDelay),
+	fShowForecast(true),
+	fLatitude(0),
+	fLongitude(0),
+	fTemperature(0),
+	fCondition(0),
+	fIsDay(true),
+	fSnapshot(snapshot),
+	fAutoUpdate(NULL),
+	fScheduler(kMaxUpdateDelay * 60),
+	fStoreSequence(0),
+	fLatencyPending(false),
+	fDelayUpdateAfterReconnection(NULL),
+	fConnected(false),
+	fIcons(IconAtlas::Acquire())
+{
+	_ApplyState(settings);
+	_Init();
+}
+
+
 
 ForecastView::ForecastView(BMessage* archive)
 	:
 	BView(archive),
-	fDownloadThread(-1),
 	fForcedForecast(false),
+	fReloadRunner(NULL),
+	fCoordinator(NULL),
 	fReplicated(true),
+	fHeadless(false),
 	fUpdateDelay(kMaxUpdateDelay),
 	fShowForecast(false),
 	fLatitude(0),
 	fLongitude(0),
 	fTemperature(0),
 	fCondition(0),
+	fIsDay(true),
 	fAutoUpdate(NULL),
+	fScheduler(kMaxUpdateDelay * 60),
+	fStoreSequence(0),
+	fLatencyPending(false),
 	fDelayUpdateAfterReconnection(NULL),
-	fConnected(false)
+	fConnected(false),
+	fIcons(IconAtlas::Acquire())
 {
 	_ApplyState(archive);
 	// Use _Init to rebuild the View with deep = false in Archive
@@ -148,19 +205,33 @@ ForecastView::ForecastView(BMessage* archive)
 ForecastView::~ForecastView()
 {
 	StopReload();
-	_DeleteBitmaps();
+	FetchCoordinator::Release(fCoordinator);
 	delete fAutoUpdate;
+	delete fReloadRunner;
+	IconAtlas::Release(fIcons);
 }
 
 
 void
 ForecastView::_Init()
 {
-	_LoadBitmaps();
-	// Icon for weather
+	// Icon for weather. The one of the last known condition is the first
+	// one rasterized, the others only when they are shown.
+	int32 condition = WC_MAINLY_CLEAR;
+	bool isDay = true;
+	BReference<ForecastSnapshot> snapshot = fSnapshot;
+	if (snapshot.Get() == NULL) {
+		ForecastCache cache(fLatitude, fLongitude, fDisplayUnit);
+		snapshot.SetTo(cache.Load(), true);
+	}
+	if (snapshot.Get() != NULL && snapshot->HasCurrentWeather()) {
+		condition = snapshot->Condition();
+		isDay = snapshot->IsDay();
+	}
+
 	fConditionButton
 		= new TransparentButton("condition", "", new BMessage(kUpdateMessage));
-	fConditionButton->SetIcon(fFewClouds[LARGE_ICON]);
+	_SetConditionIcon(condition, isDay);
 	fConditionButton->SetFlat(true);
 
 	// Description (e.g. "Mostly showers", "Cloudy", "Sunny").
@@ -186,15 +257,27 @@ ForecastView::_Init()
 	forecastLayout->SetInsets(0, 2, 0, 0);
 	forecastLayout->SetSpacing(2);
 
+	// The tiles have to fit the scaled icons
+	float scale = IconAtlas::ScaleFactor();
+	atlas_icon placeholder;
+	if (!GetWeatherIcon(WC_MAINLY_CLEAR, SMALL_ICON, placeholder))
+		placeholder.bitmap = NULL;
 	for (int32 i = 0; i < kMaxForecastDay; i++) {
-		fForecastDayView[i] = new ForecastDayView(BRect(0, 0, 62, 112));
-		fForecastDayView[i]->SetIcon(fFewClouds[SMALL_ICON]);
+		fForecastDayView[i] = new ForecastDayView(
+			BRect(0, 0, 62 * scale, 112 * scale));
+		fForecastDayView[i]->SetIcon(placeholder);
 		fForecastDayView[i]->SetDisplayUnit(fDisplayUnit);
 		forecastLayout->AddView(fForecastDayView[i]);
 	}
 
-	if (!fShowForecast)
+	// Under the current conditions, shown along with the day tiles
+	fHourlyChart = new HourlyChartView("hourlyChart");
+	fHourlyChart->SetDisplayUnit(fDisplayUnit);
+
+	if (!fShowForecast) {
+		fHourlyChart->Hide();
 		fForecastView->Hide();
+	}
 
 	BLayoutBuilder::Group<>(this, B_VERTICAL, 0)
 		.SetInsets(5, 5, 5, 5)
@@ -207,7 +290,8 @@ ForecastView::_Init()
 					.Add(fCityView)
 					.End()
 				.End()
-			.Add(fForecastView, 0, 1, 2)
+			.Add(fHourlyChart, 0, 1, 2)
+			.Add(fForecastView, 0, 2, 2)
 			.End()
 		.AddGroup(B_HORIZONTAL, 0)
 			.AddGlue()
@@ -347,19 +431,45 @@ ForecastView::AttachedToWindow()
 	if (fReplicated) {
 		fConditionButton->SetTarget(BMessenger(this));
 	}
-	
+
+	if (fHeadless) {
+		if (fSnapshot.Get() != NULL)
+			_ApplySnapshot(fSnapshot);
+		BView::AttachedToWindow();
+		return;
+	}
+
 	BMessenger view(this, Window());
-	BMessage autoUpdateMessage(kAutoUpdateMessage);
-	fAutoUpdate = new BMessageRunner(
-		view, &autoUpdateMessage, (bigtime_t) fUpdateDelay * 60 * 1000 * 1000);
+	fScheduler.SetInterval(fUpdateDelay * 60);
+
+	// Also gets what the other views have downloaded for our city
+	if (fCoordinator == NULL)
+		fCoordinator = FetchCoordinator::Acquire();
+	if (fCoordinator != NULL) {
+		fRefreshTarget = view;
+		fCoordinator->Subscribe(fRefreshTarget, fLatitude, fLongitude,
+			fDisplayUnit);
+	}
+
+	// Paint the last known forecast right away, the network is only asked
+	// when it is too old
+	bool stale = _LoadCachedForecast();
+	if (fSnapshot.Get() != NULL) {
+		fScheduler.Succeeded(fSnapshot->FetchTime());
+		if (!stale)
+			_ScheduleRefresh();
+	}
+
 	fConnected = _NetworkConnected();
 	if (!fConnected) {
-		SetCondition(B_TRANSLATE("No network"));
+		_ShowOffline();
 		start_watching_network(
 			B_WATCH_NETWORK_INTERFACE_CHANGES | B_WATCH_NETWORK_LINK_CHANGES,
 			this);
-	} else
+	} else if (fSnapshot.Get() == NULL)
 		view.SendMessage(new BMessage(kUpdateMessage));
+	else if (stale)
+		view.SendMessage(new BMessage(kAutoUpdateMessage));
 
 	BView::AttachedToWindow();
 }
@@ -370,7 +480,8 @@ ForecastView::AllAttached()
 {
 	BView::AllAttached();
 	SetTextColor(fTextColor);
-	if (!_SupportTransparent() && fBackgroundColor == B_TRANSPARENT_COLOR)
+	if (!fHeadless && !_SupportTransparent()
+		&& fBackgroundColor == B_TRANSPARENT_COLOR)
 		fBackgroundColor = ui_color(B_PANEL_BACKGROUND_COLOR);
 	SetBackgroundColor(fBackgroundColor);
 }
@@ -383,6 +494,24 @@ ForecastView::Draw(BRect updateRect)
 		SetHighColor(fBackgroundColor);
 		FillRect(updateRect);
 	}
+
+	// Handled once this update, children included, is done
+	if (fLatencyPending) {
+		fLatencyPending = false;
+		Looper()->PostMessage(kLatencyPaintedMessage, this);
+	}
+}
+
+
+void
+ForecastView::WindowActivated(bool active)
+{
+	BView::WindowActivated(active);
+
+	// Someone looks at it now, so don't show data older than needed
+	if (active && !fHeadless && !_PollStore()
+		&& fScheduler.ShouldRefreshOnShow(time(NULL)))
+		Reload();
 }
 
 
@@ -443,19 +572,40 @@ ForecastView::MessageReceived(BMessage* msg)
 
 	uint32 what = msg->what;
 	switch (msg->what) {
-		case kDataMessage:
+		case kForecastSnapshotMessage:
+		{
+			BReference<ForecastSnapshot> snapshot
+				= SnapshotMailbox::Receive(*msg);
+			if (snapshot.Get() == NULL)
+				break;
+
+			// Late results for the city we had before are dropped
+			if (msg->GetInt64("location id", 0) != ForecastLocationId(
+					fLatitude, fLongitude, fDisplayUnit))
+				break;
+
+			refresh_latency latency;
+			bool timed = FindLatency(*msg, latency);
+			if (timed)
+				latency.ended[LATENCY_DELIVERY] = system_time();
+
+			_ApplySnapshot(snapshot.Get());
+			fScheduler.Succeeded(snapshot->FetchTime());
+			_ScheduleRefresh();
+
+			if (timed && !fHeadless) {
+				fLatency = latency;
+				fLatencyPending = true;
+				Invalidate();
+			}
+			break;
+		}
+		case kLatencyPaintedMessage:
 		{
-			// BString text("");
-			msg->FindInt32("temp", &fTemperature);
-			int32 condition = 0;
-			if (msg->FindInt32("condition", &condition) == B_OK)
-				fCondition = condition;
-			// msg->FindString("text", &text);
-
-			BString tempText = FormatString(fDisplayUnit, fTemperature);
-			fTemperatureView->SetText(tempText.String());
-			SetCondition(_GetWeatherMessage(fCondition));
-			fConditionButton->SetIcon(GetWeatherIcon(fCondition, LARGE_ICON));
+			fLatency.ended[LATENCY_PAINT] = system_time();
+			LatencyLog* log = LatencyLog::Default();
+			if (log != NULL)
+				log->Add(fLatency);
 			break;
 		}
 		case kUpdateCityMessage:
@@ -473,6 +623,21 @@ ForecastView::MessageReceived(BMessage* msg)
 				SetCityId(cityId);
 				SetLatitude(latitude);
 				SetLongitude(longitude);
+
+				// The new city is followed even when its cached forecast
+				// is fresh, only the download is left out then
+				bool stale = _LoadCachedForecast();
+				if (fCoordinator != NULL) {
+					fRefreshTarget = BMessenger(this, Window());
+					fCoordinator->Subscribe(fRefreshTarget, fLatitude,
+						fLongitude, fDisplayUnit);
+				}
+				if (!stale) {
+					fScheduler.Succeeded(fSnapshot->FetchTime());
+					_ScheduleRefresh();
+					break;
+				}
+
 				SetCondition(
 					B_TRANSLATE("Loading" B_UTF8_ELLIPSIS));
 				// forcedForecast use forecast request to retrieve full city
@@ -481,45 +646,24 @@ ForecastView::MessageReceived(BMessage* msg)
 			}
 			break;
 		}
-		case kForecastDataMessage:
+		case kFailureMessage:
 		{
-			BString text("");
-			int32 forecastNum;
-			BString day;
-			int32 condition;
-			int32 high, low;
-
-			msg->FindInt32("forecast", &forecastNum);
-			msg->FindInt32("high", &high);
-			msg->FindInt32("low", &low);
-			msg->FindInt32("condition", &condition);
-			msg->FindString("text", &text);
-			msg->FindString("day", &day);
-
-			text = _GetWeatherMessage(condition);
-			day = _GetDayText(day);
-
-			if (forecastNum < 0 || forecastNum >= kMaxForecastDay)
+			if (msg->GetInt64("location id", 0) != ForecastLocationId(
+					fLatitude, fLongitude, fDisplayUnit))
 				break;
 
-			fForecastDayView[forecastNum]->SetDayLabel(day);
-			fForecastDayView[forecastNum]->SetIcon(
-				GetWeatherIcon(condition, SMALL_ICON));
-			fForecastDayView[forecastNum]->SetHighTemp(high);
-			fForecastDayView[forecastNum]->SetLowTemp(low);
-			fForecastDayView[forecastNum]->SetToolTip(text);
-			break;
-		}
-		case kFailureMessage:
-		{
 			fConnected = _NetworkConnected();
 			if (!fConnected) {
-				SetCondition(B_TRANSLATE("No network"));
+				_ShowOffline();
 				start_watching_network(B_WATCH_NETWORK_INTERFACE_CHANGES
 						| B_WATCH_NETWORK_LINK_CHANGES,
 					this);
-			} else
+			} else {
 				SetCondition(B_TRANSLATE("Connection error"));
+				fScheduler.Failed(time(NULL),
+					msg->GetInt32("retry after", 0));
+				_ScheduleRefresh();
+			}
 			break;
 		}
 		case kUpdateMessage:
@@ -527,22 +671,22 @@ ForecastView::MessageReceived(BMessage* msg)
 				break;
 			SetCondition(
 				B_TRANSLATE("Loading" B_UTF8_ELLIPSIS));
-			// fall through
-		case kAutoUpdateMessage:
 			Reload();
 			break;
+		case kAutoUpdateMessage:
+			// Put off while the window can't be seen, until it's shown again.
+			// Another team may have stored a newer forecast meanwhile.
+			if (_IsVisible() && !_PollStore())
+				Reload();
+			break;
+		case kStartReloadMessage:
+			_StartReload();
+			break;
 		case kShowForecastMessage:
 			_ShowForecast(!fShowForecast);
 			if (fShowForecast)
 				Reload();
 			break;
-		case kUpdateCityName:
-		{
-			BString newCityName;
-			if (msg->FindString("city", &newCityName) == B_OK)
-				SetCityName(newCityName);
-			break;
-		}
 		case kUpdateTTLMessage:
 		{
 			int32 ttl;
@@ -580,380 +724,175 @@ ForecastView::MessageReceived(BMessage* msg)
 }
 
 
-void
-ForecastView::_LoadBitmaps()
+const char*
+ForecastView::_GetWeatherMessage(int32 condition)
 {
-	_LoadIcons(fAlert, 'rGFX', "Artwork/weather_alert.hvif");
-	_LoadIcons(fClearNight, 'rGFX', "Artwork/weather_clear_night.hvif");
-	_LoadIcons(fClear, 'rGFX', "Artwork/weather_clear.hvif");
-	_LoadIcons(fClouds, 'rGFX', "Artwork/weather_clouds.hvif");
-	_LoadIcons(fCold, 'rGFX', "Artwork/weather_cold.hvif");
-	_LoadIcons(fLightDrizzle, 'rGFX', "Artwork/weather_drizzle.hvif");
-	_LoadIcons(fModerateDenseDrizzle, 'rGFX', "Artwork/weather_icon.hvif");
-	_LoadIcons(fFewClouds, 'rGFX', "Artwork/weather_few_clouds.hvif");
-	_LoadIcons(fFog, 'rGFX', "Artwork/weather_fog.hvif");
-	_LoadIcons(fFreezingDrizzle, 'rGFX', "Artwork/weather_freezing_drizzle.hvif");
-	_LoadIcons(fIsolatedThunderstorm, 'rGFX', "Artwork/weather_isolated_thunderstorm.hvif");
-	_LoadIcons(fLightSnow, 'rGFX', "Artwork/weather_light_snow.hvif");
-	_LoadIcons(fMixedSnowRain, 'rGFX', "Artwork/weather_mixed_snow_rain.hvif");
-	_LoadIcons(fMostlyCloudyNight, 'rGFX', "Artwork/weather_mostly_cloudy_night.hvif");
-	_LoadIcons(fNightFewClouds, 'rGFX', "Artwork/weather_night_few_clouds.hvif");
-	_LoadIcons(fRainingScattered, 'rGFX', "Artwork/weather_raining_scattered.hvif");
-	_LoadIcons(fRaining, 'rGFX', "Artwork/weather_raining.hvif");
-	_LoadIcons(fSevereThunderstorm, 'rGFX', "Artwork/weather_severe_thunderstorm.hvif");
-	_LoadIcons(fIsolatedThundershowers, 'rGFX', "Artwork/weather_isolated_thundershowers.hvif");
-	_LoadIcons(fShining, 'rGFX', "Artwork/weather_shining.hvif");
-	_LoadIcons(fShiny, 'rGFX', "Artwork/weather_shiny.hvif");
-	_LoadIcons(fSnow, 'rGFX', "Artwork/weather_snow.hvif");
-	_LoadIcons(fStorm, 'rGFX', "Artwork/weather_storm.hvif");
-	_LoadIcons(fThunder, 'rGFX', "Artwork/weather_thunder.hvif");
-	_LoadIcons(fTornado, 'rGFX', "Artwork/weather_tornado.hvif");
-	_LoadIcons(fTropicalStorm, 'rGFX', "Artwork/weather_tropical_storm.hvif");
-	_LoadIcons(fCloud, 'rGFX', "Artwork/weather_cloud.hvif");
-	_LoadIcons(fPartlyCloudy, 'rGFX', "Artwork/weather_partly_cloudy.hvif");
-	_LoadIcons(fHurricane, 'rGFX', "Artwork/weather_hurricane.hvif");
-	_LoadIcons(fSmoky, 'rGFX', "Artwork/weather_smoky.hvif");
-	_LoadIcons(fScatteredSnowShowers, 'rGFX', "Artwork/weather_scattered_snow_showers.hvif");
-	_LoadIcons(fSnowShowers, 'rGFX', "Artwork/weather_snow_showers.hvif");
+	return B_TRANSLATE_NOCOLLECT(WeatherCondition(condition).text);
 }
 
 
-void
-ForecastView::_DeleteBitmaps()
+int32
+ForecastView::Temperature()
 {
-	_DeleteIcons(fAlert);
-	_DeleteIcons(fClearNight);
-	_DeleteIcons(fClear);
-	_DeleteIcons(fClouds);
-	_DeleteIcons(fCold);
-	_DeleteIcons(fLightDrizzle);
-	_DeleteIcons(fModerateDenseDrizzle);
-	_DeleteIcons(fFewClouds);
-	_DeleteIcons(fFog);
-	_DeleteIcons(fFreezingDrizzle);
-	_DeleteIcons(fIsolatedThunderstorm);
-	_DeleteIcons(fLightSnow);
-	_DeleteIcons(fMixedSnowRain);
-	_DeleteIcons(fMostlyCloudyNight);
-	_DeleteIcons(fNightFewClouds);
-	_DeleteIcons(fRainingScattered);
-	_DeleteIcons(fRaining);
-	_DeleteIcons(fIsolatedThundershowers);
-	_DeleteIcons(fSevereThunderstorm);
-	_DeleteIcons(fShining);
-	_DeleteIcons(fShiny);
-	_DeleteIcons(fSnow);
-	_DeleteIcons(fStorm);
-	_DeleteIcons(fThunder);
-	_DeleteIcons(fTornado);
-	_DeleteIcons(fTropicalStorm);
-	_DeleteIcons(fCloud);
-	_DeleteIcons(fHurricane);
-	_DeleteIcons(fScatteredSnowShowers);
-	_DeleteIcons(fSmoky);
-	_DeleteIcons(fSnowShowers);
+	return fTemperature;
 }
 
 
-void
-ForecastView::_DeleteIcons(BBitmap* bitmap[3])
+bool
+ForecastView::GetWeatherIcon(int32 condition, weatherIconSize iconSize,
+	atlas_icon& icon, bool isDay)
 {
-	delete bitmap[0];
-	delete bitmap[1];
-	delete bitmap[2];
-	bitmap[0] = NULL;
-	bitmap[1] = NULL;
-	bitmap[2] = NULL;
+	if (fIcons == NULL)
+		return false;
+
+	uint32 size = iconSize == SMALL_ICON ? kSizeSmallIcon : kSizeLargeIcon;
+	size = (uint32) (size * IconAtlas::ScaleFactor());
+
+	const weather_condition& info = WeatherCondition(condition);
+	return fIcons->GetIcon(isDay ? info.icon : info.nightIcon, size, icon);
 }
 
 
 void
-ForecastView::_LoadIcons(BBitmap* bitmap[3], uint32 type, const char* name)
+ForecastView::_SetConditionIcon(int32 condition, bool isDay)
 {
-	bitmap[0] = NULL;
-	bitmap[1] = NULL;
-	bitmap[2] = NULL;
+	// The button keeps a copy of its own
+	BBitmap* icon = NULL;
+	atlas_icon source;
+	if (GetWeatherIcon(condition, LARGE_ICON, source, isDay)) {
+		icon = new(std::nothrow) BBitmap(
+			source.frame.OffsetToCopy(B_ORIGIN), 0, B_RGBA32);
+		if (icon != NULL)
+			icon->ImportBits(source.bitmap, source.frame.LeftTop(), B_ORIGIN,
+				source.frame.IntegerWidth() + 1,
+				source.frame.IntegerHeight() + 1);
+	}
+	fConditionButton->SetIcon(icon);
+	delete icon;
+}
 
-	const void* data = NULL;
 
-	app_info info;
-	status_t status = be_roster->GetAppInfo(kSignature, &info);
-	if (status != B_OK)
-		return;
-		
-	BResources resources(&info.ref);
-	status = resources.InitCheck();
-	size_t dataSize;
-	if (status == B_OK)
-		data = resources.LoadResource(type, name, &dataSize);
-
-	if (data != NULL) {
-		BBitmap* smallBitmap = new BBitmap(
-			BRect(0, 0, kSizeSmallIcon - 1, kSizeSmallIcon - 1), 0, B_RGBA32);
-		BBitmap* largeBitmap = new BBitmap(
-			BRect(0, 0, kSizeLargeIcon - 1, kSizeLargeIcon - 1), 0, B_RGBA32);
-		BBitmap* deskbarBitmap = new BBitmap(
-			BRect(0, 0, fSizeDeskBarIcon - 1, fSizeDeskBarIcon - 1), 0,
-			B_RGBA32);
-
-		status_t status = smallBitmap->InitCheck();
-		if (status == B_OK) {
-			status = BIconUtils::GetVectorIcon(
-				reinterpret_cast<const uint8*>(data), dataSize, smallBitmap);
-		};
-		status = largeBitmap->InitCheck();
-		if (status == B_OK) {
-			status = BIconUtils::GetVectorIcon(
-				reinterpret_cast<const uint8*>(data), dataSize, largeBitmap);
-		};
-		status = deskbarBitmap->InitCheck();
-		if (status == B_OK) {
-			status = BIconUtils::GetVectorIcon(
-				reinterpret_cast<const uint8*>(data), dataSize, deskbarBitmap);
-		};
-		bitmap[0] = smallBitmap;
-		bitmap[1] = largeBitmap;
-		bitmap[2] = deskbarBitmap;
-	};
+BString
+ForecastView::_GetDayText(int32 dayOfWeek) const
+{
+	BString translateDayName;
+	status_t result = fDateFormat.GetDayName((BWeekday) dayOfWeek,
+		translateDayName, B_LONG_DATE_FORMAT);
+	return result == B_OK ? translateDayName : BString("--");
 }
 
 
-const char*
-ForecastView::_GetWeatherMessage(int32 condition)
+void
+ForecastView::_ApplySnapshot(ForecastSnapshot* snapshot)
 {
-	//	switch (condition) {
-	//		case WC_TORNADO:				return B_TRANSLATE("Tornado");
-	//		case WC_TROPICAL_STORM:			return B_TRANSLATE("Tropical
-	//storm"); 		case WC_HURRICANE:				return B_TRANSLATE("Hurricane");
-	//		case WC_SEVERE_THUNDERSTORM:	return B_TRANSLATE("Severe
-	//thunderstorms"); 		case WC_STORM:					return
-	//B_TRANSLATE("Thunderstorms"); 		case WC_MIXED_SNOW_RAIN:		return
-	//B_TRANSLATE("Mixed rain and snow"); 		case WC_FREEZING_DRIZZLE:		return
-	//B_TRANSLATE("Freezing drizzle"); 		case WC_DRIZZE:					return
-	//B_TRANSLATE("Drizzle"); 		case WC_RAINING: 				return
-	//B_TRANSLATE("Raining"); 		case WC_RAINING_SCATTERED: 		return
-	//B_TRANSLATE("Showers"); 		case WC_LIGHT_SNOW: 			return
-	//B_TRANSLATE("Light snow showers"); 		case WC_SNOW: 					return
-	//B_TRANSLATE("Snow"); 		case WC_FOG: 					return
-	//B_TRANSLATE("Fog"); 		case WC_SMOKY: 					return
-	//B_TRANSLATE("Smoky"); 		case WC_WINDY: 					return
-	//B_TRANSLATE("Windy"); 		case WC_COLD: 					return
-	//B_TRANSLATE("Cold"); 		case WC_CLOUD: 					return
-	//B_TRANSLATE("Cloudy"); 		case WC_MOSTLY_CLOUDY_NIGHT: 	return
-	//B_TRANSLATE("Mostly cloudy"); 		case WC_MOSTLY_CLOUDY_DAY: 		return
-	//B_TRANSLATE("Mostly cloudy"); 		case WC_FEW_CLOUDS: 			return
-	//B_TRANSLATE("Partly cloudy"); 		case WC_CLEAR_NIGHT: 			return
-	//B_TRANSLATE("Clear"); 		case WC_ISOLATED_THUNDERSTORM: 	return
-	//B_TRANSLATE("Isolated thunderstorms"); 		case WC_SCATTERED_SNOW_SHOWERS:
-	//return B_TRANSLATE("Scattered showers");
-	//		case WC_SNOW_SHOWERS: 			return B_TRANSLATE("Snow showers");
-	//		case WC_ISOLATED_THUNDERSHOWERS:return B_TRANSLATE("Isolated
-	//thundershowers"); 		case WC_NOT_AVALIABLE: 			return B_TRANSLATE("Not
-	//available");
-	//	}
-
-	switch (condition) {
-		case WC_CLEAR_SKY:
-			return B_TRANSLATE("Clear sky");
-		case WC_MAINLY_CLEAR:
-			return B_TRANSLATE("Mainly clear");
-		case WC_PARTLY_CLOUDY:
-			return B_TRANSLATE("Partly cloudy");
-		case WC_OVERCAST:
-			return B_TRANSLATE("Overcast");
-		case WC_FOG:
-			return B_TRANSLATE("Fog");
-		case WC_DEPOSITING_RIME_FOG:
-			return B_TRANSLATE("Depositing rime fog");
-		case WC_LIGHT_DRIZZLE:
-			return B_TRANSLATE("Light drizzle");
-		case WC_MODERATE_DRIZZLE:
-			return B_TRANSLATE("Moderate drizzle");
-		case WC_DENSE_DRIZZLE:
-			return B_TRANSLATE("Dense drizzle");
-		case WC_FREEZING_LIGHT_DRIZZLE:
-			return B_TRANSLATE("Freezing light drizzle");
-		case WC_FREEZING_DENSE_DRIZZLE:
-			return B_TRANSLATE("Freezing dense drizzle");
-		case WC_SLIGHT_RAIN:
-			return B_TRANSLATE("Slight rain");
-		case WC_MODERATE_RAIN:
-			return B_TRANSLATE("Moderate rain");
-		case WC_HEAVY_RAIN:
-			return B_TRANSLATE("Heavy rain");
-		case WC_LIGHT_FREEZING_RAIN:
-			return B_TRANSLATE("Light freezing rain");
-		case WC_HEAVY_FREEZING_RAIN:
-			return B_TRANSLATE("Heavy freezing rain");
-		case WC_SLIGHT_SNOW_FALL:
-			return B_TRANSLATE("Slight snow fall");
-		case WC_MODERATE_SNOW_FALL:
-			return B_TRANSLATE("Moderate snow fall");
-		case WC_HEAVY_SNOW_FALL:
-			return B_TRANSLATE("Heavy snow fall");
-		case WC_SNOW_GRAINS:
-			return B_TRANSLATE("Snow grains");
-		case WC_SLIGHT_RAIN_SHOWERS:
-			return B_TRANSLATE("Slight rain showers");
-		case WC_MODERATE_RAIN_SHOWERS:
-			return B_TRANSLATE("Moderate rain showers");
-		case WC_HEAVY_RAIN_SHOWERS:
-			return B_TRANSLATE("Heavy rain showers");
-		case WC_SLIGHT_SNOW_SHOWERS:
-			return B_TRANSLATE("Slight snow showers");
-		case WC_HEAVY_SNOW_SHOWERS:
-			return B_TRANSLATE("Heavy snow showers");
-		case WC_THUNDERSTORM:
-			return B_TRANSLATE("Thunderstorm");
-		case WC_THUNDERSTORM_SLIGHT_HAIL:
-			return B_TRANSLATE("Thunderstorm with slight hail");
-		case WC_THUNDERSTORM_HEAVY_HAIL:
-			return B_TRANSLATE("Thunderstorm with heavy hail");
+	fSnapshot.SetTo(snapshot);
+
+	// The current condition first, its icon is the one that matters most
+	if (snapshot->HasCurrentWeather()) {
+		fTemperature = snapshot->Temperature();
+		fCondition = snapshot->Condition();
+		fIsDay = snapshot->IsDay();
+
+		BString tempText = FormatString(fDisplayUnit, fTemperature);
+		fTemperatureView->SetText(tempText.String());
+		SetCondition(_GetWeatherMessage(fCondition));
+		_SetConditionIcon(fCondition, fIsDay);
 	}
-	return B_TRANSLATE("Not available");
+
+	// The tiles start with today, also when the forecast is older
+	int32 firstDay = snapshot->FirstDay();
+	for (int32 i = 0; i < kMaxForecastDay
+			&& firstDay + i < snapshot->CountDays(); i++) {
+		int32 day = firstDay + i;
+		int32 condition = snapshot->DayCondition(day);
+		atlas_icon icon;
+		if (!GetWeatherIcon(condition, SMALL_ICON, icon))
+			icon.bitmap = NULL;
+		fForecastDayView[i]->SetForecast(
+			_GetDayText(snapshot->DayOfWeek(day)), icon,
+			snapshot->HighTemperature(day), snapshot->LowTemperature(day));
+		fForecastDayView[i]->SetToolTip(_GetWeatherMessage(condition));
+	}
+
+	const forecast_data& data = snapshot->Data();
+	fHourlyChart->SetForecast(data.hourly, data.utcOffset);
 }
 
 
-BBitmap*
-ForecastView::GetWeatherIcon()
+bool
+ForecastView::_LoadCachedForecast()
 {
-	return GetWeatherIcon(fCondition, DESKBAR_ICON);
+	// Read before the forecast, so that no later change is missed
+	ForecastStore* store = ForecastStore::Default();
+	if (store != NULL)
+		fStoreSequence = store->Sequence();
+
+	ForecastCache cache(fLatitude, fLongitude, fDisplayUnit);
+	bool stale;
+	ForecastSnapshot* snapshot = cache.Load(&stale);
+	if (snapshot == NULL)
+		return true;
+
+	BReference<ForecastSnapshot> reference(snapshot, true);
+	_ApplySnapshot(snapshot);
+	return stale;
 }
 
 
-int32
-ForecastView::Temperature()
+bool
+ForecastView::_PollStore()
 {
-	return fTemperature;
+	// Only a look at the sequence in the mapping while nothing changed
+	ForecastStore* store = ForecastStore::Default();
+	if (store == NULL)
+		return false;
+
+	uint32 sequence = store->Sequence();
+	if (sequence == fStoreSequence)
+		return false;
+	fStoreSequence = sequence;
+
+	ForecastCache cache(fLatitude, fLongitude, fDisplayUnit);
+	bool stale;
+	BReference<ForecastSnapshot> snapshot(cache.Load(&stale), true);
+	if (snapshot.Get() == NULL || (fSnapshot.Get() != NULL
+			&& snapshot->FetchTime() <= fSnapshot->FetchTime()))
+		return false;
+
+	_ApplySnapshot(snapshot);
+	fScheduler.Succeeded(snapshot->FetchTime());
+	if (stale)
+		return false;
+
+	_ScheduleRefresh();
+	return true;
 }
 
 
-BBitmap*
-ForecastView::GetWeatherIcon(int32 condition, weatherIconSize iconSize)
+void
+ForecastView::_ShowOffline()
 {
-	//	switch (condition) {
-	//		case WC_TORNADO:				return fTornado[iconSize];
-	//		case WC_TROPICAL_STORM:			return fTropicalStorm[iconSize];
-	//		case WC_HURRICANE:				return fHurricane[iconSize];
-	//		case WC_SEVERE_THUNDERSTORM:	return
-	//fSevereThunderstorm[iconSize]; 		case WC_STORM:					return
-	//fStorm[iconSize]; 		case WC_MIXED_SNOW_RAIN:		return
-	//fMixedSnowRain[iconSize]; 		case WC_SNOW:					return
-	//fSnow[iconSize]; 		case WC_FREEZING_DRIZZLE:		return
-	//fFreezingDrizzle[iconSize]; 		case WC_DRIZZE:					return
-	//fDrizzle[iconSize]; 		case WC_RAINING: 				return
-	//fRaining[iconSize]; 		case WC_LIGHT_SNOW: 			return
-	//fLightSnow[iconSize]; 		case WC_FOG: 					return
-	//fFog[iconSize]; 		case WC_SMOKY: 					return fSmoky[iconSize];
-	//		case WC_WINDY: 					return fWindy[iconSize];
-	//		case WC_CLOUD: 					return	fCloud[iconSize];
-	//		case WC_MOSTLY_CLOUDY_NIGHT: 	return fMostlyCloudyNight[iconSize];
-	//		case WC_MOSTLY_CLOUDY_DAY: 		return fClouds[iconSize];
-	//		case WC_NIGHT_FEW_CLOUDS: 		return fNightFewClouds[iconSize];
-	//		case WC_CLEAR_NIGHT:			return fClearNight[iconSize];
-	//		case WC_FEW_CLOUDS: 			return fFewClouds[iconSize];
-	//		case WC_RAINING_SCATTERED: 		return fRainingScattered[iconSize];
-	//		case WC_SHINING: 				return fShining[iconSize];
-	//		case WC_SCATTERED_SNOW_SHOWERS: return
-	//fScatteredSnowShowers[iconSize]; 		case WC_SNOW_SHOWERS: 			return
-	//fSnowShowers[iconSize]; 		case WC_ISOLATED_THUNDERSHOWERS:return
-	//fIsolatedThundershowers[iconSize]; 		case WC_NOT_AVALIABLE: break;
-	//	}
-
-	switch (condition) {
-
-		case WC_CLEAR_SKY:
-			return fClear[iconSize];
-		case WC_MAINLY_CLEAR:
-			return fFewClouds[iconSize];
-		case WC_PARTLY_CLOUDY:
-			return fPartlyCloudy[iconSize];
-		case WC_OVERCAST:
-			return fClouds[iconSize];
-
-		case WC_FOG:
-			return fFog[iconSize];
-		case WC_DEPOSITING_RIME_FOG:
-			return fSmoky[iconSize];
-
-		case WC_LIGHT_DRIZZLE:
-			return fLightDrizzle[iconSize];
-		case WC_MODERATE_DRIZZLE:
-			return fModerateDenseDrizzle[iconSize];
-		case WC_DENSE_DRIZZLE:
-			return fModerateDenseDrizzle[iconSize];
-		case WC_FREEZING_LIGHT_DRIZZLE:
-			return fFreezingDrizzle[iconSize];
-		case WC_FREEZING_DENSE_DRIZZLE:
-			return fFreezingDrizzle[iconSize];
-
-		case WC_SLIGHT_RAIN:
-			return fRainingScattered[iconSize];
-		case WC_MODERATE_RAIN:
-			return fRaining[iconSize];
-		case WC_HEAVY_RAIN:
-			return fIsolatedThundershowers[iconSize];
-
-		case WC_SLIGHT_RAIN_SHOWERS:
-			return fRainingScattered[iconSize];
-		case WC_MODERATE_RAIN_SHOWERS:
-			return fIsolatedThundershowers[iconSize];
-		case WC_HEAVY_RAIN_SHOWERS:
-			return fIsolatedThundershowers[iconSize];
-
-		case WC_LIGHT_FREEZING_RAIN:
-			return fMixedSnowRain[iconSize];
-		case WC_HEAVY_FREEZING_RAIN:
-			return fSnow[iconSize];
-
-		case WC_SLIGHT_SNOW_FALL:
-			return fSnowShowers[iconSize];
-		case WC_MODERATE_SNOW_FALL:
-			return fScatteredSnowShowers[iconSize];
-		case WC_HEAVY_SNOW_FALL:
-			return fSnow[iconSize];
-
-		case WC_SNOW_GRAINS:
-			return fMixedSnowRain[iconSize];
-
-		case WC_SLIGHT_SNOW_SHOWERS:
-			return fScatteredSnowShowers[iconSize];
-		case WC_HEAVY_SNOW_SHOWERS:
-			return fSnowShowers[iconSize];
-
-		case WC_THUNDERSTORM:
-			return fIsolatedThunderstorm[iconSize];
-		case WC_THUNDERSTORM_SLIGHT_HAIL:
-			return fAlert[iconSize];
-		case WC_THUNDERSTORM_HEAVY_HAIL:
-			return fSevereThunderstorm[iconSize];
+	if (fSnapshot.Get() == NULL || !fSnapshot->HasCurrentWeather()) {
+		SetCondition(B_TRANSLATE("No network"));
+		return;
 	}
-	return NULL; // Change to N/A
-}
 
+	// Keep the last forecast, but tell how old it is. Seconds are left out.
+	bigtime_t age = (time(NULL) - fSnapshot->FetchTime()) / 60 * 60;
+	if (age < 60)
+		age = 60;
 
-BString
-ForecastView::_GetDayText(const BString& dayName) const
-{
-	BWeekday day;
-	if (strcmp(dayName.String(), "Mon") == 0)
-		day = B_WEEKDAY_MONDAY;
-	if (strcmp(dayName.String(), "Tue") == 0)
-		day = B_WEEKDAY_TUESDAY;
-	if (strcmp(dayName.String(), "Wed") == 0)
-		day = B_WEEKDAY_WEDNESDAY;
-	if (strcmp(dayName.String(), "Thu") == 0)
-		day = B_WEEKDAY_THURSDAY;
-	if (strcmp(dayName.String(), "Fri") == 0)
-		day = B_WEEKDAY_FRIDAY;
-	if (strcmp(dayName.String(), "Sat") == 0)
-		day = B_WEEKDAY_SATURDAY;
-	if (strcmp(dayName.String(), "Sun") == 0)
-		day = B_WEEKDAY_SUNDAY;
-	BString translateDayName;
-	status_t result
-		= fDateFormat.GetDayName(day, translateDayName, B_LONG_DATE_FORMAT);
-	return result == B_OK ? translateDayName : dayName;
+	BString ageText;
+	BDurationFormat format;
+	if (format.Format(ageText, 0, age * 1000000) != B_OK) {
+		SetCondition(B_TRANSLATE("No network"));
+		return;
+	}
+
+	BString condition(B_TRANSLATE("%condition% (%age% ago)"));
+	condition.ReplaceFirst("%condition%", _GetWeatherMessage(fCondition));
+	condition.ReplaceFirst("%age%", ageText);
+	SetCondition(condition);
 }
 
 
@@ -1010,7 +949,9 @@ ForecastView::SetUpdateDelay(int32 delay)
 {
 	if (fUpdateDelay != delay) {
 		fUpdateDelay = delay;
-		fAutoUpdate->SetInterval((bigtime_t) fUpdateDelay * 60 * 1000 * 1000);
+		fScheduler.SetInterval(fUpdateDelay * 60);
+		if (fAutoUpdate != NULL)
+			_ScheduleRefresh();
 	}
 }
 
@@ -1034,6 +975,7 @@ ForecastView::SetDisplayUnit(DisplayUnit unit)
 
 	for (int32 i = 0; i < kMaxForecastDay; i++)
 		fForecastDayView[i]->SetDisplayUnit(fDisplayUnit);
+	fHourlyChart->SetDisplayUnit(fDisplayUnit);
 }
 
 
@@ -1118,56 +1060,70 @@ ForecastView::Reload(bool forcedForecast)
 {
 	if (!fConnected)
 		return;
-	
-	StopReload();
 
-	fForcedForecast = forcedForecast;
+	// The manual refresh, the timer and the network monitor tend to ask
+	// at the same time, they all get the same refresh
+	fForcedForecast |= forcedForecast;
+	if (fReloadRunner != NULL)
+		return;
 
-	fDownloadThread = spawn_thread(
-		&_DownloadDataFunc, "Download Data", B_NORMAL_PRIORITY, this);
-	if (fDownloadThread >= 0)
-		resume_thread(fDownloadThread);
+	BMessage message(kStartReloadMessage);
+	fReloadRunner = new BMessageRunner(BMessenger(this, Window()), &message,
+		kReloadCoalesceDelay, 1);
 }
 
 
 void
 ForecastView::StopReload()
 {
-	if (fDownloadThread < 0)
-		return;
-	wait_for_thread(fDownloadThread, NULL);
-	fDownloadThread = -1;
+	// The download may go on for other views, it just doesn't come here
+	// anymore
+	if (fCoordinator != NULL)
+		fCoordinator->Unsubscribe(fRefreshTarget);
+	fRefreshTarget = BMessenger();
 }
 
 
-int32
-ForecastView::_DownloadDataFunc(void* cookie)
+void
+ForecastView::_StartReload()
 {
-	ForecastView* forecastView = static_cast<ForecastView*>(cookie);
-	forecastView->_DownloadData();
-	return 0;
+	delete fReloadRunner;
+	fReloadRunner = NULL;
+
+	bool forced = fForcedForecast;
+	fForcedForecast = false;
+	if (fCoordinator == NULL)
+		return;
+
+	// Subscribing again follows a changed city or unit
+	fRefreshTarget = BMessenger(this, Window());
+	fCoordinator->Subscribe(fRefreshTarget, fLatitude, fLongitude,
+		fDisplayUnit);
+	fCoordinator->Refresh(fRefreshTarget, fUpdateDelay * 60, forced);
 }
 
 
 void
-ForecastView::_DownloadData()
+ForecastView::_ScheduleRefresh()
+{
+	delete fAutoUpdate;
+
+	BMessage message(kAutoUpdateMessage);
+	bigtime_t delay = fScheduler.Delay(time(NULL));
+	fAutoUpdate = new BMessageRunner(BMessenger(this, Window()), &message,
+		delay > kReloadCoalesceDelay ? delay : kReloadCoalesceDelay, 1);
+}
+
+
+bool
+ForecastView::_IsVisible() const
 {
-	BMallocIO replyData;
-	BMessenger messenger(this, Window());
-	WSOpenMeteo listener(messenger, &replyData, WEATHER_REQUEST);
-	BString urlString = listener.GetUrl(fLongitude, fLatitude, fDisplayUnit);
-
-#if B_HAIKU_VERSION < B_HAIKU_VERSION_1_PRE_BETA_6
-	BUrl link(urlString.String());
-#else
-	BUrl link(urlString.String(), true);
-#endif
-	BUrlRequest* request
-		= BUrlProtocolRoster::MakeRequest(link, &replyData, &listener);
-
-	thread_id thread = request->Run();
-	wait_for_thread(thread, NULL);
-	delete request;
+	// Replicants are on the Desktop
+	if (fReplicated)
+		return true;
+
+	BWindow* window = Window();
+	return window != NULL && !window->IsHidden() && !window->IsMinimized();
 }
 
 
@@ -1178,10 +1134,13 @@ ForecastView::_ShowForecast(bool show)
 		return;
 	fShowForecast = show;
 
-	if (fShowForecast)
+	if (fShowForecast) {
+		fHourlyChart->Show();
 		fForecastView->Show();
-	else
+	} else {
+		fHourlyChart->Hide();
 		fForecastView->Hide();
+	}
 }
 
 
@@ -1198,6 +1157,7 @@ ForecastView::SetTextColor(rgb_color color)
 
 	for (int32 i = 0; i < kMaxForecastDay; i++)
 		fForecastDayView[i]->SetTextColor(color);
+	fHourlyChart->SetTextColor(color);
 
 	fConditionButton->Invalidate();
 	fConditionView->Invalidate();
@@ -1222,6 +1182,7 @@ ForecastView::SetBackgroundColor(rgb_color color)
 		fForecastDayView[i]->SetViewColor(color);
 		fForecastDayView[i]->Invalidate();
 	}
+	fHourlyChart->SetViewColor(color);
 	fConditionButton->Invalidate();
 	fConditionView->Invalidate();
 	fTemperatureView->Invalidate();
@@ -1249,32 +1210,9 @@ ForecastView::IsConnected() const
 BString
 FormatString(DisplayUnit unit, int32 temp)
 {
-	BString tempString = "";
-	switch (unit) {
-		case CELSIUS:
-		{
-			// Open Meteo allows to request temperatures either in Fahreneit or
-			// Celsius the response contains the unit measure so no conversion
-			// is required and the unit measure settings should only be used to
-			// request temperatures in a given unit measure Other unit measures
-			// are unsupported by Open Meteo and should be removed from the
-			// preference panel tempString << static_cast<int>(floor((temp - 32)
-			// * 5/9)) << "°C";
-			tempString << temp << "°C";
-			break;
-		}
-		case FAHRENHEIT:
-		{
-			tempString << temp << "°F";
-			break;
-		}
-		default:
-		{
-			tempString << temp << "°C";
-			break;
-		}
-	}
-	return tempString;
+	char buffer[kMaxTemperatureLength];
+	FormatTemperature(buffer, sizeof(buffer), unit, temp);
+	return BString(buffer);
 }
 
 
@@ -1293,9 +1231,3 @@ ForecastView::_NetworkConnected()
 	}
 	return false;
 }
-
-void
-ForecastView::SetDeskbarIconSize(int height)
-{
-	fSizeDeskBarIcon = height;
-}
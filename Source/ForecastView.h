@@ -25,25 +25,26 @@
 #include <Window.h>
 
 #include "ForecastDayView.h"
+#include "ForecastSnapshot.h"
+#include "HourlyChartView.h"
+#include "IconAtlas.h"
 #include "LabelView.h"
+#include "LatencyLog.h"
 #include "PreferencesWindow.h"
+#include "RefreshScheduler.h"
 #include "CitiesListSelectionWindow.h"
 
+class FetchCoordinator;
+
 const uint32 kAutoUpdateMessage = 'AutU';
 const uint32 kUpdateMessage = 'Upda';
 const uint32 kShowForecastMessage = 'SFor';
 const uint32 kSettingsMessage = 'Pref';
 
 extern const char* kSettingsFileName;
-
-const uint32 kSizeSmallIcon = 40;
-const uint32 kSizeLargeIcon = 80;
-
-enum weatherIconSize {
-	SMALL_ICON,
-	LARGE_ICON,
-	DESKBAR_ICON
-};
+extern const char* kDefaultCityName;
+extern const double kDefaultLongitude;
+extern const double kDefaultLatitude;
 
 // WMO Weather conditions
 //
@@ -128,12 +129,17 @@ class ForecastView : public BView
 public:
 					ForecastView(BRect frame);
 					ForecastView(BMessage* archive);
+					// Only shows the given snapshot, without network nor
+					// settings file, to be rendered offscreen
+					ForecastView(BRect frame, BMessage* settings,
+						ForecastSnapshot* snapshot);
 	virtual			~ForecastView();
 
 	virtual void	MessageReceived(BMessage* msg);
 	virtual void	AttachedToWindow();
 	virtual void	AllAttached();
 	virtual void	Draw(BRect updateRect);
+	virtual void	WindowActivated(bool active);
 virtual status_t	Archive(BMessage* into, bool deep = true) const;
 static	BArchivable* Instantiate(BMessage* archive);
 
@@ -151,44 +157,48 @@ status_t			SaveState(BMessage* into, bool deep = true) const;
 	void			SetUpdateDelay(int32 delay);
 	int32			UpdateDelay();
 	DisplayUnit		Unit();
-	bool			IsFahrenheitDefault();
+	static bool		IsFahrenheitDefault();
 	void			SetShowForecast(bool showForecast);
 	bool			ShowForecast();
 	void			SetTextColor(rgb_color color);
 	void			SetBackgroundColor(rgb_color color);
 	bool			IsDefaultColor() const;
 	bool			IsConnected() const;
-	BBitmap*		GetWeatherIcon();
-	BBitmap* 		GetWeatherIcon(int32 condition, weatherIconSize size);
+	bool			GetWeatherIcon(int32 condition, weatherIconSize size,
+						atlas_icon& icon, bool isDay = true);
 	int32			GetCondition();
 	BString			GetStatus();
 	int32			Temperature();
-	void			SetDeskbarIconSize(int height);
 
 private:
 	void			_Init();
-	void			_DownloadData();
-	static int32	_DownloadDataFunc(void* cookie);
-	void 			_LoadBitmaps();
-	void			_DeleteBitmaps();
-	void			_DeleteIcons(BBitmap* bitmap[2]);
+	void			_StartReload();
+	void			_ScheduleRefresh();
+	bool			_IsVisible() const;
 	const char*		_GetWeatherMessage(int32 condition);
-	BString			_GetDayText(const BString& day) const;
+	BString			_GetDayText(int32 dayOfWeek) const;
+	void			_ApplySnapshot(ForecastSnapshot* snapshot);
+	void			_SetConditionIcon(int32 condition, bool isDay);
+	bool			_LoadCachedForecast();
+	bool			_PollStore();
+	void			_ShowOffline();
 
 	status_t		_ApplyState(BMessage* settings);
 
 	void			_ShowForecast(bool);
-	void			_LoadIcons(BBitmap*	bitmap[2], uint32 type, const char* name);
 
 	bool			_SupportTransparent();
 
 	bool			_NetworkConnected();
 
-	thread_id		fDownloadThread;
 	bool 			fForcedForecast;
+	BMessageRunner*	fReloadRunner;
+	FetchCoordinator* fCoordinator;
+	BMessenger		fRefreshTarget;
 	BGridView* 		fView;
 	BGridLayout* 	fLayout;
 	bool			fReplicated;
+	bool			fHeadless;
 
 	BString			fCity;
 	int32			fCityId;
@@ -201,51 +211,26 @@ private:
 
 	int32			fTemperature;
 	int32			fCondition;
+	bool			fIsDay;
+	BReference<ForecastSnapshot> fSnapshot;
 
 	BDateFormat 	fDateFormat;
 
 	CitiesListSelectionWindow*	fSelectionWindow;
 	PreferencesWindow* fPreferencesWindow;
 	BMessageRunner*	fAutoUpdate;
+	RefreshScheduler fScheduler;
+	uint32			fStoreSequence;
+	bool			fLatencyPending;
+	refresh_latency	fLatency;
 	BMessageRunner*	fDelayUpdateAfterReconnection;
 	bool			fConnected;
 
-	BBitmap* 		fAlert[3];
-	BBitmap* 		fClearNight[3];
-	BBitmap* 		fClear[3];
-	BBitmap* 		fClouds[3];
-	BBitmap* 		fCold[3];
-	BBitmap* 		fLightDrizzle[3];
-	BBitmap* 		fModerateDenseDrizzle[3];
-	BBitmap* 		fFewClouds[3];
-	BBitmap* 		fFog[3];
-	BBitmap* 		fFreezingDrizzle[3];
-	BBitmap* 		fLightSnow[3];
-	BBitmap* 		fMixedSnowRain[3];
-	BBitmap* 		fMostlyCloudyNight[3];
-	BBitmap* 		fNightFewClouds[3];
-	BBitmap* 		fRainingScattered[3];
-	BBitmap* 		fRaining[3];
-	BBitmap* 		fShining[3];
-	BBitmap* 		fShiny[3];
-	BBitmap* 		fSnow[3];
-	BBitmap* 		fStorm[3];
-	BBitmap* 		fThunder[3];
-	BBitmap* 		fTornado[3];
-	BBitmap* 		fTropicalStorm[3];
-	BBitmap* 		fCloud[3];
-	BBitmap* 		fPartlyCloudy[3];
-	BBitmap* 		fIsolatedThunderstorm[3];
-	BBitmap* 		fIsolatedThundershowers[3];
-	BBitmap* 		fSevereThunderstorm[3];
-	BBitmap* 		fHurricane[3];
-	BBitmap* 		fScatteredSnowShowers[3];
-	BBitmap* 		fSmoky[3];
-	BBitmap* 		fSnowShowers[3];
-	BBitmap* 		fWindy[3];
+	IconAtlas*		fIcons;
 	BGroupView*		fInfoView;
 	BGroupView*		fNumberView;
 	BGroupView* 	fForecastView;
+	HourlyChartView*	fHourlyChart;
 	BMenuItem*		fShowForecastMenuItem;
 	BButton*		fConditionButton;
 	ForecastDayView*		fForecastDayView[5];
@@ -0,0 +1,466 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#include <Screen.h>
+#include <String.h>
+
+#include <math.h>
+#include <string.h>
+
+#include <new>
+
+#include "ForecastView.h"
+#include "HourlyChartView.h"
+#include "HourlyForecast.h"
+
+
+static const float kMarkerWidth = 4;
+static const int64 kSecondsPerHour = 60 * 60;
+static const int64 kSecondsPerDay = 24 * kSecondsPerHour;
+static const rgb_color kTemperatureColor = {232, 112, 38, 255};
+static const rgb_color kPrecipitationColor = {64, 132, 224, 255};
+
+
+HourlyChartView::HourlyChartView(const char* name)
+	:
+	BView(name, B_WILL_DRAW | B_FRAME_EVENTS),
+	fCount(0),
+	fStartTime(0),
+	fUtcOffset(0),
+	fMinimum(0),
+	fMaximum(0),
+	fDisplayUnit(CELSIUS),
+	fLocationTimeZone("GMT"),
+	fTemperaturePointCount(0),
+	fPrecipitationPointCount(0),
+	fDecimated(false),
+	fChart(NULL),
+	fHover(-1)
+{
+	fTextColor = ui_color(B_PANEL_TEXT_COLOR);
+	fChartTextColor = fTextColor;
+
+	fLabelFont = be_plain_font;
+	fLabelFont.SetSize(ceilf(fLabelFont.Size() * 0.85f));
+	fLabelFont.GetHeight(&fLabelHeight);
+
+	float labelHeight = ceilf(fLabelHeight.ascent + fLabelHeight.descent);
+	SetExplicitMinSize(BSize(100, labelHeight * 5));
+	SetExplicitPreferredSize(BSize(B_SIZE_UNSET, labelHeight * 5));
+	SetExplicitMaxSize(BSize(B_SIZE_UNLIMITED, labelHeight * 5));
+}
+
+
+HourlyChartView::~HourlyChartView()
+{
+	delete fChart;
+}
+
+
+void
+HourlyChartView::AttachedToWindow()
+{
+	if (Parent() != NULL)
+		SetViewColor(Parent()->ViewColor());
+	_InvalidateChart();
+}
+
+
+void
+HourlyChartView::Draw(BRect updateRect)
+{
+	if (fChart == NULL)
+		_RenderChart();
+
+	if (fChart == NULL) {
+		// Out of memory, draw without the cache
+		if (ViewColor() != B_TRANSPARENT_COLOR) {
+			SetHighColor(ViewColor());
+			FillRect(updateRect);
+		}
+		fChartTextColor = _TextColor();
+		_DrawChart(this, fChartTextColor);
+	} else {
+		if (ViewColor() == B_TRANSPARENT_COLOR) {
+			SetDrawingMode(B_OP_ALPHA);
+			SetBlendingMode(B_PIXEL_ALPHA, B_ALPHA_OVERLAY);
+		} else
+			SetDrawingMode(B_OP_COPY);
+		DrawBitmap(fChart, updateRect, updateRect);
+		SetDrawingMode(B_OP_COPY);
+	}
+
+	_DrawMarker();
+}
+
+
+void
+HourlyChartView::FrameResized(float width, float height)
+{
+	// Only the width changes which hours share a column
+	_InvalidateChart();
+}
+
+
+void
+HourlyChartView::MouseMoved(BPoint where, uint32 transit,
+	const BMessage* dragMessage)
+{
+	int32 hover = transit == B_EXITED_VIEW || transit == B_OUTSIDE_VIEW
+		? -1 : _HourAt(where.x);
+	if (hover == fHover)
+		return;
+
+	// Only the old and the new marker are drawn again, the chart below is
+	// copied from the cache
+	if (fHover >= 0)
+		Invalidate(_MarkerFrame(fHover));
+	fHover = hover;
+	if (fHover >= 0)
+		Invalidate(_MarkerFrame(fHover));
+	Invalidate(_LabelFrame());
+}
+
+
+void
+HourlyChartView::SetViewColor(rgb_color color)
+{
+	BView::SetViewColor(color);
+	_InvalidateChart();
+}
+
+
+void
+HourlyChartView::SetForecast(const hourly_weather& hourly, int32 utcOffset)
+{
+	fCount = hourly.count;
+	fStartTime = hourly.startTime;
+	fUtcOffset = utcOffset;
+	memcpy(fTemperature, hourly.values[HOURLY_TEMPERATURE],
+		fCount * sizeof(float));
+	memcpy(fPrecipitation, hourly.values[HOURLY_PRECIPITATION_PROBABILITY],
+		fCount * sizeof(float));
+
+	fMinimum = HourlyMinimum(fTemperature, fCount);
+	fMaximum = HourlyMaximum(fTemperature, fCount);
+	if (fHover >= fCount)
+		fHover = -1;
+	_InvalidateChart();
+}
+
+
+void
+HourlyChartView::SetDisplayUnit(DisplayUnit unit)
+{
+	fDisplayUnit = unit;
+	_InvalidateChart();
+}
+
+
+void
+HourlyChartView::SetTextColor(rgb_color color)
+{
+	fTextColor = color;
+	_InvalidateChart();
+}
+
+
+BRect
+HourlyChartView::_PlotFrame() const
+{
+	BRect frame = Bounds();
+	frame.top = _LabelFrame().bottom + 4;
+	frame.InsetBy(kMarkerWidth, 0);
+	frame.bottom -= 2;
+	return frame;
+}
+
+
+BRect
+HourlyChartView::_LabelFrame() const
+{
+	BRect frame = Bounds();
+	frame.bottom = frame.top
+		+ ceilf(fLabelHeight.ascent + fLabelHeight.descent) + 1;
+	return frame;
+}
+
+
+BRect
+HourlyChartView::_MarkerFrame(int32 hour) const
+{
+	float x = _XForHour(hour);
+	BRect frame = Bounds();
+	frame.left = floorf(x - kMarkerWidth);
+	frame.right = ceilf(x + kMarkerWidth);
+	return frame;
+}
+
+
+int32
+HourlyChartView::_HourAt(float x) const
+{
+	if (fCount == 0)
+		return -1;
+
+	BRect plot = _PlotFrame();
+	if (fCount == 1 || plot.Width() <= 0)
+		return 0;
+
+	int32 hour = (int32) roundf((x - plot.left) * (fCount - 1)
+		/ plot.Width());
+	if (hour < 0)
+		return 0;
+	if (hour >= fCount)
+		return fCount - 1;
+	return hour;
+}
+
+
+float
+HourlyChartView::_XForHour(int32 hour) const
+{
+	BRect plot = _PlotFrame();
+	if (fCount <= 1)
+		return plot.left;
+	return plot.left + hour * plot.Width() / (fCount - 1);
+}
+
+
+void
+HourlyChartView::_InvalidateChart()
+{
+	fDecimated = false;
+	delete fChart;
+	fChart = NULL;
+	Invalidate();
+}
+
+
+void
+HourlyChartView::_Decimate()
+{
+	float maximum = fMaximum;
+	if (isnan(maximum) || maximum - fMinimum < 1)
+		maximum = fMinimum + 1;
+
+	fTemperaturePointCount = _DecimateLine(fTemperature, fMinimum, maximum,
+		fTemperaturePoints);
+	fPrecipitationPointCount = _DecimateLine(fPrecipitation, 0, 100,
+		fPrecipitationPoints);
+	fDecimated = true;
+}
+
+
+// Keeps the lowest and the highest value of the hours sharing a pixel
+// column, in their order, which is all a line of that width can show.
+// When there are fewer hours than columns every hour is kept.
+int32
+HourlyChartView::_DecimateLine(const float* values, float minimum,
+	float maximum, BPoint* points) const
+{
+	BRect plot = _PlotFrame();
+	if (fCount == 0 || plot.Width() <= 0 || plot.Height() <= 0)
+		return 0;
+
+	float xScale = fCount > 1 ? plot.Width() / (fCount - 1) : 0;
+	float yScale = plot.Height() / (maximum - minimum);
+
+	int32 count = 0;
+	int32 column = -1;
+	int32 low = -1;
+	int32 high = -1;
+	for (int32 hour = 0; hour <= fCount; hour++) {
+		int32 hourColumn = hour < fCount ? (int32) (hour * xScale) : -1;
+		if (hourColumn != column && low >= 0) {
+			int32 first = low < high ? low : high;
+			int32 last = low < high ? high : low;
+			points[count++].Set(plot.left + first * xScale,
+				plot.bottom - (values[first] - minimum) * yScale);
+			if (last != first) {
+				points[count++].Set(plot.left + last * xScale,
+					plot.bottom - (values[last] - minimum) * yScale);
+			}
+			low = high = -1;
+		}
+		if (hour == fCount)
+			break;
+
+		column = hourColumn;
+		float value = values[hour];
+		if (isnan(value))
+			continue;
+		if (low < 0 || value < values[low])
+			low = hour;
+		if (high < 0 || value > values[high])
+			high = hour;
+	}
+
+	return count;
+}
+
+
+rgb_color
+HourlyChartView::_TextColor() const
+{
+	if (ViewColor() != B_TRANSPARENT_COLOR)
+		return fTextColor;
+
+	rgb_color low = BScreen(Window()).DesktopColor();
+	if (low.red + low.green + low.blue > 128 * 3)
+		return tint_color(low, B_DARKEN_MAX_TINT);
+	return tint_color(low, B_LIGHTEN_MAX_TINT);
+}
+
+
+void
+HourlyChartView::_RenderChart()
+{
+	BRect bounds = Bounds();
+	BBitmap* chart = new(std::nothrow) BBitmap(bounds,
+		B_BITMAP_ACCEPTS_VIEWS, B_RGBA32);
+	if (chart == NULL || chart->InitCheck() != B_OK) {
+		delete chart;
+		return;
+	}
+
+	bool transparent = ViewColor() == B_TRANSPARENT_COLOR;
+	rgb_color textColor = transparent && Window() != NULL
+		? _TextColor() : fTextColor;
+	fChartTextColor = textColor;
+
+	BView* view = new BView(bounds, "chart", B_FOLLOW_NONE, 0);
+	chart->AddChild(view);
+	if (chart->Lock()) {
+		if (transparent) {
+			memset(chart->Bits(), 0, chart->BitsLength());
+			view->SetBlendingMode(B_PIXEL_ALPHA, B_ALPHA_COMPOSITE);
+			view->SetViewColor(B_TRANSPARENT_COLOR);
+		} else {
+			view->SetHighColor(ViewColor());
+			view->FillRect(bounds);
+		}
+		_DrawChart(view, textColor);
+		view->Sync();
+		chart->Unlock();
+	}
+	chart->RemoveChild(view);
+	delete view;
+
+	delete fChart;
+	fChart = chart;
+}
+
+
+void
+HourlyChartView::_DrawChart(BView* view, rgb_color textColor)
+{
+	if (fCount == 0)
+		return;
+	if (!fDecimated)
+		_Decimate();
+
+	bool transparent = ViewColor() == B_TRANSPARENT_COLOR;
+	view->SetDrawingMode(transparent ? B_OP_ALPHA : B_OP_COPY);
+
+	// A line at each local midnight
+	BRect plot = _PlotFrame();
+	rgb_color gridColor = textColor;
+	gridColor.alpha = 48;
+	if (!transparent)
+		gridColor = mix_color(ViewColor(), textColor, 48);
+	view->SetHighColor(gridColor);
+	int64 firstDay = (fStartTime + fUtcOffset + kSecondsPerDay - 1)
+		/ kSecondsPerDay * kSecondsPerDay - fUtcOffset;
+	for (int64 time = firstDay; time < fStartTime + fCount * kSecondsPerHour;
+			time += kSecondsPerDay) {
+		float x = roundf(_XForHour((time - fStartTime) / kSecondsPerHour));
+		view->StrokeLine(BPoint(x, plot.top), BPoint(x, plot.bottom));
+	}
+
+	view->SetPenSize(1);
+	view->SetHighColor(kPrecipitationColor);
+	if (fPrecipitationPointCount > 1) {
+		view->StrokePolygon(fPrecipitationPoints, fPrecipitationPointCount,
+			false);
+	}
+
+	view->SetPenSize(2);
+	view->SetHighColor(kTemperatureColor);
+	if (fTemperaturePointCount > 1)
+		view->StrokePolygon(fTemperaturePoints, fTemperaturePointCount, false);
+	view->SetPenSize(1);
+
+	// The temperature range, at the left of the label line
+	if (isnan(fMinimum))
+		return;
+
+	BString range;
+	range << FormatString(fDisplayUnit, (int32) roundf(fMinimum)) << " – "
+		<< FormatString(fDisplayUnit, (int32) roundf(fMaximum));
+	view->SetFont(&fLabelFont);
+	view->SetHighColor(textColor);
+	view->SetLowColor(ViewColor());
+	view->DrawString(range.String(), BPoint(kMarkerWidth,
+		_LabelFrame().top + ceilf(fLabelHeight.ascent)));
+}
+
+
+void
+HourlyChartView::_DrawMarker()
+{
+	if (fHover < 0 || fHover >= fCount)
+		return;
+
+	// Hovering draws the marker often, the color isn't looked up again
+	rgb_color textColor = fChartTextColor;
+	BRect plot = _PlotFrame();
+	float x = roundf(_XForHour(fHover));
+	SetDrawingMode(B_OP_COPY);
+	SetHighColor(textColor);
+	StrokeLine(BPoint(x, plot.top), BPoint(x, plot.bottom));
+
+	float temperature = fTemperature[fHover];
+	if (!isnan(temperature) && fTemperaturePointCount > 0) {
+		float maximum = fMaximum - fMinimum < 1 ? fMinimum + 1 : fMaximum;
+		float y = plot.bottom
+			- (temperature - fMinimum) * plot.Height() / (maximum - fMinimum);
+		SetHighColor(kTemperatureColor);
+		FillEllipse(BPoint(x, y), 3, 3);
+	}
+
+	// Hour and values, right aligned on the label line
+	int64 localTime = fStartTime + fHover * kSecondsPerHour + fUtcOffset;
+	int32 dayOfWeek = (localTime / kSecondsPerDay + 3) % 7 + 1;
+
+	BString label;
+	if (fDateFormat.GetDayName((BWeekday) dayOfWeek, label,
+			B_SHORT_DATE_FORMAT) == B_OK)
+		label << " ";
+	else
+		label = "";
+	BString hourText;
+	if (fTimeFormat.Format(hourText, (time_t) localTime, B_SHORT_TIME_FORMAT,
+			&fLocationTimeZone) == B_OK)
+		label << hourText;
+	if (!isnan(temperature)) {
+		label << "  "
+			<< FormatString(fDisplayUnit, (int32) roundf(temperature));
+	}
+	float precipitation = fPrecipitation[fHover];
+	if (!isnan(precipitation))
+		label << "  " << (int32) roundf(precipitation) << "%";
+
+	SetFont(&fLabelFont);
+	SetHighColor(textColor);
+	SetLowColor(ViewColor());
+	if (ViewColor() == B_TRANSPARENT_COLOR)
+		SetDrawingMode(B_OP_OVER);
+	BRect labelFrame = _LabelFrame();
+	DrawString(label.String(), BPoint(
+		labelFrame.right - kMarkerWidth - StringWidth(label.String()),
+		labelFrame.top + ceilf(fLabelHeight.ascent)));
+	SetDrawingMode(B_OP_COPY);
+}
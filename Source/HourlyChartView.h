@@ -0,0 +1,92 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _HOURLYCHARTVIEW_H_
+#define _HOURLYCHARTVIEW_H_
+
+
+#include <Bitmap.h>
+#include <DateFormat.h>
+#include <Font.h>
+#include <TimeFormat.h>
+#include <TimeZone.h>
+#include <View.h>
+
+#include "ForecastData.h"
+#include "PreferencesWindow.h"
+
+
+// Hourly temperature and precipitation probability over the whole
+// forecast. The lines are reduced to the pixel columns of the view: a
+// column covering several hours only gets its lowest and highest value,
+// so drawing costs the same for 24 or 384 hours. The reduced lines and
+// the chart drawn from them are kept until the data, the colors or the
+// width change; hovering only draws the marker and its label on top.
+class HourlyChartView : public BView
+{
+public:
+						HourlyChartView(const char* name);
+	virtual				~HourlyChartView();
+
+	virtual void		AttachedToWindow();
+	virtual void		Draw(BRect updateRect);
+	virtual void		FrameResized(float width, float height);
+	virtual void		MouseMoved(BPoint where, uint32 transit,
+							const BMessage* dragMessage);
+	virtual void		SetViewColor(rgb_color color);
+						using BView::SetViewColor;
+
+			void		SetForecast(const hourly_weather& hourly,
+							int32 utcOffset);
+			void		SetDisplayUnit(DisplayUnit unit);
+			void		SetTextColor(rgb_color color);
+
+private:
+			BRect		_PlotFrame() const;
+			BRect		_LabelFrame() const;
+			BRect		_MarkerFrame(int32 hour) const;
+			int32		_HourAt(float x) const;
+			float		_XForHour(int32 hour) const;
+
+			void		_InvalidateChart();
+			void		_Decimate();
+			int32		_DecimateLine(const float* values, float minimum,
+							float maximum, BPoint* points) const;
+			rgb_color	_TextColor() const;
+			void		_RenderChart();
+			void		_DrawChart(BView* view, rgb_color textColor);
+			void		_DrawMarker();
+
+			float		fTemperature[kMaxForecastHours];
+			float		fPrecipitation[kMaxForecastHours];
+			int32		fCount;
+			int64		fStartTime;
+			int32		fUtcOffset;
+			float		fMinimum;
+			float		fMaximum;
+
+			DisplayUnit	fDisplayUnit;
+			rgb_color	fTextColor;
+			BFont		fLabelFont;
+			font_height	fLabelHeight;
+			BDateFormat	fDateFormat;
+			BTimeFormat	fTimeFormat;
+			// The hours are shifted to the time of the location already
+			BTimeZone	fLocationTimeZone;
+
+			// At most two points per pixel column, or one per hour
+			BPoint		fTemperaturePoints[2 * kMaxForecastHours];
+			BPoint		fPrecipitationPoints[2 * kMaxForecastHours];
+			int32		fTemperaturePointCount;
+			int32		fPrecipitationPointCount;
+			bool		fDecimated;
+
+			BBitmap*	fChart;
+			// What the chart was drawn with, the marker uses it as well
+			rgb_color	fChartTextColor;
+			int32		fHover;
+};
+
+
+#endif // _HOURLYCHARTVIEW_H_
@@ -0,0 +1,853 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#include <Autolock.h>
+#include <OS.h>
+#include <SecureSocket.h>
+#include <Socket.h>
+
+#include <parsedate.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <new>
+
+#include "CancellationToken.h"
+#include "HttpSession.h"
+
+
+static const int32 kMaxIdleConnections = 8;
+static const int32 kMaxServers = 16;
+static const int32 kMaxPipelineDepth = 8;
+static const size_t kBufferSize = 16384;
+static const bigtime_t kAddressLifetime = 5 * 60 * 1000000LL;
+static const bigtime_t kDefaultIdleLifetime = 30 * 1000000LL;
+static const bigtime_t kConnectTimeout = 15 * 1000000LL;
+static const bigtime_t kTransferTimeout = 30 * 1000000LL;
+static const int32 kMaxRetryAfter = 24 * 60 * 60;
+
+static HttpSession* sDefaultSession = NULL;
+static pthread_once_t sDefaultSessionOnce = PTHREAD_ONCE_INIT;
+
+
+struct HttpSession::server_entry {
+	BString			key;
+	BNetworkAddress	address;
+	bigtime_t		resolved;
+	bigtime_t		lastUsed;
+	bool			hasAddress;
+	bool			noPipelining;
+};
+
+
+// A kept alive connection to one server. Only ever used by one thread at a
+// time: the session hands it out and takes it back when it's idle.
+class HttpConnection
+{
+public:
+						HttpConnection(const BString& key,
+							BAbstractSocket* socket);
+						~HttpConnection();
+
+			const BString& Key() const { return fKey; }
+			BAbstractSocket* Socket() const { return fSocket; }
+
+			bool		IsReusable() const { return fReusable; }
+			bool		IsExpired(bigtime_t now) const;
+			bigtime_t	IdleSince() const { return fIdleSince; }
+			void		SetIdle(bigtime_t now) { fIdleSince = now; }
+
+			status_t	Send(HttpRequest* const* requests, int32 count);
+			status_t	Receive(HttpRequest* request);
+
+private:
+			ssize_t		_Fill();
+			status_t	_ReadLine(BString& line);
+			status_t	_ReadBody(HttpRequest* request, off_t length,
+							bool untilClosed);
+			status_t	_ReadChunkedBody(HttpRequest* request);
+
+			BString		fKey;
+			BAbstractSocket* fSocket;
+			char*		fBuffer;
+			size_t		fStart;
+			size_t		fEnd;
+			bool		fReusable;
+			bigtime_t	fIdleSince;
+			bigtime_t	fIdleLifetime;
+};
+
+
+// Tells the TCP connect apart from the TLS handshake that follows it
+class TimedSecureSocket : public BSecureSocket
+{
+public:
+						TimedSecureSocket();
+
+	virtual	status_t	Connect(const BNetworkAddress& peer,
+							bigtime_t timeout = B_INFINITE_TIMEOUT);
+
+			bigtime_t	ConnectedTime() const { return fConnected; }
+
+private:
+			bigtime_t	fConnected;
+};
+
+
+// Either a number of seconds or an HTTP date
+static int32
+parse_retry_after(const BString& value)
+{
+	int64 seconds;
+	if (value.Length() > 0 && value[0] >= '0' && value[0] <= '9')
+		seconds = strtoll(value.String(), NULL, 10);
+	else {
+		time_t date = parsedate(value.String(), -1);
+		if (date == -1)
+			return 0;
+		seconds = date - time(NULL);
+	}
+
+	if (seconds < 0)
+		return 0;
+	return seconds < kMaxRetryAfter ? seconds : kMaxRetryAfter;
+}
+
+
+static bool
+is_successful(int32 statusCode)
+{
+	return statusCode >= 200 && statusCode < 300;
+}
+
+
+static void
+create_default_session()
+{
+	sDefaultSession = new(std::nothrow) HttpSession();
+}
+
+
+// #pragma mark - HttpListener
+
+
+HttpListener::~HttpListener()
+{
+}
+
+
+void
+HttpListener::ResponseStarted(int32 statusCode)
+{
+}
+
+
+status_t
+HttpListener::DataReceived(const char* data, size_t size)
+{
+	return B_OK;
+}
+
+
+void
+HttpListener::RequestCompleted(status_t status, const http_timing& timing,
+	int32 retryAfter)
+{
+}
+
+
+// #pragma mark - HttpRequest
+
+
+HttpRequest::HttpRequest(const BUrl& url, HttpListener* listener)
+	:
+	fUrl(url),
+	fListener(listener),
+	fStatus(B_NO_INIT),
+	fStatusCode(0),
+	fRetryAfter(0),
+	fResponseStarted(false)
+{
+	memset(&fTiming, 0, sizeof(fTiming));
+}
+
+
+// #pragma mark - TimedSecureSocket
+
+
+TimedSecureSocket::TimedSecureSocket()
+	:
+	fConnected(0)
+{
+}
+
+
+status_t
+TimedSecureSocket::Connect(const BNetworkAddress& peer, bigtime_t timeout)
+{
+	// What BSecureSocket::Connect() does, with a look at the clock between
+	status_t status = InitCheck();
+	if (status == B_OK)
+		status = BSocket::Connect(peer, timeout);
+	if (status != B_OK)
+		return status;
+
+	fConnected = system_time();
+	return _SetupConnect(peer.HostName().String());
+}
+
+
+// #pragma mark - HttpConnection
+
+
+HttpConnection::HttpConnection(const BString& key, BAbstractSocket* socket)
+	:
+	fKey(key),
+	fSocket(socket),
+	fBuffer(new char[kBufferSize]),
+	fStart(0),
+	fEnd(0),
+	fReusable(true),
+	fIdleSince(0),
+	fIdleLifetime(kDefaultIdleLifetime)
+{
+}
+
+
+HttpConnection::~HttpConnection()
+{
+	delete fSocket;
+	delete[] fBuffer;
+}
+
+
+bool
+HttpConnection::IsExpired(bigtime_t now) const
+{
+	return now - fIdleSince >= fIdleLifetime;
+}
+
+
+status_t
+HttpConnection::Send(HttpRequest* const* requests, int32 count)
+{
+	// All requests go out at once, the server answers them in order
+	BString text;
+	for (int32 i = 0; i < count; i++) {
+		const BUrl& url = requests[i]->Url();
+
+		BString target = url.Path();
+		if (target.IsEmpty())
+			target = "/";
+		if (url.HasRequest())
+			target << "?" << url.Request();
+
+		BString host = url.Host();
+		if (url.HasPort())
+			host << ":" << url.Port();
+
+		text << "GET " << target << " HTTP/1.1\r\n"
+			<< "Host: " << host << "\r\n"
+			<< "User-Agent: Weather (Haiku)\r\n"
+			<< "Accept-Encoding: identity\r\n"
+			<< "Connection: keep-alive\r\n"
+			<< "\r\n";
+	}
+
+	return fSocket->WriteExactly(text.String(), text.Length());
+}
+
+
+status_t
+HttpConnection::Receive(HttpRequest* request)
+{
+	int32 statusCode;
+	off_t length;
+	bool chunked;
+	bool keepAlive;
+
+	// Informational responses are skipped
+	do {
+		BString line;
+		status_t status = _ReadLine(line);
+		if (status != B_OK)
+			return status;
+		if (request->fTiming.firstByte == 0)
+			request->fTiming.firstByte = system_time();
+
+		if (!line.StartsWith("HTTP/1.") || line.Length() < 12)
+			return B_BAD_DATA;
+
+		bool http10 = line[7] == '0';
+		statusCode = atoi(line.String() + 9);
+		length = -1;
+		chunked = false;
+		keepAlive = !http10;
+
+		while ((status = _ReadLine(line)) == B_OK && !line.IsEmpty()) {
+			int32 colon = line.FindFirst(':');
+			if (colon <= 0)
+				continue;
+
+			BString name(line.String(), colon);
+			BString value(line.String() + colon + 1);
+			value.Trim();
+
+			if (name.ICompare("Content-Length") == 0)
+				length = strtoll(value.String(), NULL, 10);
+			else if (name.ICompare("Transfer-Encoding") == 0)
+				chunked = value.IFindFirst("chunked") >= 0;
+			else if (name.ICompare("Connection") == 0) {
+				if (value.IFindFirst("close") >= 0)
+					keepAlive = false;
+				else if (value.IFindFirst("keep-alive") >= 0)
+					keepAlive = true;
+			} else if (name.ICompare("Retry-After") == 0)
+				request->fRetryAfter = parse_retry_after(value);
+			else if (name.ICompare("Keep-Alive") == 0) {
+				// Don't reuse the connection when the server is about to
+				// close it
+				int32 timeout = value.IFindFirst("timeout=");
+				if (timeout >= 0) {
+					bigtime_t lifetime
+						= atoi(value.String() + timeout + 8) * 1000000LL;
+					if (lifetime > 1000000LL)
+						fIdleLifetime = lifetime - 1000000LL;
+					else
+						fIdleLifetime = 0;
+				}
+			}
+		}
+		if (status != B_OK)
+			return status;
+	} while (statusCode >= 100 && statusCode < 200);
+
+	request->fStatusCode = statusCode;
+	request->fResponseStarted = true;
+	if (request->fListener != NULL)
+		request->fListener->ResponseStarted(statusCode);
+
+	status_t status = B_OK;
+	if (statusCode != 204 && statusCode != 304) {
+		if (chunked)
+			status = _ReadChunkedBody(request);
+		else if (length >= 0)
+			status = _ReadBody(request, length, false);
+		else {
+			// The end of the body is only known by the server closing
+			keepAlive = false;
+			status = _ReadBody(request, 0, true);
+		}
+	}
+
+	request->fTiming.lastByte = system_time();
+
+	if (status != B_OK || !keepAlive)
+		fReusable = false;
+	return status;
+}
+
+
+ssize_t
+HttpConnection::_Fill()
+{
+	if (fStart > 0) {
+		memmove(fBuffer, fBuffer + fStart, fEnd - fStart);
+		fEnd -= fStart;
+		fStart = 0;
+	}
+	if (fEnd == kBufferSize)
+		return B_BUFFER_OVERFLOW;
+
+	ssize_t bytesRead = fSocket->Read(fBuffer + fEnd, kBufferSize - fEnd);
+	if (bytesRead > 0)
+		fEnd += bytesRead;
+	return bytesRead;
+}
+
+
+status_t
+HttpConnection::_ReadLine(BString& line)
+{
+	while (true) {
+		char* end = static_cast<char*>(
+			memchr(fBuffer + fStart, '\n', fEnd - fStart));
+		if (end != NULL) {
+			size_t length = end - (fBuffer + fStart);
+			if (length > 0 && end[-1] == '\r')
+				length--;
+			line.SetTo(fBuffer + fStart, length);
+			fStart = end + 1 - fBuffer;
+			return B_OK;
+		}
+
+		ssize_t bytesRead = _Fill();
+		if (bytesRead == 0)
+			return B_IO_ERROR;
+		if (bytesRead < 0)
+			return bytesRead;
+	}
+}
+
+
+status_t
+HttpConnection::_ReadBody(HttpRequest* request, off_t length, bool untilClosed)
+{
+	while (untilClosed || length > 0) {
+		if (fStart == fEnd) {
+			fStart = fEnd = 0;
+			ssize_t bytesRead = _Fill();
+			if (bytesRead == 0)
+				return untilClosed ? B_OK : B_IO_ERROR;
+			if (bytesRead < 0)
+				return bytesRead;
+		}
+
+		size_t size = fEnd - fStart;
+		if (!untilClosed && (off_t)size > length)
+			size = length;
+
+		// The body of an error, often an HTML page, isn't for the listener.
+		// It is read past all the same, to keep the connection.
+		if (request->fListener != NULL
+			&& is_successful(request->fStatusCode)) {
+			status_t status
+				= request->fListener->DataReceived(fBuffer + fStart, size);
+			if (status != B_OK)
+				return status;
+		}
+
+		request->fTiming.size += size;
+		fStart += size;
+		length -= size;
+	}
+
+	return B_OK;
+}
+
+
+status_t
+HttpConnection::_ReadChunkedBody(HttpRequest* request)
+{
+	while (true) {
+		BString line;
+		status_t status = _ReadLine(line);
+		if (status != B_OK)
+			return status;
+
+		char* end;
+		off_t size = strtoll(line.String(), &end, 16);
+		if (end == line.String() || size < 0)
+			return B_BAD_DATA;
+
+		if (size == 0) {
+			// Skip the trailer
+			while ((status = _ReadLine(line)) == B_OK && !line.IsEmpty())
+				;
+			return status;
+		}
+
+		status = _ReadBody(request, size, false);
+		if (status == B_OK)
+			status = _ReadLine(line);
+		if (status != B_OK)
+			return status;
+	}
+}
+
+
+// #pragma mark - HttpSession
+
+
+HttpSession::HttpSession()
+	:
+	fLock("http session"),
+	fIdle(new HttpConnection*[kMaxIdleConnections]),
+	fIdleCount(0),
+	fServers(new server_entry[kMaxServers]),
+	fServerCount(0)
+{
+}
+
+
+HttpSession::~HttpSession()
+{
+	Flush();
+	delete[] fIdle;
+	delete[] fServers;
+}
+
+
+/*static*/ HttpSession*
+HttpSession::Default()
+{
+	pthread_once(&sDefaultSessionOnce, &create_default_session);
+	return sDefaultSession;
+}
+
+
+status_t
+HttpSession::Run(HttpRequest& request, CancellationToken* token)
+{
+	HttpRequest* requests[] = { &request };
+	return Run(requests, 1, token);
+}
+
+
+status_t
+HttpSession::Run(HttpRequest* const* requests, int32 count,
+	CancellationToken* token)
+{
+	bigtime_t started = system_time();
+	for (int32 i = 0; i < count; i++) {
+		requests[i]->fStatus = B_NO_INIT;
+		requests[i]->fStatusCode = 0;
+		requests[i]->fRetryAfter = 0;
+		requests[i]->fResponseStarted = false;
+		memset(&requests[i]->fTiming, 0, sizeof(http_timing));
+		requests[i]->fTiming.started = started;
+	}
+
+	status_t result = B_OK;
+	bool retried = false;
+	int32 next = 0;
+	while (next < count) {
+		if (token != NULL && token->IsCanceled()) {
+			for (; next < count; next++)
+				_Complete(requests[next], B_CANCELED);
+			return B_CANCELED;
+		}
+
+		HttpRequest* request = requests[next];
+		BString key = _ServerKey(request->Url());
+
+		int32 batch = 1;
+		if (_SupportsPipelining(key)) {
+			while (next + batch < count && batch < kMaxPipelineDepth
+				&& _ServerKey(requests[next + batch]->Url()) == key) {
+				batch++;
+			}
+		}
+
+		HttpConnection* connection;
+		bool reused;
+		http_timing timing;
+		memset(&timing, 0, sizeof(timing));
+		status_t status = _Connect(request->Url(), key, connection, reused,
+			timing);
+
+		// The pipelined requests all waited for the connection
+		for (int32 i = next; i < next + batch; i++) {
+			requests[i]->fTiming.resolved = timing.resolved;
+			requests[i]->fTiming.connected = timing.connected;
+			requests[i]->fTiming.secured = timing.secured;
+		}
+
+		if (status != B_OK) {
+			_Complete(request, status);
+			result = status;
+			next++;
+			continue;
+		}
+
+		if (token != NULL && !token->Attach(connection->Socket())) {
+			delete connection;
+			continue;
+		}
+
+		int32 done = 0;
+		status = connection->Send(requests + next, batch);
+		while (status == B_OK && done < batch) {
+			status = connection->Receive(requests[next + done]);
+			if (status != B_OK)
+				break;
+
+			_Complete(requests[next + done],
+				is_successful(requests[next + done]->fStatusCode)
+					? B_OK : kHttpStatusError);
+			done++;
+			if (!connection->IsReusable())
+				break;
+		}
+
+		if (token != NULL) {
+			token->Detach();
+			if (token->IsCanceled())
+				status = B_CANCELED;
+		}
+
+		if (status == B_OK)
+			_Release(connection);
+		else
+			delete connection;
+
+		next += done;
+		if (done > 0)
+			retried = false;
+
+		if (status == B_OK) {
+			// The server closed the connection before answering all of the
+			// pipelined requests
+			if (done < batch)
+				_DisablePipelining(key);
+			continue;
+		}
+		if (status == B_CANCELED)
+			continue;
+
+		// An idle connection may have been closed by the server in the
+		// meantime, and pipelined requests may have been dropped. A request
+		// that got no response yet is safe to send once more.
+		if (!requests[next]->fResponseStarted && !retried
+			&& (reused || done > 0)) {
+			if (done > 0)
+				_DisablePipelining(key);
+			retried = true;
+			continue;
+		}
+
+		_Complete(requests[next], status);
+		result = status;
+		next++;
+		retried = false;
+	}
+
+	return result;
+}
+
+
+void
+HttpSession::Flush()
+{
+	BAutolock locker(fLock);
+	for (int32 i = 0; i < fIdleCount; i++)
+		delete fIdle[i];
+	fIdleCount = 0;
+}
+
+
+status_t
+HttpSession::_Connect(const BUrl& url, const BString& key,
+	HttpConnection*& _connection, bool& _reused, http_timing& timing)
+{
+	_connection = _TakeIdle(key);
+	if (_connection != NULL) {
+		_reused = true;
+		return B_OK;
+	}
+	_reused = false;
+
+	bool secure = url.Protocol() == "https";
+
+	// A cached address that doesn't work any more is looked up again
+	status_t status = B_ERROR;
+	for (int32 attempt = 0; attempt < 2; attempt++) {
+		BNetworkAddress address;
+		status = _Resolve(url, key, attempt > 0, address, timing);
+		if (status != B_OK)
+			return status;
+
+		BAbstractSocket* socket;
+		TimedSecureSocket* secureSocket = NULL;
+		if (secure)
+			socket = secureSocket = new(std::nothrow) TimedSecureSocket();
+		else
+			socket = new(std::nothrow) BSocket();
+		if (socket == NULL)
+			return B_NO_MEMORY;
+
+		status = socket->Connect(address, kConnectTimeout);
+		if (status == B_OK) {
+			if (secureSocket != NULL) {
+				timing.connected = secureSocket->ConnectedTime();
+				timing.secured = system_time();
+			} else
+				timing.connected = system_time();
+
+			socket->SetTimeout(kTransferTimeout);
+			_connection = new(std::nothrow) HttpConnection(key, socket);
+			if (_connection == NULL) {
+				delete socket;
+				return B_NO_MEMORY;
+			}
+			return B_OK;
+		}
+		delete socket;
+	}
+
+	return status;
+}
+
+
+HttpConnection*
+HttpSession::_TakeIdle(const BString& key)
+{
+	bigtime_t now = system_time();
+	HttpConnection* connection = NULL;
+
+	BAutolock locker(fLock);
+
+	// The connections the server has likely closed by now are dropped
+	for (int32 i = fIdleCount - 1; i >= 0; i--) {
+		if (fIdle[i]->IsExpired(now)) {
+			delete fIdle[i];
+			fIdle[i] = fIdle[--fIdleCount];
+		}
+	}
+
+	for (int32 i = fIdleCount - 1; i >= 0; i--) {
+		if (fIdle[i]->Key() == key) {
+			connection = fIdle[i];
+			fIdle[i] = fIdle[--fIdleCount];
+			break;
+		}
+	}
+
+	return connection;
+}
+
+
+void
+HttpSession::_Release(HttpConnection* connection)
+{
+	if (!connection->IsReusable()) {
+		delete connection;
+		return;
+	}
+
+	bigtime_t now = system_time();
+	connection->SetIdle(now);
+
+	BAutolock locker(fLock);
+
+	if (fIdleCount == kMaxIdleConnections) {
+		// Make room by closing the one that was idle the longest
+		int32 oldest = 0;
+		for (int32 i = 1; i < fIdleCount; i++) {
+			if (fIdle[i]->IdleSince() < fIdle[oldest]->IdleSince())
+				oldest = i;
+		}
+		delete fIdle[oldest];
+		fIdle[oldest] = fIdle[--fIdleCount];
+	}
+
+	fIdle[fIdleCount++] = connection;
+}
+
+
+status_t
+HttpSession::_Resolve(const BUrl& url, const BString& key, bool refresh,
+	BNetworkAddress& address, http_timing& timing)
+{
+	bigtime_t now = system_time();
+	{
+		BAutolock locker(fLock);
+		server_entry* server = _FindServer(key);
+		if (server != NULL && server->hasAddress && !refresh
+			&& now - server->resolved < kAddressLifetime) {
+			address = server->address;
+			return B_OK;
+		}
+	}
+
+	uint16 port = url.Protocol() == "https" ? 443 : 80;
+	if (url.HasPort())
+		port = url.Port();
+
+	// Not locked, a lookup can take a while
+	status_t status = address.SetTo(url.Host().String(), port);
+	if (status != B_OK)
+		return status;
+	timing.resolved = system_time();
+
+	BAutolock locker(fLock);
+	server_entry* server = _AddServer(key);
+	server->address = address;
+	server->resolved = now;
+	server->hasAddress = true;
+	return B_OK;
+}
+
+
+HttpSession::server_entry*
+HttpSession::_FindServer(const BString& key)
+{
+	for (int32 i = 0; i < fServerCount; i++) {
+		if (fServers[i].key == key) {
+			fServers[i].lastUsed = system_time();
+			return &fServers[i];
+		}
+	}
+	return NULL;
+}
+
+
+HttpSession::server_entry*
+HttpSession::_AddServer(const BString& key)
+{
+	server_entry* server = _FindServer(key);
+	if (server != NULL)
+		return server;
+
+	if (fServerCount < kMaxServers)
+		server = &fServers[fServerCount++];
+	else {
+		// Forget about the server that was used the longest time ago
+		server = &fServers[0];
+		for (int32 i = 1; i < fServerCount; i++) {
+			if (fServers[i].lastUsed < server->lastUsed)
+				server = &fServers[i];
+		}
+	}
+
+	server->key = key;
+	server->address.Unset();
+	server->resolved = 0;
+	server->lastUsed = system_time();
+	server->hasAddress = false;
+	server->noPipelining = false;
+	return server;
+}
+
+
+bool
+HttpSession::_SupportsPipelining(const BString& key)
+{
+	BAutolock locker(fLock);
+	server_entry* server = _FindServer(key);
+	return server == NULL || !server->noPipelining;
+}
+
+
+void
+HttpSession::_DisablePipelining(const BString& key)
+{
+	BAutolock locker(fLock);
+	_AddServer(key)->noPipelining = true;
+}
+
+
+/*static*/ BString
+HttpSession::_ServerKey(const BUrl& url)
+{
+	BString key(url.Protocol());
+	key << "://" << url.Host();
+	if (url.HasPort())
+		key << ":" << url.Port();
+	return key;
+}
+
+
+/*static*/ void
+HttpSession::_Complete(HttpRequest* request, status_t status)
+{
+	request->fStatus = status;
+	if (request->fListener != NULL) {
+		request->fListener->RequestCompleted(status, request->fTiming,
+			request->fRetryAfter);
+	}
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _HTTPSESSION_H_
+#define _HTTPSESSION_H_
+
+
+#include <Locker.h>
+#include <NetworkAddress.h>
+#include <String.h>
+#include <Url.h>
+
+
+class BAbstractSocket;
+class CancellationToken;
+class HttpConnection;
+
+
+// When the phases of a request ended, in system_time(). The ones it didn't
+// need are 0: the lookup of a cached address, the connect and the TLS
+// handshake on a kept alive connection.
+struct http_timing {
+	bigtime_t		started;
+	bigtime_t		resolved;
+	bigtime_t		connected;
+	bigtime_t		secured;
+	bigtime_t		firstByte;
+	bigtime_t		lastByte;
+	uint64			size;
+		// of the body
+};
+
+
+// A request that was answered with a status code other than 2xx completes
+// with this status
+const status_t kHttpStatusError = B_ERRORS_END + 1;
+
+
+// Receives a response while it arrives. Returning an error from
+// DataReceived() aborts the transfer. The body of a response that isn't a
+// 2xx one is skipped, it completes with kHttpStatusError; retryAfter is
+// the number of seconds its Retry-After header asked to wait, or 0.
+class HttpListener
+{
+public:
+	virtual				~HttpListener();
+
+	virtual	void		ResponseStarted(int32 statusCode);
+	virtual	status_t	DataReceived(const char* data, size_t size);
+	virtual	void		RequestCompleted(status_t status,
+							const http_timing& timing, int32 retryAfter);
+};
+
+
+// One GET request sent through an HttpSession
+class HttpRequest
+{
+public:
+						HttpRequest(const BUrl& url, HttpListener* listener);
+
+			const BUrl&	Url() const { return fUrl; }
+			HttpListener* Listener() const { return fListener; }
+
+			// Valid once the request completed
+			status_t	Status() const { return fStatus; }
+			int32		StatusCode() const { return fStatusCode; }
+			int32		RetryAfter() const { return fRetryAfter; }
+			const http_timing& Timing() const { return fTiming; }
+
+private:
+	friend class HttpConnection;
+	friend class HttpSession;
+
+			BUrl		fUrl;
+			HttpListener* fListener;
+			status_t	fStatus;
+			int32		fStatusCode;
+			int32		fRetryAfter;
+			bool		fResponseStarted;
+			http_timing	fTiming;
+};
+
+
+// Process-wide HTTP/1.1 client for http and https URLs. Connections are
+// kept alive and reused by later requests to the same server, so that only
+// the first one pays for the DNS lookup, the TCP connect and the TLS
+// handshake. Resolved addresses are cached as well.
+class HttpSession
+{
+public:
+						HttpSession();
+						~HttpSession();
+
+	static	HttpSession* Default();
+
+			// Sends the requests and waits for all of them, telling the
+			// listener of each how it went as soon as it's done. Requests
+			// to the same server are pipelined on one connection unless the
+			// server turned out not to support it. Cancelling the token
+			// aborts the transfer at once.
+			status_t	Run(HttpRequest* const* requests, int32 count,
+							CancellationToken* token = NULL);
+			status_t	Run(HttpRequest& request,
+							CancellationToken* token = NULL);
+
+			// Closes the idle connections
+			void		Flush();
+
+private:
+			struct server_entry;
+
+			status_t	_Connect(const BUrl& url, const BString& key,
+							HttpConnection*& _connection, bool& _reused,
+							http_timing& timing);
+			HttpConnection* _TakeIdle(const BString& key);
+			void		_Release(HttpConnection* connection);
+			status_t	_Resolve(const BUrl& url, const BString& key,
+							bool refresh, BNetworkAddress& address,
+							http_timing& timing);
+			server_entry* _FindServer(const BString& key);
+			server_entry* _AddServer(const BString& key);
+			bool		_SupportsPipelining(const BString& key);
+			void		_DisablePipelining(const BString& key);
+
+	static	BString		_ServerKey(const BUrl& url);
+	static	void		_Complete(HttpRequest* request, status_t status);
+
+			BLocker		fLock;
+			HttpConnection** fIdle;
+			int32		fIdleCount;
+			server_entry* fServers;
+			int32		fServerCount;
+};
+
+
+#endif // _HTTPSESSION_H_
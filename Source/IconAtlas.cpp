@@ -0,0 +1,553 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#include <Autolock.h>
+#include <Directory.h>
+#include <Entry.h>
+#include <FindDirectory.h>
+#include <Font.h>
+#include <IconUtils.h>
+#include <image.h>
+#include <Path.h>
+#include <Roster.h>
+#include <String.h>
+
+#include <fcntl.h>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <new>
+
+#include "App.h"
+#include "IconAtlas.h"
+
+
+static const char* const kIconNames[] = {
+	"Artwork/weather_alert.hvif",
+	"Artwork/weather_clear_night.hvif",
+	"Artwork/weather_clear.hvif",
+	"Artwork/weather_clouds.hvif",
+	"Artwork/weather_cold.hvif",
+	"Artwork/weather_drizzle.hvif",
+	"Artwork/weather_icon.hvif",
+	"Artwork/weather_few_clouds.hvif",
+	"Artwork/weather_fog.hvif",
+	"Artwork/weather_freezing_drizzle.hvif",
+	"Artwork/weather_isolated_thunderstorm.hvif",
+	"Artwork/weather_light_snow.hvif",
+	"Artwork/weather_mixed_snow_rain.hvif",
+	"Artwork/weather_mostly_cloudy_night.hvif",
+	"Artwork/weather_night_few_clouds.hvif",
+	"Artwork/weather_raining_scattered.hvif",
+	"Artwork/weather_raining.hvif",
+	"Artwork/weather_severe_thunderstorm.hvif",
+	"Artwork/weather_isolated_thundershowers.hvif",
+	"Artwork/weather_shining.hvif",
+	"Artwork/weather_shiny.hvif",
+	"Artwork/weather_snow.hvif",
+	"Artwork/weather_storm.hvif",
+	"Artwork/weather_thunder.hvif",
+	"Artwork/weather_tornado.hvif",
+	"Artwork/weather_tropical_storm.hvif",
+	"Artwork/weather_cloud.hvif",
+	"Artwork/weather_partly_cloudy.hvif",
+	"Artwork/weather_hurricane.hvif",
+	"Artwork/weather_smoky.hvif",
+	"Artwork/weather_scattered_snow_showers.hvif",
+	"Artwork/weather_snow_showers.hvif"
+};
+
+static_assert(sizeof(kIconNames) / sizeof(kIconNames[0]) == kWeatherIconCount,
+	"every weather icon needs its resource name");
+static_assert(kWeatherIconCount <= 64,
+	"the icons of a sheet are tracked in a 64 bit mask");
+
+// The small and the large icons, and the Deskbar ones
+static const int32 kMaxSheets = 4;
+static const int32 kSheetColumns = 8;
+static const int32 kSheetRows
+	= (kWeatherIconCount + kSheetColumns - 1) / kSheetColumns;
+
+static const uint32 kIconCacheMagic = 'WIcC';
+static const uint32 kIconCacheVersion = 1;
+static const int32 kMaxCacheOpenAttempts = 4;
+
+static BLocker sAtlasLock("icon atlas");
+static IconAtlas* sAtlas = NULL;
+
+
+// A sheet as it is stored in the raster cache, followed by its pixels in
+// rows of kSheetColumns * size * 4 bytes
+struct icon_cache_header {
+	uint32			magic;
+	uint32			version;
+	uint64			resourceHash;
+	uint32			size;
+	uint32			scale;
+	uint64			available;
+		// the icons whose pixels are stored
+};
+
+
+// All icons of one size, in a grid of kSheetColumns columns
+struct IconAtlas::sheet {
+	uint32			size;
+	BBitmap*		bitmap;
+	BBitmap*		scratch;
+	uint64			rasterized;
+	uint64			failed;
+
+	int				cacheFD;
+	const uint8*	cache;
+	size_t			cacheSize;
+};
+
+
+static size_t
+cache_row_size(uint32 size)
+{
+	return (size_t) kSheetColumns * size * 4;
+}
+
+
+static size_t
+cache_file_size(uint32 size)
+{
+	return sizeof(icon_cache_header) + cache_row_size(size) * kSheetRows * size;
+}
+
+
+// The image our code was loaded from, the Weather executable whether it
+// runs as an application or was loaded by a replicant
+static status_t
+find_own_image(entry_ref& ref)
+{
+	addr_t address = (addr_t) &find_own_image;
+	image_info info;
+	int32 cookie = 0;
+	while (get_next_image_info(B_CURRENT_TEAM, &cookie, &info) == B_OK) {
+		if (address >= (addr_t) info.text
+			&& address < (addr_t) info.text + info.text_size)
+			return BEntry(info.name).GetRef(&ref);
+	}
+	return B_ENTRY_NOT_FOUND;
+}
+
+
+// FNV-1a, good enough to notice a changed icon
+static uint64
+hash_data(uint64 hash, const void* data, size_t size)
+{
+	const uint8* bytes = static_cast<const uint8*>(data);
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+
+IconAtlas::IconAtlas()
+	:
+	fLock("icon atlas sheets"),
+	fResources(NULL),
+	fResourcesStatus(B_NO_INIT),
+	fResourceHash(0),
+	fSheets(new sheet[kMaxSheets]),
+	fSheetCount(0),
+	fUsers(0)
+{
+}
+
+
+IconAtlas::~IconAtlas()
+{
+	for (int32 i = 0; i < fSheetCount; i++) {
+		delete fSheets[i].bitmap;
+		delete fSheets[i].scratch;
+		_CloseCache(&fSheets[i]);
+	}
+	delete[] fSheets;
+	delete fResources;
+}
+
+
+/*static*/ IconAtlas*
+IconAtlas::Acquire()
+{
+	BAutolock locker(sAtlasLock);
+	if (sAtlas == NULL) {
+		sAtlas = new(std::nothrow) IconAtlas();
+		if (sAtlas == NULL)
+			return NULL;
+	}
+
+	sAtlas->fUsers++;
+	return sAtlas;
+}
+
+
+/*static*/ void
+IconAtlas::Release(IconAtlas* atlas)
+{
+	if (atlas == NULL)
+		return;
+
+	BAutolock locker(sAtlasLock);
+	if (--atlas->fUsers > 0)
+		return;
+
+	if (sAtlas == atlas)
+		sAtlas = NULL;
+	delete atlas;
+}
+
+
+/*static*/ float
+IconAtlas::ScaleFactor()
+{
+	// Like the rest of the system, scale with the plain font size, 12 being
+	// the default one
+	return std::max(1.0f, floorf(be_plain_font->Size() / 12.0f * 4) / 4);
+}
+
+
+bool
+IconAtlas::GetIcon(weather_icon icon, uint32 size, atlas_icon& _icon)
+{
+	if (icon < 0 || icon >= kWeatherIconCount || size == 0)
+		return false;
+
+	BAutolock locker(fLock);
+
+	sheet* sheet = _Sheet(size);
+	if (sheet == NULL)
+		return false;
+
+	uint64 mask = 1ULL << icon;
+	if ((sheet->rasterized & mask) == 0) {
+		if ((sheet->failed & mask) != 0)
+			return false;
+		if (!_LoadCached(sheet, icon)) {
+			if (_Rasterize(sheet, icon) != B_OK) {
+				sheet->failed |= mask;
+				return false;
+			}
+			_StoreCached(sheet, icon);
+		}
+		sheet->rasterized |= mask;
+	}
+
+	float left = (icon % kSheetColumns) * size;
+	float top = (icon / kSheetColumns) * size;
+	_icon.bitmap = sheet->bitmap;
+	_icon.frame.Set(left, top, left + size - 1, top + size - 1);
+	return true;
+}
+
+
+IconAtlas::sheet*
+IconAtlas::_Sheet(uint32 size)
+{
+	for (int32 i = 0; i < fSheetCount; i++) {
+		if (fSheets[i].size == size)
+			return &fSheets[i];
+	}
+
+	// Sheets are never freed while the atlas is in use, views may still
+	// draw from them
+	if (fSheetCount == kMaxSheets)
+		return NULL;
+
+	BBitmap* bitmap = new(std::nothrow) BBitmap(
+		BRect(0, 0, kSheetColumns * size - 1, kSheetRows * size - 1), 0,
+		B_RGBA32);
+	BBitmap* scratch = new(std::nothrow) BBitmap(
+		BRect(0, 0, size - 1, size - 1), 0, B_RGBA32);
+	if (bitmap == NULL || bitmap->InitCheck() != B_OK || scratch == NULL
+		|| scratch->InitCheck() != B_OK) {
+		delete bitmap;
+		delete scratch;
+		return NULL;
+	}
+
+	// Fully transparent until the icons are rasterized into it
+	memset(bitmap->Bits(), 0, bitmap->BitsLength());
+
+	sheet& sheet = fSheets[fSheetCount++];
+	sheet.size = size;
+	sheet.bitmap = bitmap;
+	sheet.scratch = scratch;
+	sheet.rasterized = 0;
+	sheet.failed = 0;
+	_OpenCache(&sheet);
+	return &sheet;
+}
+
+
+status_t
+IconAtlas::_OpenResources()
+{
+	if (fResourcesStatus != B_NO_INIT)
+		return fResourcesStatus;
+
+	// The Weather executable, also when it isn't running, or when it runs
+	// under another signature to render offscreen
+	entry_ref ref;
+	fResourcesStatus = find_own_image(ref);
+	if (fResourcesStatus != B_OK) {
+		app_info info;
+		fResourcesStatus = be_roster->GetAppInfo(kSignature, &info);
+		if (fResourcesStatus != B_OK)
+			return fResourcesStatus;
+		ref = info.ref;
+	}
+
+	fResources = new(std::nothrow) BResources(&ref);
+	if (fResources == NULL)
+		fResourcesStatus = B_NO_MEMORY;
+	else
+		fResourcesStatus = fResources->InitCheck();
+	return fResourcesStatus;
+}
+
+
+status_t
+IconAtlas::_Rasterize(sheet* sheet, weather_icon icon)
+{
+	status_t status = _OpenResources();
+	if (status != B_OK)
+		return status;
+
+	size_t dataSize;
+	const void* data
+		= fResources->LoadResource('rGFX', kIconNames[icon], &dataSize);
+	if (data == NULL)
+		return B_ENTRY_NOT_FOUND;
+
+	// The icon is drawn on its own, then copied into its cell
+	memset(sheet->scratch->Bits(), 0, sheet->scratch->BitsLength());
+	status = BIconUtils::GetVectorIcon(reinterpret_cast<const uint8*>(data),
+		dataSize, sheet->scratch);
+	if (status != B_OK)
+		return status;
+
+	BPoint cell((icon % kSheetColumns) * sheet->size,
+		(icon / kSheetColumns) * sheet->size);
+	return sheet->bitmap->ImportBits(sheet->scratch, B_ORIGIN, cell,
+		sheet->size, sheet->size);
+}
+
+
+uint64
+IconAtlas::_ResourceHash()
+{
+	if (fResourceHash != 0 || _OpenResources() != B_OK)
+		return fResourceHash;
+
+	// Hashing the few kilobytes of vector data is much cheaper than
+	// rasterizing a single icon
+	uint64 hash = 0xcbf29ce484222325ULL;
+	for (int32 i = 0; i < kWeatherIconCount; i++) {
+		size_t dataSize = 0;
+		const void* data
+			= fResources->LoadResource('rGFX', kIconNames[i], &dataSize);
+		hash = hash_data(hash, &dataSize, sizeof(dataSize));
+		if (data != NULL)
+			hash = hash_data(hash, data, dataSize);
+	}
+
+	fResourceHash = hash != 0 ? hash : 1;
+	return fResourceHash;
+}
+
+
+void
+IconAtlas::_OpenCache(sheet* sheet)
+{
+	sheet->cacheFD = -1;
+	sheet->cache = NULL;
+	sheet->cacheSize = 0;
+
+	uint64 resourceHash = _ResourceHash();
+	if (resourceHash == 0)
+		return;
+
+	uint32 scale = (uint32) (ScaleFactor() * 100);
+	BString name;
+	name.SetToFormat("%" B_PRIu32 "-%" B_PRIu32, sheet->size, scale);
+
+	BPath path;
+	if (find_directory(B_USER_CACHE_DIRECTORY, &path, true) != B_OK
+		|| path.Append("Weather/Icons") != B_OK
+		|| create_directory(path.Path(), 0755) != B_OK
+		|| path.Append(name.String()) != B_OK)
+		return;
+
+	// The lock is taken on the file the path names once it is held, not
+	// on one that another team replaced meanwhile
+	int fd = -1;
+	for (int32 attempt = 0; attempt < kMaxCacheOpenAttempts; attempt++) {
+		fd = open(path.Path(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+		if (fd < 0)
+			return;
+
+		struct stat opened;
+		struct stat named;
+		if (flock(fd, LOCK_EX) == 0 && fstat(fd, &opened) == 0
+			&& stat(path.Path(), &named) == 0
+			&& opened.st_dev == named.st_dev && opened.st_ino == named.st_ino)
+			break;
+
+		close(fd);
+		fd = -1;
+	}
+	if (fd < 0)
+		return;
+
+	// A cache of other icons is started over
+	size_t fileSize = cache_file_size(sheet->size);
+	struct stat stat;
+	icon_cache_header header;
+	bool valid = fstat(fd, &stat) == 0
+		&& (size_t) stat.st_size == fileSize
+		&& pread(fd, &header, sizeof(header), 0) == (ssize_t) sizeof(header)
+		&& header.magic == kIconCacheMagic
+		&& header.version == kIconCacheVersion
+		&& header.resourceHash == resourceHash
+		&& header.size == sheet->size
+		&& header.scale == scale;
+
+	if (!valid) {
+		// Other teams may have the old cache mapped, truncating it under
+		// them would crash them. Like the forecast store compaction, a new
+		// file is written next to it and renamed over it.
+		memset(&header, 0, sizeof(header));
+		header.magic = kIconCacheMagic;
+		header.version = kIconCacheVersion;
+		header.resourceHash = resourceHash;
+		header.size = sheet->size;
+		header.scale = scale;
+
+		BString temporaryPath(path.Path());
+		temporaryPath << ".tmp";
+		int replacement = open(temporaryPath.String(),
+			O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		valid = replacement >= 0 && ftruncate(replacement, fileSize) == 0
+			&& pwrite(replacement, &header, sizeof(header), 0)
+				== (ssize_t) sizeof(header)
+			&& rename(temporaryPath.String(), path.Path()) == 0;
+
+		if (valid) {
+			// Still holds the lock on the old file, which keeps another
+			// team from replacing the new one before it's in place
+			flock(fd, LOCK_UN);
+			close(fd);
+			fd = replacement;
+		} else {
+			if (replacement >= 0) {
+				close(replacement);
+				unlink(temporaryPath.String());
+			}
+			flock(fd, LOCK_UN);
+		}
+	} else
+		flock(fd, LOCK_UN);
+
+	void* mapping = MAP_FAILED;
+	if (valid)
+		mapping = mmap(NULL, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+	if (mapping == MAP_FAILED) {
+		close(fd);
+		return;
+	}
+
+	sheet->cacheFD = fd;
+	sheet->cache = static_cast<const uint8*>(mapping);
+	sheet->cacheSize = fileSize;
+}
+
+
+void
+IconAtlas::_CloseCache(sheet* sheet)
+{
+	if (sheet->cache != NULL)
+		munmap(const_cast<uint8*>(sheet->cache), sheet->cacheSize);
+	if (sheet->cacheFD >= 0)
+		close(sheet->cacheFD);
+	sheet->cache = NULL;
+	sheet->cacheFD = -1;
+}
+
+
+bool
+IconAtlas::_LoadCached(sheet* sheet, weather_icon icon)
+{
+	if (sheet->cache == NULL)
+		return false;
+
+	// Stored by another launch or another team since we opened it
+	const icon_cache_header* header
+		= reinterpret_cast<const icon_cache_header*>(sheet->cache);
+	if ((header->available & (1ULL << icon)) == 0)
+		return false;
+
+	size_t rowSize = cache_row_size(sheet->size);
+	size_t cellSize = sheet->size * 4;
+	size_t left = (icon % kSheetColumns) * cellSize;
+	size_t top = (icon / kSheetColumns) * sheet->size;
+	const uint8* source = sheet->cache + sizeof(icon_cache_header)
+		+ top * rowSize + left;
+	uint8* target = static_cast<uint8*>(sheet->bitmap->Bits())
+		+ top * sheet->bitmap->BytesPerRow() + left;
+
+	for (uint32 y = 0; y < sheet->size; y++) {
+		memcpy(target, source, cellSize);
+		source += rowSize;
+		target += sheet->bitmap->BytesPerRow();
+	}
+	return true;
+}
+
+
+void
+IconAtlas::_StoreCached(sheet* sheet, weather_icon icon)
+{
+	if (sheet->cache == NULL || flock(sheet->cacheFD, LOCK_EX) != 0)
+		return;
+
+	size_t rowSize = cache_row_size(sheet->size);
+	size_t cellSize = sheet->size * 4;
+	size_t left = (icon % kSheetColumns) * cellSize;
+	size_t top = (icon / kSheetColumns) * sheet->size;
+	off_t offset = sizeof(icon_cache_header) + top * rowSize + left;
+	const uint8* source = static_cast<const uint8*>(sheet->scratch->Bits());
+
+	// The pixels go first, so that nobody sees the icon as available
+	// before they are complete
+	bool written = true;
+	for (uint32 y = 0; y < sheet->size && written; y++) {
+		written = pwrite(sheet->cacheFD, source, cellSize, offset)
+			== (ssize_t) cellSize;
+		source += sheet->scratch->BytesPerRow();
+		offset += rowSize;
+	}
+
+	if (written) {
+		const icon_cache_header* header
+			= reinterpret_cast<const icon_cache_header*>(sheet->cache);
+		uint64 available = header->available | (1ULL << icon);
+		pwrite(sheet->cacheFD, &available, sizeof(available),
+			offsetof(icon_cache_header, available));
+	}
+
+	flock(sheet->cacheFD, LOCK_UN);
+}
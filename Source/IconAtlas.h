@@ -0,0 +1,85 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _ICONATLAS_H_
+#define _ICONATLAS_H_
+
+
+#include <Bitmap.h>
+#include <Locker.h>
+#include <Resources.h>
+
+#include "WeatherCondition.h"
+
+
+const uint32 kSizeSmallIcon = 40;
+const uint32 kSizeLargeIcon = 80;
+
+enum weatherIconSize {
+	SMALL_ICON,
+	LARGE_ICON
+};
+
+
+// Where an icon is in the atlas. Draw it with
+// DrawBitmap(icon.bitmap, icon.frame, destination).
+struct atlas_icon {
+	const BBitmap*	bitmap;
+	BRect			frame;
+};
+
+
+// The weather icons of the whole team, shared by the main window, the
+// replicants and the Deskbar view. All icons of one size are packed into a
+// single bitmap, so the memory used doesn't depend on the number of views.
+// Icons are rasterized on first use; the resources of the Weather
+// executable are opened once, found through the loaded images as
+// replicants don't run in the Weather team.
+//
+// Rasterized icons are kept in a cache file per sheet, which is mapped by
+// later launches and other teams so that they only copy the pixels. The
+// file is keyed by the pixel size and the UI scale factor, and it is
+// started over when the hash of the icon resources changed.
+//
+// The atlas lives as long as it is acquired by a view, bitmaps it returned
+// stay valid until then.
+class IconAtlas
+{
+public:
+	static	IconAtlas*	Acquire();
+	static	void		Release(IconAtlas* atlas);
+
+			// Icon sizes are multiplied by it on high DPI screens
+	static	float		ScaleFactor();
+
+			bool		GetIcon(weather_icon icon, uint32 size,
+							atlas_icon& _icon);
+
+private:
+			struct sheet;
+
+						IconAtlas();
+						~IconAtlas();
+
+			sheet*		_Sheet(uint32 size);
+			status_t	_OpenResources();
+			status_t	_Rasterize(sheet* sheet, weather_icon icon);
+
+			uint64		_ResourceHash();
+			void		_OpenCache(sheet* sheet);
+			void		_CloseCache(sheet* sheet);
+			bool		_LoadCached(sheet* sheet, weather_icon icon);
+			void		_StoreCached(sheet* sheet, weather_icon icon);
+
+			BLocker		fLock;
+			BResources*	fResources;
+			status_t	fResourcesStatus;
+			uint64		fResourceHash;
+			sheet*		fSheets;
+			int32		fSheetCount;
+			int32		fUsers;
+};
+
+
+#endif // _ICONATLAS_H_
@@ -0,0 +1,273 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#include <String.h>
+
+#include <pthread.h>
+#include <string.h>
+
+#include <algorithm>
+#include <new>
+
+#include "LatencyLog.h"
+
+
+struct LatencyLog::entry {
+	uint32			sequence;
+	refresh_latency	latency;
+};
+
+
+const char* kLatencyField = "latency";
+
+static const char* kPhaseNames[kLatencyPhaseCount] = {
+	"dns",
+	"connect",
+	"tls",
+	"first byte",
+	"last byte",
+	"parse",
+	"snapshot",
+	"cache",
+	"delivery",
+	"paint"
+};
+
+static LatencyLog* sDefaultLog = NULL;
+static pthread_once_t sDefaultLogOnce = PTHREAD_ONCE_INIT;
+
+
+static void
+create_default_log()
+{
+	sDefaultLog = new(std::nothrow) LatencyLog();
+}
+
+
+status_t
+AddLatency(BMessage& message, const refresh_latency& latency)
+{
+	return message.AddData(kLatencyField, B_RAW_TYPE, &latency,
+		sizeof(latency));
+}
+
+
+bool
+FindLatency(const BMessage& message, refresh_latency& latency)
+{
+	const void* data;
+	ssize_t size;
+	if (message.FindData(kLatencyField, B_RAW_TYPE, &data, &size) != B_OK
+		|| size != (ssize_t) sizeof(latency))
+		return false;
+
+	memcpy(&latency, data, sizeof(latency));
+	return true;
+}
+
+
+BString
+FormatLatency(bigtime_t duration)
+{
+	BString text;
+	if (duration < 0)
+		text = "-";
+	else
+		text.SetToFormat("%.1f", duration / 1000.0);
+	return text;
+}
+
+
+LatencyLog::LatencyLog()
+	:
+	fEntries(new entry[kCapacity]),
+	fNext(0),
+	fClaimed(new uint64[kCapacity])
+{
+	memset(fEntries, 0, kCapacity * sizeof(entry));
+	memset(fClaimed, 0, kCapacity * sizeof(uint64));
+}
+
+
+/*static*/ LatencyLog*
+LatencyLog::Default()
+{
+	pthread_once(&sDefaultLogOnce, &create_default_log);
+	return sDefaultLog;
+}
+
+
+void
+LatencyLog::Add(const refresh_latency& latency)
+{
+	if (!_Claim(latency))
+		return;
+
+	// The n-th entry is complete once its sequence is 2 n + 2. Writers only
+	// meet on an entry when one is a whole round behind.
+	uint32 index = __atomic_fetch_add(&fNext, 1, __ATOMIC_RELAXED);
+	entry& entry = fEntries[index % kCapacity];
+	uint32 sequence = index * 2 + 1;
+
+	__atomic_store_n(&entry.sequence, sequence, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	entry.latency = latency;
+	__atomic_store_n(&entry.sequence, sequence + 1, __ATOMIC_RELEASE);
+}
+
+
+int32
+LatencyLog::Get(refresh_latency* latencies, int32 count) const
+{
+	uint32 next = __atomic_load_n(&fNext, __ATOMIC_ACQUIRE);
+	uint32 first = next > (uint32) kCapacity ? next - kCapacity : 0;
+	if (next - first > (uint32) count)
+		first = next - count;
+
+	int32 copied = 0;
+	for (uint32 index = first; index != next; index++) {
+		const entry& entry = fEntries[index % kCapacity];
+		uint32 sequence = index * 2 + 2;
+		if (__atomic_load_n(&entry.sequence, __ATOMIC_ACQUIRE) != sequence)
+			continue;
+
+		latencies[copied] = entry.latency;
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&entry.sequence, __ATOMIC_RELAXED) == sequence)
+			copied++;
+	}
+
+	return copied;
+}
+
+
+status_t
+LatencyLog::Dump(BDataIO& output) const
+{
+	refresh_latency* latencies = new(std::nothrow) refresh_latency[kCapacity];
+	if (latencies == NULL)
+		return B_NO_MEMORY;
+
+	int32 count = Get(latencies, kCapacity);
+
+	// Milliseconds, tab separated for spreadsheets
+	BString text("# started\ttotal");
+	for (int32 phase = 0; phase < kLatencyPhaseCount; phase++)
+		text << "\t" << kPhaseNames[phase];
+	text << "\tbytes\tlocations\n";
+
+	for (int32 i = 0; i < count; i++) {
+		const refresh_latency& latency = latencies[i];
+		text << latency.started << "\t"
+			<< FormatLatency(TotalDuration(latency));
+		for (int32 phase = 0; phase < kLatencyPhaseCount; phase++)
+			text << "\t" << FormatLatency(PhaseDuration(latency, phase));
+		text << "\t" << latency.responseSize << "\t" << latency.locations
+			<< "\n";
+	}
+
+	text << "\n# phase\tp50\tp95\n";
+	for (int32 phase = 0; phase <= kLatencyPhaseCount; phase++) {
+		text << PhaseName(phase) << "\t"
+			<< FormatLatency(Percentile(latencies, count, phase, 50)) << "\t"
+			<< FormatLatency(Percentile(latencies, count, phase, 95))
+			<< "\n";
+	}
+
+	delete[] latencies;
+	return output.WriteExactly(text.String(), text.Length());
+}
+
+
+/*static*/ const char*
+LatencyLog::PhaseName(int32 phase)
+{
+	if (phase >= 0 && phase < kLatencyPhaseCount)
+		return kPhaseNames[phase];
+	return "total";
+}
+
+
+/*static*/ bigtime_t
+LatencyLog::PhaseDuration(const refresh_latency& latency, int32 phase)
+{
+	if (latency.ended[phase] == 0)
+		return -1;
+
+	// From the end of the last phase before it that took place
+	bigtime_t start = latency.started;
+	for (int32 i = phase - 1; i >= 0; i--) {
+		if (latency.ended[i] != 0) {
+			start = latency.ended[i];
+			break;
+		}
+	}
+	return std::max(latency.ended[phase] - start, (bigtime_t) 0);
+}
+
+
+/*static*/ bigtime_t
+LatencyLog::TotalDuration(const refresh_latency& latency)
+{
+	for (int32 phase = kLatencyPhaseCount - 1; phase >= 0; phase--) {
+		if (latency.ended[phase] != 0)
+			return latency.ended[phase] - latency.started;
+	}
+	return -1;
+}
+
+
+/*static*/ bigtime_t
+LatencyLog::Percentile(const refresh_latency* latencies, int32 count,
+	int32 phase, int32 percent)
+{
+	bigtime_t* durations = new(std::nothrow) bigtime_t[count];
+	if (durations == NULL)
+		return -1;
+
+	int32 measured = 0;
+	for (int32 i = 0; i < count; i++) {
+		bigtime_t duration = phase < kLatencyPhaseCount
+			? PhaseDuration(latencies[i], phase)
+			: TotalDuration(latencies[i]);
+		if (duration >= 0)
+			durations[measured++] = duration;
+	}
+
+	// Nearest rank
+	bigtime_t result = -1;
+	if (measured > 0) {
+		int32 rank = (measured * percent + 99) / 100;
+		rank = std::min(std::max(rank, (int32) 1), measured);
+		std::nth_element(durations, durations + rank - 1,
+			durations + measured);
+		result = durations[rank - 1];
+	}
+
+	delete[] durations;
+	return result;
+}
+
+
+// Whether the refresh wasn't added before. Each refresh takes the slot of
+// its hash; a refresh so old that another took its slot since would be
+// added again, but no view delivers it that late.
+bool
+LatencyLog::_Claim(const refresh_latency& latency)
+{
+	uint64 hash = (uint64) latency.started * 0x9e3779b97f4a7c15ULL
+		^ (uint64) latency.locationId;
+	if (hash == 0)
+		hash = 1;
+
+	uint64* slot = &fClaimed[hash % kCapacity];
+	uint64 claimed = __atomic_load_n(slot, __ATOMIC_RELAXED);
+	while (claimed != hash) {
+		if (__atomic_compare_exchange_n(slot, &claimed, hash, false,
+				__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			return true;
+	}
+	return false;
+}
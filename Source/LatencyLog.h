@@ -0,0 +1,104 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _LATENCYLOG_H_
+#define _LATENCYLOG_H_
+
+
+#include <DataIO.h>
+#include <Message.h>
+#include <String.h>
+
+
+enum latency_phase {
+	LATENCY_DNS = 0,
+	LATENCY_CONNECT,
+	LATENCY_TLS,
+	LATENCY_FIRST_BYTE,
+	LATENCY_LAST_BYTE,
+	LATENCY_PARSE,
+	LATENCY_SNAPSHOT,
+	LATENCY_CACHE,
+	LATENCY_DELIVERY,
+	LATENCY_PAINT,
+	kLatencyPhaseCount
+};
+
+
+// When each phase of the refresh of one location ended, in system_time(),
+// which is the same in every team. Phases a refresh didn't go through are
+// 0, like the DNS lookup and the connect on a kept alive connection, or
+// the cache write when the forecast isn't cached.
+struct refresh_latency {
+	bigtime_t		started;
+	bigtime_t		ended[kLatencyPhaseCount];
+	uint64			responseSize;
+	// Together with started, tells the refresh apart
+	int64			locationId;
+	int32			locations;
+	int32			reserved;
+};
+
+
+// The timing travels along with the forecast, from the download thread to
+// the view that paints it, in this field of the messages
+extern const char* kLatencyField;
+
+status_t			AddLatency(BMessage& message,
+						const refresh_latency& latency);
+bool				FindLatency(const BMessage& message,
+						refresh_latency& latency);
+
+// In milliseconds, or "-" for a phase a refresh skipped
+BString				FormatLatency(bigtime_t duration);
+
+
+// The last refreshes of the team. Adding to and reading from the log never
+// blocks: every entry has a sequence number that is odd while it is
+// written, readers skip entries that changed while they copied them.
+class LatencyLog
+{
+public:
+						LatencyLog();
+
+	static	LatencyLog*	Default();
+
+			// Every view showing the location may add the refresh, only
+			// the first one is kept
+			void		Add(const refresh_latency& latency);
+
+			// Copies up to count entries, the oldest first, and returns
+			// how many there were
+			int32		Get(refresh_latency* latencies, int32 count) const;
+
+			// A table of the entries followed by the percentiles of every
+			// phase
+			status_t	Dump(BDataIO& output) const;
+
+	static	const char*	PhaseName(int32 phase);
+			// How long the phase took, or -1 if the refresh skipped it
+	static	bigtime_t	PhaseDuration(const refresh_latency& latency,
+							int32 phase);
+	static	bigtime_t	TotalDuration(const refresh_latency& latency);
+
+			// Of the phase, or of the whole refresh for kLatencyPhaseCount.
+			// Returns -1 if none of the refreshes went through the phase.
+	static	bigtime_t	Percentile(const refresh_latency* latencies,
+							int32 count, int32 phase, int32 percent);
+
+	static	const int32	kCapacity = 256;
+
+private:
+			struct entry;
+
+			bool		_Claim(const refresh_latency& latency);
+
+			entry*		fEntries;
+			uint32		fNext;
+			// The refreshes added last, by their hash
+			uint64*		fClaimed;
+};
+
+
+#endif // _LATENCYLOG_H_
@@ -26,6 +26,7 @@
 #include <Deskbar.h>
 #include <Roster.h>
 
+#include "DiagnosticsWindow.h"
 #include "ForecastDeskbarView.h"
 #include "ForecastView.h"
 #include "MainWindow.h"
@@ -52,6 +53,8 @@ MainWindow::_PrepareMenuBar(void)
 		new BMessage(kCitySelectionMessage), 'L'));
 	menu->AddItem(new BMenuItem(B_TRANSLATE("Preferences" B_UTF8_ELLIPSIS),
 		new BMessage(kOpenPreferencesMessage), ','));
+	menu->AddItem(new BMenuItem(B_TRANSLATE("Diagnostics" B_UTF8_ELLIPSIS),
+		new BMessage(kOpenDiagnosticsMessage)));
 	menu->AddSeparatorItem();
 	menu->AddItem(new BMenuItem(
 		B_TRANSLATE("About Weather"), new BMessage(B_ABOUT_REQUESTED)));
@@ -70,7 +73,8 @@ MainWindow::MainWindow()
 		B_NOT_RESIZABLE | B_NOT_ZOOMABLE | B_ASYNCHRONOUS_CONTROLS
 			| B_QUIT_ON_WINDOW_CLOSE | B_AUTO_UPDATE_SIZE_LIMITS),
 	fSelectionWindow(NULL),
-	fPreferencesWindow(NULL)
+	fPreferencesWindow(NULL),
+	fDiagnosticsWindow(NULL)
 {
 	BGroupLayout* root = new BGroupLayout(B_VERTICAL);
 	root->SetSpacing(0);
@@ -151,6 +155,18 @@ MainWindow::MessageReceived(BMessage* msg)
 				fPreferencesWindow->Activate();
 			break;
 		}
+		case kOpenDiagnosticsMessage:
+		{
+			if (fDiagnosticsWindow == NULL) {
+				fDiagnosticsWindow = new DiagnosticsWindow(Frame(), this);
+				fDiagnosticsWindow->Show();
+			} else
+				fDiagnosticsWindow->Activate();
+			break;
+		}
+		case kCloseDiagnosticsWindowMessage:
+			fDiagnosticsWindow = NULL;
+			break;
 		case kCloseCitySelectionWindowMessage:
 			fSelectionWindow = NULL;
 			break;
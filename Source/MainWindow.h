@@ -28,13 +28,13 @@
 const BRect kDefaultMainWindowRect = BRect(150, 150, 0, 0);
 const uint32 kCitySelectionMessage = 'SelC';
 const uint32 kOpenPreferencesMessage = 'OPrf';
+const uint32 kOpenDiagnosticsMessage = 'ODgn';
 const uint32 kToggleDeskbarReplicantMessage = 'TDkB';
 
 const uint32 kCitiesListMessage = 'lstC';
 const uint32 kDataMessage = 'Data';
-const uint32 kForecastDataMessage = 'FDta';
+const uint32 kForecastSnapshotMessage = 'FSnp';
 const uint32 kFailureMessage = 'Fail';
-const uint32 kUpdateCityName = 'UpCN';
 const uint32 kUpdateTTLMessage = 'TTLm';
 
 class MainWindow : public BWindow
@@ -57,6 +57,7 @@ private:
 	BRect			fMainWindowRect;
 	CitiesListSelectionWindow*	fSelectionWindow;
 	PreferencesWindow* fPreferencesWindow;
+	BWindow*		fDiagnosticsWindow;
 
 	BMenuItem*		fShowForecastMenuItem;
 	BMenuItem*		fReplicantMenuItem;
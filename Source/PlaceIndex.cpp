@@ -0,0 +1,236 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#include <FindDirectory.h>
+#include <PathFinder.h>
+#include <StringList.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <new>
+
+#include "CaseFold.h"
+#include "PlaceIndex.h"
+
+
+static const char* kPlaceIndexPath = "Weather/places.index";
+static const size_t kMaxQueryLength = 256;
+
+static PlaceIndex* sDefaultIndex = NULL;
+static pthread_once_t sDefaultIndexOnce = PTHREAD_ONCE_INIT;
+
+
+// Truncates on a character boundary
+static void
+copy_string(char* target, size_t size, const char* source)
+{
+	size_t length = strlen(source);
+	if (length >= size) {
+		length = size - 1;
+		while (length > 0 && (source[length] & 0xc0) == 0x80)
+			length--;
+	}
+	memcpy(target, source, length);
+	target[length] = '\0';
+}
+
+
+static void
+open_default_index()
+{
+	BStringList paths;
+	if (BPathFinder::FindPaths(B_FIND_PATH_DATA_DIRECTORY, kPlaceIndexPath,
+			B_FIND_PATH_EXISTING_ONLY, paths) != B_OK)
+		return;
+
+	for (int32 i = 0; i < paths.CountStrings(); i++) {
+		PlaceIndex* index = new(std::nothrow) PlaceIndex(
+			paths.StringAt(i).String());
+		if (index != NULL && index->InitCheck() == B_OK) {
+			sDefaultIndex = index;
+			return;
+		}
+		delete index;
+	}
+}
+
+
+PlaceIndex::PlaceIndex(const char* path)
+	:
+	fData(NULL),
+	fSize(0),
+	fStatus(B_NO_INIT)
+{
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		fStatus = errno;
+		return;
+	}
+
+	struct stat stat;
+	if (fstat(fd, &stat) != 0
+		|| stat.st_size < (off_t) sizeof(place_index_header)) {
+		close(fd);
+		fStatus = B_BAD_DATA;
+		return;
+	}
+
+	void* data = mmap(NULL, stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		fStatus = errno;
+		return;
+	}
+
+	fData = static_cast<const uint8*>(data);
+	fSize = stat.st_size;
+	fHeader = reinterpret_cast<const place_index_header*>(fData);
+
+	// Only check that every section lies within the file, the content is
+	// trusted as it is built by our own tool
+	uint64 nodesEnd = (uint64) fHeader->nodesOffset
+		+ (uint64) fHeader->nodeCount * sizeof(place_index_node);
+	uint64 topEnd = (uint64) fHeader->topOffset
+		+ (uint64) fHeader->topCount * sizeof(uint32);
+	uint64 placesEnd = (uint64) fHeader->placesOffset
+		+ (uint64) fHeader->placeCount * sizeof(place_index_place);
+	uint64 labelsEnd = (uint64) fHeader->labelsOffset + fHeader->labelsSize;
+	uint64 stringsEnd = (uint64) fHeader->stringsOffset
+		+ fHeader->stringsSize;
+
+	if (fHeader->magic != PLACE_INDEX_MAGIC
+		|| fHeader->version != PLACE_INDEX_VERSION
+		|| fHeader->nodeCount == 0 || nodesEnd > fSize || topEnd > fSize
+		|| placesEnd > fSize || labelsEnd > fSize || stringsEnd > fSize
+		|| fHeader->stringsSize == 0 || fData[stringsEnd - 1] != '\0') {
+		fStatus = B_BAD_DATA;
+		return;
+	}
+
+	fNodes = reinterpret_cast<const place_index_node*>(
+		fData + fHeader->nodesOffset);
+	fTop = reinterpret_cast<const uint32*>(fData + fHeader->topOffset);
+	fPlaces = reinterpret_cast<const place_index_place*>(
+		fData + fHeader->placesOffset);
+	fLabels = reinterpret_cast<const char*>(fData + fHeader->labelsOffset);
+	fStrings = reinterpret_cast<const char*>(fData + fHeader->stringsOffset);
+	fStatus = B_OK;
+}
+
+
+PlaceIndex::~PlaceIndex()
+{
+	if (fData != NULL)
+		munmap(const_cast<uint8*>(fData), fSize);
+}
+
+
+status_t
+PlaceIndex::InitCheck() const
+{
+	return fStatus;
+}
+
+
+/*static*/ PlaceIndex*
+PlaceIndex::Default()
+{
+	pthread_once(&sDefaultIndexOnce, &open_default_index);
+	return sDefaultIndex;
+}
+
+
+int32
+PlaceIndex::Search(const char* query, city_result* results,
+	int32 maxResults) const
+{
+	if (fStatus != B_OK)
+		return 0;
+
+	while (*query == ' ')
+		query++;
+	size_t length = strnlen(query, kMaxQueryLength);
+	while (length > 0 && query[length - 1] == ' ')
+		length--;
+	if (length == 0)
+		return 0;
+
+	// The keys are folded like this by the tool
+	char key[kMaxQueryLength];
+	length = FoldCase(query, length, key);
+
+	const place_index_node* node = &fNodes[0];
+	size_t position = 0;
+	while (position < length) {
+		node = _Child(*node, key[position]);
+		if (node == NULL)
+			return 0;
+
+		// The query may end within the label
+		size_t compare = node->labelLength;
+		if (compare > length - position)
+			compare = length - position;
+		if (memcmp(fLabels + node->labelOffset, key + position, compare) != 0)
+			return 0;
+		position += compare;
+	}
+
+	int32 count = 0;
+	for (; count < node->topCount && count < maxResults; count++)
+		_CopyPlace(fTop[node->firstTop + count], results[count]);
+	return count;
+}
+
+
+const place_index_node*
+PlaceIndex::_Child(const place_index_node& node, uint8 byte) const
+{
+	// Children are sorted by the first byte of their label
+	int32 low = 0;
+	int32 high = node.childCount - 1;
+	while (low <= high) {
+		int32 middle = (low + high) / 2;
+		const place_index_node& child = fNodes[node.firstChild + middle];
+		uint8 first = fLabels[child.labelOffset];
+		if (first == byte)
+			return &child;
+		if (first < byte)
+			low = middle + 1;
+		else
+			high = middle - 1;
+	}
+	return NULL;
+}
+
+
+const char*
+PlaceIndex::_String(uint32 offset) const
+{
+	return offset < fHeader->stringsSize ? fStrings + offset : "";
+}
+
+
+void
+PlaceIndex::_CopyPlace(uint32 index, city_result& result) const
+{
+	const place_index_place& place = fPlaces[index];
+	result.id = place.id;
+	result.countryId = place.countryId;
+	result.latitude = place.latitude;
+	result.longitude = place.longitude;
+
+	copy_string(result.name, sizeof(result.name), _String(place.name));
+	copy_string(result.country, sizeof(result.country),
+		_String(place.country));
+	copy_string(result.admin1, sizeof(result.admin1), _String(place.admin1));
+	copy_string(result.admin2, sizeof(result.admin2), _String(place.admin2));
+	copy_string(result.admin3, sizeof(result.admin3), _String(place.admin3));
+}
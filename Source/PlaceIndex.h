@@ -0,0 +1,51 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _PLACEINDEX_H_
+#define _PLACEINDEX_H_
+
+
+#include <SupportDefs.h>
+
+#include "ForecastData.h"
+#include "PlaceIndexFormat.h"
+
+
+// Offline place index installed with the application, see
+// tools/BuildPlaceIndex.cpp. It is memory-mapped and queried in place.
+class PlaceIndex
+{
+public:
+						PlaceIndex(const char* path);
+						~PlaceIndex();
+
+			status_t	InitCheck() const;
+
+	// The installed index, or NULL if there is none
+	static	PlaceIndex*	Default();
+
+			// Fills in the most populous places whose name starts with the
+			// query, returns their number
+			int32		Search(const char* query, city_result* results,
+							int32 maxResults) const;
+
+private:
+			const place_index_node* _Child(const place_index_node& node,
+							uint8 byte) const;
+			const char*	_String(uint32 offset) const;
+			void		_CopyPlace(uint32 index, city_result& result) const;
+
+			const uint8* fData;
+			size_t		fSize;
+			const place_index_header* fHeader;
+			const place_index_node* fNodes;
+			const uint32* fTop;
+			const place_index_place* fPlaces;
+			const char*	fLabels;
+			const char*	fStrings;
+			status_t	fStatus;
+};
+
+
+#endif // _PLACEINDEX_H_
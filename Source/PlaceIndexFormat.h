@@ -0,0 +1,72 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _PLACEINDEXFORMAT_H_
+#define _PLACEINDEXFORMAT_H_
+
+
+// On-disk layout of the offline place index, shared between PlaceIndex and
+// the tools/BuildPlaceIndex tool, which also builds on other platforms.
+// Everything is little endian and naturally aligned.
+//
+// The index is a radix trie over the place names, their case folded by
+// FoldCase(): every edge is labeled with a run of bytes, so chains of single
+// children are collapsed into one node. The children of a node are stored
+// next to each other and sorted by the first byte of their label. Each node
+// lists the most populous places below it, so a prefix query ends with the
+// node it reaches.
+
+#include <stdint.h>
+
+
+#define PLACE_INDEX_MAGIC		0x496c5057	// "WPlI"
+#define PLACE_INDEX_VERSION		2
+#define PLACE_INDEX_TOP_PLACES	10
+
+
+struct place_index_header {
+	uint32_t		magic;
+	uint32_t		version;
+	uint32_t		nodeCount;
+	uint32_t		placeCount;
+	uint32_t		topCount;
+	uint32_t		labelsSize;
+	uint32_t		stringsSize;
+	uint32_t		nodesOffset;
+	uint32_t		topOffset;
+	uint32_t		placesOffset;
+	uint32_t		labelsOffset;
+	uint32_t		stringsOffset;
+};
+
+
+// Node 0 is the root, its label is empty
+struct place_index_node {
+	uint32_t		labelOffset;
+	uint32_t		firstChild;
+	uint32_t		firstTop;
+		// index of the first place number in the top table
+	uint16_t		labelLength;
+	uint16_t		childCount;
+	uint16_t		topCount;
+	uint16_t		reserved;
+};
+
+
+// Strings are offsets of NUL terminated UTF-8 strings in the string table
+struct place_index_place {
+	double			latitude;
+	double			longitude;
+	int32_t			id;
+	int32_t			countryId;
+	uint32_t		population;
+	uint32_t		name;
+	uint32_t		country;
+	uint32_t		admin1;
+	uint32_t		admin2;
+	uint32_t		admin3;
+};
+
+
+#endif // _PLACEINDEXFORMAT_H_
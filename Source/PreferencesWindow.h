@@ -13,18 +13,14 @@
 #include <String.h>
 #include <Window.h>
 
+#include "Units.h"
+
 class MainWindow;
 
 const int32 kSavePrefMessage = 'SavP';
 const int32 kUpdatePrefMessage = 'UpdM';
 const int32 kClosePrefWindowMessage = 'CPrW';
 
-enum DisplayUnit {
-	CELSIUS = 1,
-	FAHRENHEIT = 2
-};
-typedef enum DisplayUnit DisplayUnit;
-
 class PreferencesWindow : public BWindow
 {
 public:
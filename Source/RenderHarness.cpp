@@ -0,0 +1,410 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#include <Bitmap.h>
+#include <BitmapStream.h>
+#include <Directory.h>
+#include <File.h>
+#include <NodeInfo.h>
+#include <Path.h>
+#include <Screen.h>
+#include <String.h>
+#include <TranslatorFormats.h>
+#include <TranslatorRoster.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <new>
+
+#include "ForecastDayView.h"
+#include "ForecastSnapshot.h"
+#include "ForecastView.h"
+#include "OpenMeteoDecoder.h"
+#include "RenderHarness.h"
+
+
+struct color_mode {
+	const char*		name;
+	bool			transparent;
+	rgb_color		background;
+	rgb_color		text;
+};
+
+
+static const color_mode kColorModes[] = {
+	{"default", false, {0, 0, 0, 0}, {0, 0, 0, 0}},
+	{"dark", false, {43, 43, 43, 255}, {230, 230, 230, 255}},
+	{"transparent", true, {0, 0, 0, 0}, {0, 0, 0, 0}}
+};
+static const int32 kColorModeCount
+	= sizeof(kColorModes) / sizeof(kColorModes[0]);
+
+static const float kBenchmarkScales[] = {1.0f, 1.5f, 2.0f};
+static const int32 kBenchmarkScaleCount
+	= sizeof(kBenchmarkScales) / sizeof(kBenchmarkScales[0]);
+
+static const size_t kReadBufferSize = 64 * 1024;
+
+
+static status_t
+load_recorded_snapshot(const char* path, BReference<ForecastSnapshot>& _snapshot)
+{
+	BFile file(path, B_READ_ONLY);
+	status_t status = file.InitCheck();
+	if (status != B_OK)
+		return status;
+
+	ForecastDecoder* decoder = new(std::nothrow) ForecastDecoder();
+	char* buffer = new(std::nothrow) char[kReadBufferSize];
+	if (decoder == NULL || buffer == NULL) {
+		delete decoder;
+		delete[] buffer;
+		return B_NO_MEMORY;
+	}
+
+	ssize_t bytesRead;
+	while ((bytesRead = file.Read(buffer, kReadBufferSize)) > 0) {
+		status = decoder->Feed(buffer, bytesRead);
+		if (status != B_OK)
+			break;
+	}
+	if (bytesRead < 0)
+		status = bytesRead;
+	if (status == B_OK)
+		status = decoder->Finish();
+	if (status == B_OK && decoder->CountForecasts() == 0)
+		status = B_BAD_DATA;
+
+	if (status == B_OK) {
+		const forecast_data& data = decoder->Data();
+		int64 time = data.hourly.count > 0 ? data.hourly.startTime
+			: data.daily.count > 0 ? data.daily.time[0] : 0;
+		ForecastSnapshot* snapshot
+			= new(std::nothrow) ForecastSnapshot(data, time, time);
+		if (snapshot == NULL)
+			status = B_NO_MEMORY;
+		else
+			_snapshot.SetTo(snapshot, true);
+	}
+
+	delete decoder;
+	delete[] buffer;
+	return status;
+}
+
+
+static ForecastView*
+create_view(const color_mode& mode, ForecastSnapshot* snapshot)
+{
+	BMessage settings(kSettingsMessage);
+	settings.AddString("city", kDefaultCityName);
+	settings.AddInt32("displayUnit", CELSIUS);
+	settings.AddBool("showForecast", true);
+
+	rgb_color background = mode.transparent ? B_TRANSPARENT_COLOR
+		: mode.background.alpha != 0 ? mode.background
+		: ui_color(B_PANEL_BACKGROUND_COLOR);
+	rgb_color text = mode.text.alpha != 0 ? mode.text
+		: ui_color(B_PANEL_TEXT_COLOR);
+	settings.AddData("backgroundColor", B_RGB_COLOR_TYPE, &background,
+		sizeof(background));
+	settings.AddData("textColor", B_RGB_COLOR_TYPE, &text, sizeof(text));
+
+	return new(std::nothrow) ForecastView(BRect(0, 0, 0, 0), &settings,
+		snapshot);
+}
+
+
+// Offscreen windows get no update requests, so the hooks are called here
+// in the order the app_server would
+static void
+draw_hierarchy(BView* view)
+{
+	if (view->IsHidden())
+		return;
+
+	view->Draw(view->Bounds());
+	for (int32 i = 0; BView* child = view->ChildAt(i); i++)
+		draw_hierarchy(child);
+	if ((view->Flags() & B_DRAW_ON_CHILDREN) != 0)
+		view->DrawAfterChildren(view->Bounds());
+}
+
+
+static void
+collect_tiles(BView* view, ForecastDayView** tiles, int32& count,
+	int32 maxCount)
+{
+	ForecastDayView* tile = dynamic_cast<ForecastDayView*>(view);
+	if (tile != NULL && count < maxCount) {
+		tiles[count++] = tile;
+		return;
+	}
+
+	for (int32 i = 0; BView* child = view->ChildAt(i); i++)
+		collect_tiles(child, tiles, count, maxCount);
+}
+
+
+// Views drawing on the desktop expect it below them
+static void
+clear_bitmap(BBitmap* bitmap, bool transparent)
+{
+	rgb_color color = transparent ? BScreen().DesktopColor()
+		: make_color(0, 0, 0, 255);
+	uint8* row = static_cast<uint8*>(bitmap->Bits());
+	int32 width = bitmap->Bounds().IntegerWidth() + 1;
+	int32 height = bitmap->Bounds().IntegerHeight() + 1;
+	for (int32 y = 0; y < height; y++) {
+		uint8* pixel = row;
+		for (int32 x = 0; x < width; x++) {
+			pixel[0] = color.blue;
+			pixel[1] = color.green;
+			pixel[2] = color.red;
+			pixel[3] = 255;
+			pixel += 4;
+		}
+		row += bitmap->BytesPerRow();
+	}
+}
+
+
+class OffscreenRender {
+public:
+	OffscreenRender(ForecastView* view, const color_mode& mode, float scale)
+		:
+		fView(view),
+		fBitmap(NULL),
+		fTransparent(mode.transparent),
+		fTileCount(0)
+	{
+		BSize size = view->PreferredSize();
+		BRect frame(0, 0, ceilf((size.width + 1) * scale) - 1,
+			ceilf((size.height + 1) * scale) - 1);
+
+		fBitmap = new(std::nothrow) BBitmap(frame, B_BITMAP_ACCEPTS_VIEWS,
+			B_RGBA32);
+		if (fBitmap == NULL || fBitmap->InitCheck() != B_OK) {
+			delete fBitmap;
+			fBitmap = NULL;
+			delete view;
+			return;
+		}
+
+		fBitmap->Lock();
+		view->ResizeTo(frame.Width(), frame.Height());
+		fBitmap->AddChild(view);
+		view->Layout(true);
+		collect_tiles(view, fTiles, fTileCount, kMaxTiles);
+		fBitmap->Unlock();
+	}
+
+	~OffscreenRender()
+	{
+		if (fBitmap == NULL)
+			return;
+
+		fBitmap->Lock();
+		fBitmap->RemoveChild(fView);
+		fBitmap->Unlock();
+		delete fView;
+		delete fBitmap;
+	}
+
+	bool IsValid() const
+	{
+		return fBitmap != NULL;
+	}
+
+	BBitmap* Bitmap() const
+	{
+		return fBitmap;
+	}
+
+	int32 CountTiles() const
+	{
+		return fTileCount;
+	}
+
+	bigtime_t Draw(bool dropTileCache)
+	{
+		fBitmap->Lock();
+		if (dropTileCache) {
+			for (int32 i = 0; i < fTileCount; i++)
+				fTiles[i]->SetViewColor(fTiles[i]->ViewColor());
+		}
+
+		bigtime_t start = system_time();
+		clear_bitmap(fBitmap, fTransparent);
+		draw_hierarchy(fView);
+		fView->Sync();
+		bigtime_t elapsed = system_time() - start;
+
+		fBitmap->Unlock();
+		return elapsed;
+	}
+
+	BBitmap* CopyTile(int32 index) const
+	{
+		ForecastDayView* tile = fTiles[index];
+		BRect frame = tile->Frame();
+		for (BView* parent = tile->Parent(); parent != fView;
+				parent = parent->Parent())
+			frame = parent->ConvertToParent(frame);
+
+		BBitmap* bitmap = new(std::nothrow) BBitmap(
+			frame.OffsetToCopy(B_ORIGIN), 0, B_RGBA32);
+		if (bitmap == NULL || bitmap->InitCheck() != B_OK) {
+			delete bitmap;
+			return NULL;
+		}
+
+		bitmap->ImportBits(fBitmap, frame.LeftTop(), B_ORIGIN,
+			frame.IntegerWidth() + 1, frame.IntegerHeight() + 1);
+		return bitmap;
+	}
+
+private:
+	enum {
+		kMaxTiles = 16
+	};
+
+	ForecastView*	fView;
+	BBitmap*		fBitmap;
+	bool			fTransparent;
+	ForecastDayView* fTiles[kMaxTiles];
+	int32			fTileCount;
+};
+
+
+static status_t
+write_png(BBitmap* bitmap, const BPath& path)
+{
+	BFile file(path.Path(), B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+	status_t status = file.InitCheck();
+	if (status != B_OK)
+		return status;
+
+	BBitmapStream stream(bitmap);
+	status = BTranslatorRoster::Default()->Translate(&stream, NULL, NULL,
+		&file, B_PNG_FORMAT);
+
+	// The bitmap stays ours
+	BBitmap* detached;
+	stream.DetachBitmap(&detached);
+
+	if (status == B_OK)
+		BNodeInfo(&file).SetType("image/png");
+	return status;
+}
+
+
+status_t
+RenderToFiles(const char* responsePath, const char* outputDirectory)
+{
+	BReference<ForecastSnapshot> snapshot;
+	status_t status = load_recorded_snapshot(responsePath, snapshot);
+	if (status != B_OK) {
+		fprintf(stderr, "Could not read the forecast from %s: %s\n",
+			responsePath, strerror(status));
+		return status;
+	}
+
+	status = create_directory(outputDirectory, 0755);
+	if (status != B_OK)
+		return status;
+
+	for (int32 i = 0; i < kColorModeCount && status == B_OK; i++) {
+		const color_mode& mode = kColorModes[i];
+		ForecastView* view = create_view(mode, snapshot.Get());
+		if (view == NULL)
+			return B_NO_MEMORY;
+
+		OffscreenRender render(view, mode, 1.0f);
+		if (!render.IsValid())
+			return B_NO_MEMORY;
+		render.Draw(false);
+
+		BString name;
+		name.SetToFormat("widget-%s.png", mode.name);
+		BPath path(outputDirectory, name.String());
+		status = write_png(render.Bitmap(), path);
+		if (status == B_OK)
+			printf("%s\n", path.Path());
+
+		for (int32 tile = 0; tile < render.CountTiles() && status == B_OK;
+				tile++) {
+			BBitmap* bitmap = render.CopyTile(tile);
+			if (bitmap == NULL)
+				return B_NO_MEMORY;
+
+			name.SetToFormat("tile-%s-%" B_PRId32 ".png", mode.name, tile);
+			path.SetTo(outputDirectory, name.String());
+			status = write_png(bitmap, path);
+			if (status == B_OK)
+				printf("%s\n", path.Path());
+			delete bitmap;
+		}
+	}
+
+	if (status != B_OK)
+		fprintf(stderr, "Could not write the images: %s\n", strerror(status));
+	return status;
+}
+
+
+status_t
+RunRenderBenchmark(const char* responsePath, int32 frames)
+{
+	BReference<ForecastSnapshot> snapshot;
+	status_t status = load_recorded_snapshot(responsePath, snapshot);
+	if (status != B_OK) {
+		fprintf(stderr, "Could not read the forecast from %s: %s\n",
+			responsePath, strerror(status));
+		return status;
+	}
+
+	frames = std::max(frames, (int32) 1);
+	printf("%-12s %5s %11s %11s %11s %11s\n", "mode", "scale", "cold (ms)",
+		"warm (ms)", "warm min", "warm max");
+
+	for (int32 i = 0; i < kColorModeCount; i++) {
+		const color_mode& mode = kColorModes[i];
+		for (int32 j = 0; j < kBenchmarkScaleCount; j++) {
+			ForecastView* view = create_view(mode, snapshot.Get());
+			if (view == NULL)
+				return B_NO_MEMORY;
+
+			OffscreenRender render(view, mode, kBenchmarkScales[j]);
+			if (!render.IsValid())
+				return B_NO_MEMORY;
+
+			// Cold frames draw the day tiles again, warm ones find them
+			// in their cache like most exposes do
+			bigtime_t cold = 0;
+			for (int32 frame = 0; frame < frames; frame++)
+				cold += render.Draw(true);
+
+			bigtime_t warm = 0;
+			bigtime_t warmMin = B_INFINITE_TIMEOUT;
+			bigtime_t warmMax = 0;
+			for (int32 frame = 0; frame < frames; frame++) {
+				bigtime_t elapsed = render.Draw(false);
+				warm += elapsed;
+				warmMin = std::min(warmMin, elapsed);
+				warmMax = std::max(warmMax, elapsed);
+			}
+
+			printf("%-12s %5.2f %11.3f %11.3f %11.3f %11.3f\n", mode.name,
+				kBenchmarkScales[j], cold / 1000.0 / frames,
+				warm / 1000.0 / frames, warmMin / 1000.0, warmMax / 1000.0);
+		}
+	}
+
+	return B_OK;
+}
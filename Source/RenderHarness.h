@@ -0,0 +1,29 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _RENDERHARNESS_H_
+#define _RENDERHARNESS_H_
+
+
+#include <SupportDefs.h>
+
+
+// Draws the weather views into offscreen bitmaps from a recorded Open-Meteo
+// forecast response, without a window nor network, to compare them with
+// known good images or to time them. The current conditions are the ones
+// of the first recorded hour, so the result doesn't depend on the clock.
+//
+// Both need a BApplication object to exist.
+
+// Writes widget-<mode>.png and tile-<mode>-<day>.png for each color mode
+// into the directory
+status_t			RenderToFiles(const char* responsePath,
+						const char* outputDirectory);
+
+// Prints the time per frame for each color mode and size
+status_t			RunRenderBenchmark(const char* responsePath,
+						int32 frames);
+
+
+#endif // _RENDERHARNESS_H_
@@ -7,48 +7,71 @@
  */
 
 #include <Alert.h>
-#include <Json.h>
 #include <Messenger.h>
 #include <StorageKit.h>
 
 #include <parsedate.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 
+#include <new>
+
+#include "ForecastCache.h"
+#include "ForecastSnapshot.h"
+#include "ForecastStore.h"
+#include "LatencyLog.h"
 #include "MainWindow.h"
 #include "PreferencesWindow.h"
 #include "WSOpenMeteo.h"
 
 
-WSOpenMeteo::WSOpenMeteo(const BMessenger& messenger, BMallocIO* responseData, RequestType requestType)
+WSOpenMeteo::WSOpenMeteo(const BMessenger& messenger, RequestType requestType)
 	:
-	BUrlProtocolListener(),
 	fMessenger(messenger),
 	fRequestType(requestType),
-	fResponseData(responseData)
+	fDecoder(NULL),
+	fLocations(NULL),
+	fLocationCount(0),
+	fFirstLocationIndex(0),
+	fUnit(CELSIUS),
+	fCacheTimeToLive(0),
+	fRetryAfter(0)
 {
+	memset(&fTiming, 0, sizeof(fTiming));
+	if (fRequestType == WEATHER_REQUEST)
+		fDecoder = new ForecastDecoder();
+	else
+		fDecoder = new CityDecoder();
 }
 
 
 WSOpenMeteo::~WSOpenMeteo()
 {
+	delete fDecoder;
+	delete[] fLocations;
 }
 
 
-void
-WSOpenMeteo::ResponseStarted(BUrlRequest* caller)
+status_t
+WSOpenMeteo::DataReceived(const char* data, size_t size)
 {
+	// Returning an error aborts the transfer, no point in downloading the
+	// rest of a malformed document
+	return fDecoder->Feed(data, size);
 }
 
 
 void
-WSOpenMeteo::DataReceived(BUrlRequest* caller, const char* data, off_t position, ssize_t size)
+WSOpenMeteo::RequestCompleted(status_t status, const http_timing& timing,
+	int32 retryAfter)
 {
-}
+	fTiming = timing;
+	fRetryAfter = retryAfter;
 
+	// An error page isn't decoded, also when it's JSON
+	bool success = status == B_OK;
 
-void
-WSOpenMeteo::RequestCompleted(BUrlRequest* caller, bool success)
-{
 	if (fRequestType == WEATHER_REQUEST)
 		_ProcessWeatherData(success);
 
@@ -57,238 +80,191 @@ WSOpenMeteo::RequestCompleted(BUrlRequest* caller, bool success)
 }
 
 
+status_t
+WSOpenMeteo::SetLocations(const forecast_location* locations, int32 count,
+	DisplayUnit unit, int32 firstIndex)
+{
+	if (count > kMaxBatchLocations)
+		count = kMaxBatchLocations;
+
+	// The replies are matched to the locations in the order they were
+	// asked for
+	forecast_location* copy = new(std::nothrow) forecast_location[count];
+	if (copy == NULL)
+		return B_NO_MEMORY;
+	for (int32 i = 0; i < count; i++)
+		copy[i] = locations[i];
+
+	delete[] fLocations;
+	fLocations = copy;
+	fLocationCount = count;
+	fFirstLocationIndex = firstIndex;
+	fUnit = unit;
+
+	if (fRequestType == WEATHER_REQUEST)
+		static_cast<ForecastDecoder*>(fDecoder)->SetLocationCount(count);
+	return B_OK;
+}
+
+
 BString
-WSOpenMeteo::GetUrl(double longitude, double latitude, DisplayUnit unit)
+WSOpenMeteo::GetUrl() const
 {
-	BString urlString("https://api.open-meteo.com/v1/forecast?latitude=");
-	urlString
-		<< latitude << "&longitude=" << longitude
-		<< "&daily=weathercode,temperature_2m_max,temperature_2m_min&current_"
-		   "weather=true&timeformat=unixtime&timezone=auto";
-
-	// Temperature unit measure
-	switch (unit) {
-		case FAHRENHEIT:
-			urlString << "&temperature_unit=fahrenheit";
-			break;
-		case CELSIUS:
-			urlString << "&temperature_unit=celsius";
-			break;
-		default: // CELSIUS
-			urlString << "&temperature_unit=celsius";
-	}
+	return BString(ForecastUrl(fLocations, fLocationCount, fUnit).c_str());
+}
 
-	return urlString;
+
+void
+WSOpenMeteo::SetReplyFields(const BMessage& fields)
+{
+	fReplyFields = fields;
 }
 
 
 void
-WSOpenMeteo::_ProcessWeatherData(bool success)
+WSOpenMeteo::SetCacheTimeToLive(int32 timeToLive)
 {
-	BMessenger messenger(fMessenger);
-	BString jsonString;
+	fCacheTimeToLive = timeToLive;
+}
 
-	if (!success) {
-		BMessage* message = new BMessage(kFailureMessage);
-		messenger.SendMessage(message);
-		return;
+
+bool
+WSOpenMeteo::_Decoded(bool success)
+{
+	if (!success)
+		return false;
+
+	status_t status = fDecoder->Finish();
+	if (status != B_OK) {
+		printf("JSON Parser error at offset %" B_PRIuSIZE ": %s\n",
+			fDecoder->Offset(), strerror(status));
+		return false;
 	}
 
-	jsonString.SetTo(static_cast<const char*>(fResponseData->Buffer()),
-		fResponseData->BufferLength());
+	if (fDecoder->IsServiceError()) {
+		printf("Open-Meteo error: %s\n", fDecoder->ServiceErrorReason());
+		return false;
+	}
 
+	return true;
+}
 
-	BMessage parsedData;
-	BJson parser;
 
-	status_t status = parser.Parse(jsonString, parsedData);
-	if (status == B_BAD_DATA) {
-		printf("JSON Parser error for data:\n%s\n", jsonString.String());
-		BMessage* message = new BMessage(kFailureMessage);
-		messenger.SendMessage(message);
+void
+WSOpenMeteo::_ProcessWeatherData(bool success)
+{
+	BMessenger messenger(fMessenger);
+
+	ForecastDecoder* decoder = static_cast<ForecastDecoder*>(fDecoder);
+	if (!_Decoded(success) || decoder->CountForecasts() == 0) {
+		// Without a "location", the failure is for all of them
+		_SendFailure();
 		return;
 	}
 
-#if DEBUG
-	SerializeBMessage(&parsedData, "weather_parsed_data");
-#endif
-
-	const int maxDaysForecast = 5;
-	struct {
-		double date;
-		double maxTemperature;
-		double minTemperature;
-		double weatherCode;
-	} dailyWeather[maxDaysForecast];
-
-	BMessage* message = new BMessage(kUpdateCityName);
-	messenger.SendMessage(message);
-
-	// Get UTC timezone offset, use 0 as default
-	double utc_offset;
-	if (parsedData.FindDouble("utc_offset_seconds", &utc_offset) != B_OK)
-		utc_offset = 0;
-
-	// Get weather forecast
-	char* name;
-	uint32 type;
-	int32 count, condition;
-	double high, low, temp;
-	BString code, text;		
-		
-	int dayCount = 0;
-
-	BMessage weatherData;
-
-	if (parsedData.FindMessage("daily", &weatherData) == B_OK) {
-
-		for (int32 i = 0;
-			weatherData.GetInfo(B_MESSAGE_TYPE, i, &name, &type, &count) == B_OK;
-			i++) {
-
-			// time unroll
-			if (strcmp(name, "time") == 0) {
-				BMessage dayMessage;
-				if (weatherData.FindMessage(name, &dayMessage) == B_OK) {
-
-					double date;
-					int32 tCount;
-					uint32 tType;
-					char* tName;
-					for (int32 tDay = 0; dayMessage.GetInfo(B_DOUBLE_TYPE, tDay,
-											 &tName, &tType, &tCount) == B_OK
-							 && tDay < maxDaysForecast;
-							tDay++) {
-
-						if (dayMessage.FindDouble(tName, &date) == B_OK)
-							// Offset is added to get the correct date for the timezone selected
-							dailyWeather[tDay].date = date + utc_offset; 
-					}
-				}
-			}
-
-			// min temperature unroll
-			if (strcmp(name, "temperature_2m_min") == 0) {
-				BMessage tempMessage;
-				if (weatherData.FindMessage(name, &tempMessage) == B_OK) {
-
-					double minTemperature;
-
-					int32 tCount;
-					uint32 tType;
-					char* tName;
-					for (int32 tDay = 0; tempMessage.GetInfo(B_DOUBLE_TYPE,
-											 tDay, &tName, &tType, &tCount) == B_OK
-							&& tDay < maxDaysForecast;
-							tDay++) {
-
-						if (tempMessage.FindDouble(tName, &minTemperature) == B_OK)
-							dailyWeather[tDay].minTemperature = (int) minTemperature;
-					}
-				}
-			}
-
-			// max temperature unroll
-			if (strcmp(name, "temperature_2m_max") == 0) {
-				BMessage tempMessage;
-				if (weatherData.FindMessage(name, &tempMessage) == B_OK) {
-
-					double minTemperature;
-
-					int32 tCount;
-					uint32 tType;
-					char* tName;
-					for (int32 tDay = 0; tempMessage.GetInfo(B_DOUBLE_TYPE,
-											 tDay, &tName, &tType, &tCount) == B_OK
-							 && tDay < maxDaysForecast;
-							tDay++) {
-
-						if (tempMessage.FindDouble(tName, &minTemperature) == B_OK)
-							dailyWeather[tDay].maxTemperature = (int) minTemperature;
-					}
-				}
-			}
-
-			// weathercode unroll
-			if (strcmp(name, "weathercode") == 0) {
-				BMessage codeMessage;
-				if (weatherData.FindMessage(name, &codeMessage) == B_OK) {
-
-					double code;
-
-					int32 tCount;
-					uint32 tType;
-					char* tName;
-					for (int32 tDay = 0; codeMessage.GetInfo(B_DOUBLE_TYPE, tDay, &tName, &tType, 							&tCount) == B_OK && tDay < maxDaysForecast; tDay++) {
-
-						if (codeMessage.FindDouble(tName, &code) == B_OK)
-							dailyWeather[tDay].weatherCode = (int) code;
-					}
-				}
-			}
+	// The rest of the refresh is timed by the views
+	refresh_latency latency;
+	memset(&latency, 0, sizeof(latency));
+	latency.started = fTiming.started;
+	latency.ended[LATENCY_DNS] = fTiming.resolved;
+	latency.ended[LATENCY_CONNECT] = fTiming.connected;
+	latency.ended[LATENCY_TLS] = fTiming.secured;
+	latency.ended[LATENCY_FIRST_BYTE] = fTiming.firstByte;
+	latency.ended[LATENCY_LAST_BYTE] = fTiming.lastByte;
+	latency.ended[LATENCY_PARSE] = system_time();
+	latency.responseSize = fTiming.size;
+	latency.locations = fLocationCount;
+
+	int64 now = time(NULL);
+	for (int32 i = 0; i < fLocationCount; i++) {
+		int32 location = fFirstLocationIndex + i;
+		int64 locationId = ForecastLocationId(fLocations[i].latitude,
+			fLocations[i].longitude, fUnit);
+
+		// Only the work on this location is timed, the time spent on
+		// those before it counts as waiting for the delivery
+		bigtime_t locationStarted = system_time();
+		refresh_latency located = latency;
+		located.locationId = locationId;
+
+		BReference<ForecastSnapshot> snapshot;
+		if (i < decoder->CountForecasts()
+			&& decoder->ForecastAt(i).hourly.count > 0) {
+			snapshot.SetTo(new(std::nothrow) ForecastSnapshot(
+				decoder->ForecastAt(i), now), true);
 		}
-	}
-
-	// Get forecast
-	for (int tDay = 0; tDay < maxDaysForecast; tDay++) {
-		BMessage* message = new BMessage(kForecastDataMessage);
-		message->AddInt32("forecast", tDay);
-		message->AddInt32("high", (int) dailyWeather[tDay].maxTemperature);
-		message->AddInt32("low", (int) dailyWeather[tDay].minTemperature);
-		message->AddInt32("condition", dailyWeather[tDay].weatherCode);
-
-		// get unix timestamp
-		BDate date = BDate((time_t) dailyWeather[tDay].date);
-		BString dayOfWeek;
-		switch (date.DayOfWeek()) {
-			case 1:
-				dayOfWeek = "Mon";
-				break;
-			case 2:
-				dayOfWeek = "Tue";
-				break;
-			case 3:
-				dayOfWeek = "Wed";
-				break;
-			case 4:
-				dayOfWeek = "Thu";
-				break;
-			case 5:
-				dayOfWeek = "Fri";
-				break;
-			case 6:
-				dayOfWeek = "Sat";
-				break;
-			case 7:
-				dayOfWeek = "Sun";
-				break;
-			default:
-				dayOfWeek = "Undefined";
+		if (snapshot.Get() == NULL) {
+			_SendFailure(location);
+			continue;
+		}
+		bigtime_t built = system_time();
+		located.ended[LATENCY_SNAPSHOT] = located.ended[LATENCY_PARSE]
+			+ built - locationStarted;
+
+		// Still in the download thread, so the view doesn't wait for the
+		// disk
+		if (fCacheTimeToLive > 0) {
+			ForecastCache cache(fLocations[i].latitude,
+				fLocations[i].longitude, fUnit);
+			cache.Store(snapshot.Get(), fCacheTimeToLive);
+			located.ended[LATENCY_CACHE] = located.ended[LATENCY_SNAPSHOT]
+				+ system_time() - built;
 		}
 
-		message->AddString("day", dayOfWeek.String());
-		messenger.SendMessage(message);
+		// The whole forecast is published at once
+		BMessage message(kForecastSnapshotMessage);
+		if (SnapshotMailbox::Post(message, locationId, snapshot.Get())
+				!= B_OK) {
+			_SendFailure(location);
+			continue;
+		}
+		message.AddInt32("location", location);
+		AddLatency(message, located);
+		message.Append(fReplyFields);
+		messenger.SendMessage(&message);
 	}
+}
 
-	// Get current weather
-	BMessage currentWeatherData;
-	if (parsedData.FindMessage("current_weather", &currentWeatherData)
-		== B_OK) {
-
-		double temperature;
-		double condition;
-		double time;
-
-		BMessage* currentMessage = new BMessage(kDataMessage);
 
-		if (currentWeatherData.FindDouble("temperature", &temperature) == B_OK)
-			currentMessage->AddInt32("temp", (int) temperature);
+void
+WSOpenMeteo::_SendFailure(int32 location)
+{
+	BMessage message(kFailureMessage);
+	if (location >= 0)
+		message.AddInt32("location", location);
+	if (fRetryAfter > 0)
+		message.AddInt32("retry after", fRetryAfter);
+	message.Append(fReplyFields);
+	fMessenger.SendMessage(&message);
+}
 
-		if (currentWeatherData.FindDouble("weathercode", &condition) == B_OK)
-			currentMessage->AddInt32("condition", (int) condition);
 
-		messenger.SendMessage(currentMessage);
-	}
+/*static*/ void
+WSOpenMeteo::AddCity(BMessage* message, const city_result& result)
+{
+	BString locationName(result.name);
+	BString country(result.country);
+	BString admin1(result.admin1);
+	BString admin2(result.admin2);
+	BString admin3(result.admin3);
+	BString extendedInfo = "";
+
+	extendedInfo << locationName;
+	if (admin3 != "" && admin3 != locationName && admin3 != country)
+		extendedInfo << ", " << admin3;
+	if (admin2 != "" && admin2 != locationName && admin2 != country)
+		extendedInfo << ", "<< admin2;
+	if (admin1 != "" && admin1 != locationName && admin1 != country)
+		extendedInfo << ", "<< admin1;
+	extendedInfo << ", " << country;
+
+	message->AddInt32("id", result.id);
+	message->AddString("city", locationName);
+	message->AddString("country", country);
+	message->AddInt32("country_id", result.countryId);
+	message->AddString("extended_info", extendedInfo);
+	message->AddDouble("longitude", result.longitude);
+	message->AddDouble("latitude", result.latitude);
 }
 
 
@@ -312,89 +288,21 @@ void
 WSOpenMeteo::_ProcessCityData(bool success)
 {
 	BMessenger messenger(fMessenger);
-	BString jsonString;
 
-	if (!success) {
-		messenger.SendMessage(new BMessage(kFailureMessage));
+	if (!_Decoded(success)) {
+		_SendFailure();
 		return;
 	}
 
-	BMessage parsedData;
-	BJson parser;
-	jsonString.SetTo(static_cast<const char*>(fResponseData->Buffer()),
-		fResponseData->BufferLength());
+	BMessage message(kCitiesListMessage);
+	message.Append(fReplyFields);
 
-	status_t status = parser.Parse(jsonString, parsedData);
+	CityDecoder* decoder = static_cast<CityDecoder*>(fDecoder);
+	for (int32 i = 0; i < decoder->CountResults(); i++)
+		AddCity(&message, decoder->ResultAt(i));
 
 #if DEBUG
-	SerializeBMessage(&parsedData, "weather_parsed_location");
-#endif
-
-	if (status == B_BAD_DATA) {
-		printf("JSON Parser error for data:\n%s\n", jsonString.String());
-		BMessage* message = new BMessage(kFailureMessage);
-		messenger.SendMessage(message);
-		return;
-	}
-
-	char* name;
-	uint32 type;
-	int32 count;
-
-	BMessage* message = new BMessage(kCitiesListMessage);
-
-	BMessage results;
-	if (parsedData.FindMessage("results", &results) == B_OK) {
-		for (int32 i = 0;
-			results.GetInfo(B_MESSAGE_TYPE, i, &name, &type, &count) == B_OK;
-			i++) {
-
-			BMessage locationMessage;
-			BString locationName = "";
-			double latitude = 0L;
-			double longitude = 0L;
-			double countryId = 0L;
-			double id = 0L;
-			BString country = "";
-			BString admin1 = "";
-			BString admin2 = "";
-			BString admin3 = "";
-			BString extendedInfo = "";
-
-			if (results.FindMessage(name, &locationMessage) == B_OK) {
-				locationMessage.FindDouble("id", &id);
-				locationMessage.FindString("name", &locationName);
-				locationMessage.FindString("country", &country);
-				locationMessage.FindDouble("country_id", &countryId);
-				locationMessage.FindString("admin1", &admin1);
-				locationMessage.FindString("admin2", &admin2);
-				locationMessage.FindString("admin3", &admin3);
-				
-				extendedInfo << locationName;
-				if (admin3 != "" && admin3 != locationName && admin3 != country)
-					extendedInfo << ", " << admin3;
-				if (admin2 != "" && admin2 != locationName && admin2 != country)
-					extendedInfo << ", "<< admin2;
-				if (admin1 != "" && admin1 != locationName && admin1 != country)
-					extendedInfo << ", "<< admin1;
-				extendedInfo << ", " << country;
-							 
-				locationMessage.FindDouble("longitude", &longitude);
-				locationMessage.FindDouble("latitude", &latitude);
-
-				message->AddInt32("id", (int) id);
-				message->AddString("city", locationName);
-				message->AddString("country", country);
-				message->AddInt32("country_id", countryId);
-				message->AddString("extended_info", extendedInfo);
-				message->AddDouble("longitude", longitude);
-				message->AddDouble("latitude", latitude);
-			}
-		}
-	}
-	
-#if DEBUG
-	SerializeBMessage(message, "weather_location_message");
+	SerializeBMessage(&message, "weather_location_message");
 #endif
-	messenger.SendMessage(message);
+	messenger.SendMessage(&message);
 }
@@ -6,11 +6,12 @@
 #ifndef _WSOPENMETEO_H_
 #define _WSOPENMETEO_H_
 
-#include <DataIO.h>
 #include <Looper.h>
 #include <String.h>
-#include <UrlProtocolListener.h>
 
+#include "HttpSession.h"
+#include "OpenMeteoDecoder.h"
+#include "OpenMeteoUrl.h"
 #include "PreferencesWindow.h"
 
 enum RequestType {
@@ -18,28 +19,54 @@ enum RequestType {
 	WEATHER_REQUEST
 };
 
-using namespace BPrivate::Network;
-
-class WSOpenMeteo : public BUrlProtocolListener
+// The response body is written straight into the decoder as it arrives,
+// without being buffered.
+class WSOpenMeteo : public HttpListener
 {
 public:
-						WSOpenMeteo(const BMessenger& messenger, BMallocIO* responseData, 
+						WSOpenMeteo(const BMessenger& messenger,
 							RequestType requestType);
 	virtual				~WSOpenMeteo();
 
-	virtual	void		ResponseStarted(BUrlRequest* caller);
-	virtual	void		DataReceived(BUrlRequest* caller, const char* data, 
-							off_t position, ssize_t size);
-	virtual	void		RequestCompleted(BUrlRequest* caller, bool success);
+	virtual	status_t	DataReceived(const char* data, size_t size);
+	virtual	void		RequestCompleted(status_t status,
+							const http_timing& timing, int32 retryAfter);
+
+	// The forecasts of up to kMaxBatchLocations locations in one request.
+	// Each forecast reply names its location in its "location" field, the
+	// index in the array plus firstIndex.
+	status_t			SetLocations(const forecast_location* locations,
+							int32 count, DisplayUnit unit,
+							int32 firstIndex = 0);
+	// The request for the locations
+	BString				GetUrl() const;
+
+	// Appends a city the way kCitiesListMessage lists them
+	static void			AddCity(BMessage* message, const city_result& result);
+
+	// Copied into every reply, to tell them apart
+	void				SetReplyFields(const BMessage& fields);
 
-	BString				GetUrl(double longitude, double latitude, DisplayUnit unit);
+	// Successful forecasts are also written to the cache, to live there
+	// for the given number of seconds
+	void				SetCacheTimeToLive(int32 timeToLive);
 
 private:
+	bool				_Decoded(bool success);
 	void				_ProcessWeatherData(bool success);
+	void				_SendFailure(int32 location = -1);
 	void				_ProcessCityData(bool success);
 	BMessenger			fMessenger;
 	RequestType 		fRequestType;
-	BMallocIO*			fResponseData;
+	BMessage			fReplyFields;
+	OpenMeteoDecoder*	fDecoder;
+	forecast_location*	fLocations;
+	int32				fLocationCount;
+	int32				fFirstLocationIndex;
+	DisplayUnit			fUnit;
+	int32				fCacheTimeToLive;
+	http_timing			fTiming;
+	int32				fRetryAfter;
 	void				SerializeBMessage(BMessage* message, BString fileName);
 };
 
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#include <string.h>
+
+#include "CaseFold.h"
+
+
+// Ranges where the upper case letters are the even code points and each is
+// followed by its lower case one, or the odd ones when oddUpper is set
+struct case_pairs {
+	uint32		first;
+	uint32		last;
+	bool		oddUpper;
+};
+
+static const case_pairs kCasePairs[] = {
+	{ 0x0100, 0x012f, false },
+	{ 0x0132, 0x0137, false },
+	{ 0x0139, 0x0148, true },
+	{ 0x014a, 0x0177, false },
+	{ 0x0179, 0x017e, true },
+	{ 0x01cd, 0x01dc, true },
+	{ 0x01de, 0x01ef, false },
+	{ 0x01f8, 0x021f, false },
+	{ 0x0222, 0x0233, false },
+	{ 0x0460, 0x0481, false },
+	{ 0x048a, 0x04bf, false },
+	{ 0x04c1, 0x04ce, true },
+	{ 0x04d0, 0x052f, false },
+	{ 0x1e00, 0x1e95, false },
+	{ 0x1ea0, 0x1eff, false }
+};
+
+
+static uint32
+to_lower(uint32 c)
+{
+	if (c < 0x80)
+		return c >= 'A' && c <= 'Z' ? c + 'a' - 'A' : c;
+
+	// Latin-1, without the multiplication sign
+	if (c >= 0xc0 && c <= 0xde && c != 0xd7)
+		return c + 0x20;
+	// Dotted capital I, Turkish
+	if (c == 0x130)
+		return 'i';
+	// Capital Y with diaeresis, its lower case is in Latin-1
+	if (c == 0x178)
+		return 0xff;
+
+	// Greek, the basic letters and the ones with tonos
+	if ((c >= 0x391 && c <= 0x3a1) || (c >= 0x3a3 && c <= 0x3ab))
+		return c + 0x20;
+	if (c == 0x386)
+		return 0x3ac;
+	if (c >= 0x388 && c <= 0x38a)
+		return c + 0x25;
+	if (c == 0x38c)
+		return 0x3cc;
+	if (c == 0x38e || c == 0x38f)
+		return c + 0x3f;
+
+	// Cyrillic and Armenian
+	if (c >= 0x400 && c <= 0x40f)
+		return c + 0x50;
+	if (c >= 0x410 && c <= 0x42f)
+		return c + 0x20;
+	if (c >= 0x531 && c <= 0x556)
+		return c + 0x30;
+
+	for (size_t i = 0; i < sizeof(kCasePairs) / sizeof(kCasePairs[0]); i++) {
+		const case_pairs& pairs = kCasePairs[i];
+		if (c < pairs.first || c > pairs.last)
+			continue;
+		if ((c & 1) == (pairs.oddUpper ? 1u : 0u))
+			return c + 1;
+		break;
+	}
+	return c;
+}
+
+
+// Returns the length of the character at text, 0 if it isn't valid UTF-8
+static size_t
+decode(const uint8* text, size_t length, uint32& c)
+{
+	if (text[0] < 0x80) {
+		c = text[0];
+		return 1;
+	}
+
+	size_t size;
+	if ((text[0] & 0xe0) == 0xc0) {
+		size = 2;
+		c = text[0] & 0x1f;
+	} else if ((text[0] & 0xf0) == 0xe0) {
+		size = 3;
+		c = text[0] & 0x0f;
+	} else if ((text[0] & 0xf8) == 0xf0) {
+		size = 4;
+		c = text[0] & 0x07;
+	} else
+		return 0;
+
+	if (size > length)
+		return 0;
+	for (size_t i = 1; i < size; i++) {
+		if ((text[i] & 0xc0) != 0x80)
+			return 0;
+		c = (c << 6) | (text[i] & 0x3f);
+	}
+	return size;
+}
+
+
+static size_t
+encode(uint32 c, uint8* text)
+{
+	if (c < 0x80) {
+		text[0] = c;
+		return 1;
+	}
+	if (c < 0x800) {
+		text[0] = 0xc0 | (c >> 6);
+		text[1] = 0x80 | (c & 0x3f);
+		return 2;
+	}
+
+	// Nothing that folds is beyond the Basic Multilingual Plane
+	text[0] = 0xe0 | (c >> 12);
+	text[1] = 0x80 | ((c >> 6) & 0x3f);
+	text[2] = 0x80 | (c & 0x3f);
+	return 3;
+}
+
+
+size_t
+FoldCase(const char* text, size_t length, char* folded)
+{
+	const uint8* source = reinterpret_cast<const uint8*>(text);
+	uint8* target = reinterpret_cast<uint8*>(folded);
+
+	size_t position = 0;
+	size_t foldedLength = 0;
+	while (position < length) {
+		uint32 c = 0;
+		size_t size = decode(source + position, length - position, c);
+		uint32 lower = size != 0 ? to_lower(c) : c;
+		if (size == 0 || lower == c) {
+			// Kept byte by byte, as it may be longer than any character
+			// that folds. Folding in place works, as nothing grows.
+			if (size == 0)
+				size = 1;
+			memmove(target + foldedLength, source + position, size);
+			foldedLength += size;
+		} else
+			foldedLength += encode(lower, target + foldedLength);
+		position += size;
+	}
+	return foldedLength;
+}
@@ -0,0 +1,24 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _CASEFOLD_H_
+#define _CASEFOLD_H_
+
+
+#include "CoreDefs.h"
+
+
+// Lower-cases UTF-8 text for comparisons that ignore case, like the keys
+// of the place index. The index is built by a host tool and searched by
+// the application, so both need the very same folding, which is why it
+// doesn't come from the platform. It covers the scripts of place names
+// that have case: Latin, Greek, Cyrillic and Armenian. Anything else,
+// invalid UTF-8 included, is kept as it is.
+//
+// The folded text is never longer than the text, and may be written over
+// it. Returns its length, folded isn't NUL terminated.
+size_t				FoldCase(const char* text, size_t length, char* folded);
+
+
+#endif // _CASEFOLD_H_
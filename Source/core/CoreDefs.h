@@ -0,0 +1,93 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _COREDEFS_H_
+#define _COREDEFS_H_
+
+
+// The core only needs the integer types, error codes and clock of the
+// Support and Kernel Kits. They are the real ones on Haiku and stand-ins
+// elsewhere, so that the core builds, and can be profiled and run under
+// the sanitizers, on any POSIX system.
+
+#ifdef __HAIKU__
+
+#include <OS.h>
+#include <SupportDefs.h>
+
+#else
+
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+
+typedef int8_t				int8;
+typedef uint8_t				uint8;
+typedef int16_t				int16;
+typedef uint16_t			uint16;
+typedef int32_t				int32;
+typedef uint32_t			uint32;
+typedef int64_t				int64;
+typedef uint64_t			uint64;
+
+typedef int32				status_t;
+typedef int64				bigtime_t;
+typedef int32				thread_id;
+
+#define B_PRId32			PRId32
+#define B_PRIu32			PRIu32
+#define B_PRId64			PRId64
+#define B_PRIu64			PRIu64
+
+// Negative like Haiku's, and errno values where Haiku has them too
+#define B_OK				((status_t) 0)
+#define B_ERROR				((status_t) -1)
+#define B_NO_MEMORY			((status_t) -ENOMEM)
+#define B_IO_ERROR			((status_t) -EIO)
+#define B_BAD_VALUE			((status_t) -EINVAL)
+#define B_BUSY				((status_t) -EBUSY)
+#define B_DEVICE_FULL		((status_t) -ENOSPC)
+#define B_ENTRY_NOT_FOUND	((status_t) -ENOENT)
+#define B_NO_INIT			((status_t) (INT_MIN + 13))
+#define B_BAD_DATA			((status_t) (INT_MIN + 16))
+
+#define B_FROM_POSIX_ERROR(error)	(-(error))
+
+
+// Microseconds since some time in the past, like system_time() on Haiku
+static inline bigtime_t
+system_time()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (bigtime_t) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+
+// Only tells the calling thread apart from the others, like
+// find_thread(NULL)
+static inline thread_id
+find_thread(const char* /*name*/)
+{
+	return (thread_id) (uintptr_t) pthread_self();
+}
+
+
+static inline status_t
+snooze(bigtime_t microseconds)
+{
+	return usleep(microseconds) == 0 ? B_OK : B_FROM_POSIX_ERROR(errno);
+}
+
+#endif // __HAIKU__
+
+
+#endif // _COREDEFS_H_
@@ -0,0 +1,753 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+// Checks the JSON parser, the Open-Meteo decoder, the hourly kernels and
+// what is derived from them, the URLs, the weather conditions, the case
+// folding of place names, the forecast store and the refresh scheduler.
+// Run by "make check", prints the failed checks and exits with 1 if there
+// were any.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <new>
+#include <string>
+
+#include "CaseFold.h"
+#include "ForecastStore.h"
+#include "HourlyForecast.h"
+#include "JsonStreamParser.h"
+#include "OpenMeteoDecoder.h"
+#include "OpenMeteoUrl.h"
+#include "RefreshScheduler.h"
+#include "WeatherCondition.h"
+
+
+static int32 sChecks = 0;
+static int32 sFailures = 0;
+
+
+#define CHECK(condition) \
+	check((condition), #condition, __FILE__, __LINE__)
+
+
+static bool
+check(bool passed, const char* condition, const char* file, int line)
+{
+	sChecks++;
+	if (!passed) {
+		sFailures++;
+		fprintf(stderr, "%s:%d: failed: %s\n", file, line, condition);
+	}
+	return passed;
+}
+
+
+// Numbers are parsed digit by digit, they may be off in the last bit
+static bool
+near(double value, double expected)
+{
+	return fabs(value - expected) <= fabs(expected) * 1e-6;
+}
+
+
+// Writes the events down in a compact notation to compare them
+class EventRecorder : public JsonStreamListener
+{
+public:
+	virtual	void		ObjectStarted() { fEvents += "{"; }
+	virtual	void		ObjectEnded() { fEvents += "}"; }
+	virtual	void		ArrayStarted() { fEvents += "["; }
+	virtual	void		ArrayEnded() { fEvents += "]"; }
+	virtual	void		Key(const char* key, size_t length)
+							{ _Add("k:", key, length); }
+	virtual	void		String(const char* value, size_t length)
+							{ _Add("s:", value, length); }
+	virtual	void		Number(double value)
+	{
+		char number[32];
+		snprintf(number, sizeof(number), "n:%g;", value);
+		fEvents += number;
+	}
+	virtual	void		Boolean(bool value)
+							{ fEvents += value ? "true;" : "false;"; }
+	virtual	void		Null() { fEvents += "null;"; }
+
+			std::string	fEvents;
+
+private:
+			void		_Add(const char* kind, const char* text, size_t length)
+	{
+		fEvents += kind;
+		fEvents.append(text, length);
+		fEvents += ";";
+	}
+};
+
+
+static status_t
+parse(const char* json, size_t chunkSize, std::string& events)
+{
+	EventRecorder recorder;
+	JsonStreamParser parser(&recorder);
+
+	size_t length = strlen(json);
+	status_t status = B_OK;
+	for (size_t offset = 0; offset < length && status == B_OK;
+			offset += chunkSize) {
+		size_t size = length - offset < chunkSize ? length - offset : chunkSize;
+		status = parser.Feed(json + offset, size);
+	}
+	if (status == B_OK)
+		status = parser.Finish();
+
+	events = recorder.fEvents;
+	return status;
+}
+
+
+static const char* kDailyResponse
+	= "{\"latitude\":37.45,\"longitude\":-122.18,\"utc_offset_seconds\":-25200,"
+	"\"timezone\":\"America/Los_Angeles\",\"current_weather\":"
+	"{\"temperature\":14.5,\"windspeed\":6.7,\"weathercode\":82,\"is_day\":1,"
+	"\"time\":1776452400},\"daily_units\":{\"time\":\"unixtime\"},"
+	"\"daily\":{\"time\":[1776409200,1776495600,1776582000],"
+	"\"weathercode\":[0,82,48],\"temperature_2m_max\":[19.7,21.5,12.7],"
+	"\"temperature_2m_min\":[15.3,11.1,6.6]}}";
+
+static const char* kHourlyBatchResponse
+	= "[{\"utc_offset_seconds\":3600,\"hourly\":{\"time\":[1776409200,"
+	"1776412800,1776416400],\"temperature_2m\":[1.5,null,-2.25],"
+	"\"precipitation_probability\":[10,20,30],\"weathercode\":[3,61,71]}},"
+	"{\"utc_offset_seconds\":0,\"hourly\":{\"time\":[1776409200,1776412800],"
+	"\"temperature_2m\":[20,21],\"is_day\":[0,1]}}]";
+
+
+static void
+test_parser()
+{
+	static const char* kDocument = "{\"a\":[1,-2.5e1,true,false,null],"
+		"\"b\\\"\":\"x\\u00e9\\ud83d\\ude00\\n\",\"c\":{}}";
+	static const char* kEvents = "{k:a;[n:1;n:-25;true;false;null;]"
+		"k:b\";s:x\xc3\xa9\xf0\x9f\x98\x80\n;k:c;{}}";
+
+	// Split at every byte, a token straddles the chunks
+	std::string events;
+	CHECK(parse(kDocument, strlen(kDocument), events) == B_OK);
+	CHECK(events == kEvents);
+	for (size_t chunkSize = 1; chunkSize < 8; chunkSize++) {
+		CHECK(parse(kDocument, chunkSize, events) == B_OK);
+		CHECK(events == kEvents);
+	}
+
+	CHECK(parse("  [ 0.125 , 1E3 ] ", 3, events) == B_OK);
+	CHECK(events == "[n:0.125;n:1000;]");
+
+	// Malformed and truncated documents
+	CHECK(parse("{\"a\":}", 2, events) != B_OK);
+	CHECK(parse("[1,]", 1, events) != B_OK);
+	CHECK(parse("[1,2", 4, events) != B_OK);
+	CHECK(parse("\"open", 5, events) != B_OK);
+	CHECK(parse("[tru]", 4, events) != B_OK);
+	CHECK(parse("[1] 2", 5, events) != B_OK);
+
+	// Deeper than the parser goes
+	std::string deep(100, '[');
+	deep += std::string(100, ']');
+	CHECK(parse(deep.c_str(), 16, events) != B_OK);
+
+	// Reset() makes it take a new document
+	EventRecorder recorder;
+	JsonStreamParser parser(&recorder);
+	CHECK(parser.Feed("{", 1) == B_OK);
+	parser.Reset();
+	recorder.fEvents.clear();
+	CHECK(parser.Feed("[]", 2) == B_OK && parser.Finish() == B_OK);
+	CHECK(recorder.fEvents == "[]");
+}
+
+
+static status_t
+decode(OpenMeteoDecoder& decoder, const char* json, size_t chunkSize)
+{
+	decoder.Reset();
+
+	size_t length = strlen(json);
+	status_t status = B_OK;
+	for (size_t offset = 0; offset < length && status == B_OK;
+			offset += chunkSize) {
+		size_t size = length - offset < chunkSize ? length - offset : chunkSize;
+		status = decoder.Feed(json + offset, size);
+	}
+	if (status == B_OK)
+		status = decoder.Finish();
+	return status;
+}
+
+
+static void
+test_decoder()
+{
+	ForecastDecoder* decoder = new ForecastDecoder();
+
+	for (size_t chunkSize = 1; chunkSize <= 64; chunkSize *= 4) {
+		CHECK(decode(*decoder, kDailyResponse, chunkSize) == B_OK);
+		CHECK(!decoder->IsServiceError());
+		CHECK(decoder->CountForecasts() == 1);
+
+		const forecast_data& data = decoder->Data();
+		CHECK(data.utcOffset == -25200);
+		CHECK(data.current.valid && data.current.isDay);
+		CHECK(near(data.current.temperature, 14.5));
+		CHECK(data.current.weatherCode == 82);
+		CHECK(data.current.time == 1776452400);
+		CHECK(data.daily.count == 3);
+		CHECK(data.daily.time[2] == 1776582000);
+		CHECK(data.daily.weatherCode[1] == 82);
+		CHECK(near(data.daily.maxTemperature[0], 19.7));
+		CHECK(near(data.daily.minTemperature[2], 6.6));
+		CHECK(data.hourly.count == 0);
+	}
+
+	// A batch, with more locations asked for than answered
+	CHECK(decoder->SetLocationCount(3) == B_OK);
+	CHECK(decode(*decoder, kHourlyBatchResponse, 7) == B_OK);
+	CHECK(decoder->CountForecasts() == 2);
+
+	const forecast_data& first = decoder->ForecastAt(0);
+	CHECK(first.utcOffset == 3600);
+	CHECK(first.hourly.count == 3);
+	CHECK(first.hourly.startTime == 1776409200);
+	CHECK(first.hourly.values[HOURLY_TEMPERATURE][0] == 1.5f);
+	CHECK(isnan(first.hourly.values[HOURLY_TEMPERATURE][1]));
+	CHECK(first.hourly.values[HOURLY_TEMPERATURE][2] == -2.25f);
+	CHECK(first.hourly.values[HOURLY_PRECIPITATION_PROBABILITY][2] == 30);
+	CHECK(first.hourly.values[HOURLY_WEATHER_CODE][1] == 61);
+	CHECK(isnan(first.hourly.values[HOURLY_IS_DAY][0]));
+
+	const forecast_data& second = decoder->ForecastAt(1);
+	CHECK(second.hourly.count == 2);
+	CHECK(second.hourly.values[HOURLY_TEMPERATURE][1] == 21);
+	CHECK(second.hourly.values[HOURLY_IS_DAY][1] == 1);
+	CHECK(!decoder->ForecastAt(0).current.valid);
+
+	// The service tells what it didn't like
+	CHECK(decode(*decoder,
+		"{\"error\":true,\"reason\":\"Latitude must be in range\"}", 5)
+			== B_OK);
+	CHECK(decoder->IsServiceError());
+	CHECK(strcmp(decoder->ServiceErrorReason(), "Latitude must be in range")
+		== 0);
+	CHECK(decoder->CountForecasts() == 0);
+
+	CHECK(decode(*decoder, "{\"daily\":{\"time\":[1,", 4) != B_OK);
+
+	delete decoder;
+
+	CityDecoder* cities = new CityDecoder();
+	CHECK(decode(*cities, "{\"results\":[{\"id\":5,\"name\":\"Z\\u00fcrich\","
+		"\"latitude\":47.37,\"longitude\":8.55,\"country\":\"Switzerland\","
+		"\"country_id\":2658434,\"admin1\":\"Zurich\"},{\"id\":6,"
+		"\"name\":\"Berlin\",\"latitude\":52.52,\"longitude\":13.41}]}", 9)
+			== B_OK);
+	CHECK(cities->CountResults() == 2);
+	if (cities->CountResults() == 2) {
+		const city_result& city = cities->ResultAt(0);
+		CHECK(city.id == 5);
+		CHECK(strcmp(city.name, "Z\xc3\xbcrich") == 0);
+		CHECK(strcmp(city.country, "Switzerland") == 0);
+		CHECK(city.countryId == 2658434);
+		CHECK(near(city.latitude, 47.37));
+		CHECK(strcmp(cities->ResultAt(1).name, "Berlin") == 0);
+		CHECK(cities->ResultAt(1).admin1[0] == '\0');
+	}
+	delete cities;
+}
+
+
+static void
+test_store()
+{
+	const char* directory = getenv("TMPDIR");
+	std::string path = directory != NULL ? directory : "/tmp";
+	path += "/weather-core-test-XXXXXX";
+	int fd = mkstemp(&path[0]);
+	if (!CHECK(fd >= 0))
+		return;
+	close(fd);
+	// The store creates the file itself
+	unlink(path.c_str());
+
+	int64 berlin = ForecastLocationId(52.52, 13.41, 0);
+	int64 berlinFahrenheit = ForecastLocationId(52.52, 13.41, 1);
+	int64 sydney = ForecastLocationId(-33.87, 151.21, 0);
+	CHECK(berlin != 0 && sydney != 0);
+	CHECK(berlin != berlinFahrenheit && berlin != sydney);
+	// Within the same 1/100 degree
+	CHECK(ForecastLocationId(52.521, 13.409, 0) == berlin);
+
+	forecast_data* data = new forecast_data;
+	memset(data, 0, sizeof(*data));
+	data->utcOffset = 7200;
+	data->daily.count = 1;
+	data->daily.maxTemperature[0] = 21.5f;
+
+	{
+		ForecastStore store(path.c_str());
+		CHECK(store.InitCheck() == B_OK);
+		CHECK(store.CountLocations() == 0);
+		CHECK(store.Lock());
+		CHECK(store.Lookup(berlin) == NULL);
+		store.Unlock();
+
+		uint32 sequence = store.Sequence();
+		CHECK(store.Append(berlin, 1000, 3600, *data) == B_OK);
+		CHECK(store.Sequence() != sequence);
+		data->utcOffset = 36000;
+		CHECK(store.Append(sydney, 1100, 3600, *data) == B_OK);
+		CHECK(store.CountLocations() == 2);
+
+		// Replaced, not added
+		data->utcOffset = 3600;
+		CHECK(store.Append(berlin, 2000, 1800, *data) == B_OK);
+		CHECK(store.CountLocations() == 2);
+
+		CHECK(store.Lock());
+		const forecast_record* record = store.Lookup(berlin);
+		CHECK(record != NULL);
+		if (record != NULL) {
+			CHECK(record->fetchTime == 2000);
+			CHECK(record->timeToLive == 1800);
+			CHECK(record->data.utcOffset == 3600);
+			CHECK(record->data.daily.maxTemperature[0] == 21.5f);
+		}
+		CHECK(store.Lookup(berlinFahrenheit) == NULL);
+		store.Unlock();
+
+		CHECK(store.Compact() == B_OK);
+		CHECK(store.CountLocations() == 2);
+	}
+
+	// A second store sees what the first one wrote
+	{
+		ForecastStore store(path.c_str());
+		CHECK(store.InitCheck() == B_OK);
+		CHECK(store.Lock());
+		const forecast_record* record = store.Lookup(sydney);
+		CHECK(record != NULL && record->fetchTime == 1100
+			&& record->data.utcOffset == 36000);
+		record = store.Lookup(berlin);
+		CHECK(record != NULL && record->fetchTime == 2000);
+		store.Unlock();
+	}
+
+	// Many locations make the index grow
+	{
+		ForecastStore store(path.c_str());
+		for (int32 i = 0; i < 300; i++) {
+			CHECK(store.Append(ForecastLocationId(i / 10.0, -i / 10.0, 0),
+				i, 3600, *data) == B_OK);
+		}
+		CHECK(store.CountLocations() == 302);
+		CHECK(store.Lock());
+		const forecast_record* record
+			= store.Lookup(ForecastLocationId(12.3, -12.3, 0));
+		CHECK(record != NULL && record->fetchTime == 123);
+		store.Unlock();
+	}
+
+	delete data;
+	unlink(path.c_str());
+}
+
+
+static void
+test_scheduler()
+{
+	// 2026-04-17 18:00 UTC, a full hour
+	const int64 kHour = 60 * 60;
+	const int64 kNow = 1776448800;
+
+	RefreshScheduler scheduler(3 * kHour);
+	scheduler.Succeeded(kNow);
+
+	// The last publication within the interval, a quarter past, plus up to
+	// five minutes of jitter
+	int64 next = scheduler.NextRefresh();
+	CHECK(next >= kNow + 2 * kHour + 15 * 60);
+	CHECK(next <= kNow + 2 * kHour + 20 * 60);
+	CHECK(!scheduler.IsDue(kNow));
+	CHECK(scheduler.IsDue(next));
+	CHECK(scheduler.Delay(next - 10) == 10000000);
+	CHECK(scheduler.Delay(next + 10) == 0);
+	CHECK(!scheduler.ShouldRefreshOnShow(kNow + 10 * 60));
+	// Published since, and old enough
+	CHECK(scheduler.ShouldRefreshOnShow(kNow + kHour + 20 * 60));
+
+	// Too short for a publication within it, the next one is taken
+	RefreshScheduler shortInterval(60);
+	CHECK(shortInterval.Interval() == 60);
+	shortInterval.Succeeded(kNow);
+	CHECK(shortInterval.NextRefresh() >= kNow + 15 * 60);
+	CHECK(shortInterval.NextRefresh() <= kNow + 15 * 60 + 15);
+
+	// Shorter intervals than a minute aren't taken
+	RefreshScheduler tooShort(1);
+	CHECK(tooShort.Interval() == 60);
+
+	// The backoff doubles and is capped
+	scheduler.Succeeded(kNow);
+	for (int32 failure = 0; failure < 10; failure++) {
+		scheduler.Failed(kNow);
+		int64 backoff = 30 << failure;
+		if (backoff > 30 * 60)
+			backoff = 30 * 60;
+		int64 wait = scheduler.NextRefresh() - kNow;
+		CHECK(wait >= backoff / 2 && wait <= backoff);
+	}
+	CHECK(!scheduler.ShouldRefreshOnShow(kNow + 1));
+
+	// The server asked to wait longer than the backoff
+	scheduler.Succeeded(kNow);
+	scheduler.Failed(kNow, 600);
+	CHECK(scheduler.NextRefresh() >= kNow + 600);
+	CHECK(scheduler.NextRefresh() <= kNow + 630);
+
+	// A shorter wait doesn't cut the backoff
+	for (int32 failure = 0; failure < 6; failure++)
+		scheduler.Failed(kNow);
+	scheduler.Failed(kNow, 5);
+	CHECK(scheduler.NextRefresh() >= kNow + 15 * 60);
+
+	// A success ends the backoff
+	scheduler.Succeeded(kNow);
+	CHECK(scheduler.NextRefresh() >= kNow + 2 * kHour + 15 * 60);
+
+	// A new interval reschedules
+	scheduler.SetInterval(kHour);
+	CHECK(scheduler.Interval() == kHour);
+	CHECK(scheduler.NextRefresh() >= kNow + 15 * 60);
+	CHECK(scheduler.NextRefresh() <= kNow + 20 * 60);
+}
+
+
+// The hourly kernels without their lanes, to compare them with
+static void
+aggregate_simply(const float* values, int32 count, hourly_aggregate& aggregate)
+{
+	aggregate.minimum = NAN;
+	aggregate.maximum = NAN;
+	aggregate.sum = 0;
+	aggregate.count = 0;
+	for (int32 i = 0; i < count; i++) {
+		if (isnan(values[i]))
+			continue;
+		if (aggregate.count == 0 || values[i] < aggregate.minimum)
+			aggregate.minimum = values[i];
+		if (aggregate.count == 0 || values[i] > aggregate.maximum)
+			aggregate.maximum = values[i];
+		aggregate.sum += values[i];
+		aggregate.count++;
+	}
+}
+
+
+static bool
+same(float value, float expected)
+{
+	return value == expected || (isnan(value) && isnan(expected));
+}
+
+
+static void
+test_hourly_kernels()
+{
+	// Quarters add up exactly in any order, whatever lane they fall in
+	float values[kMaxForecastHours];
+	for (int32 i = 0; i < kMaxForecastHours; i++)
+		values[i] = ((i * 37) % 41 - 20) * 0.25f;
+	// Missing values in the lanes and in the tail
+	for (int32 i = 3; i < kMaxForecastHours; i += 11)
+		values[i] = NAN;
+
+	static const int32 kCounts[] = {0, 1, 3, 7, 8, 9, 15, 16, 17, 23, 25,
+		31, 33, 47, kMaxForecastHours - 1, kMaxForecastHours};
+	for (size_t i = 0; i < sizeof(kCounts) / sizeof(kCounts[0]); i++) {
+		int32 count = kCounts[i];
+		hourly_aggregate expected;
+		aggregate_simply(values, count, expected);
+
+		CHECK(same(HourlyMinimum(values, count), expected.minimum));
+		CHECK(same(HourlyMaximum(values, count), expected.maximum));
+		CHECK(HourlySum(values, count) == expected.sum);
+
+		hourly_aggregate aggregate;
+		AggregateHourly(values, count, aggregate);
+		CHECK(same(aggregate.minimum, expected.minimum));
+		CHECK(same(aggregate.maximum, expected.maximum));
+		CHECK(aggregate.sum == expected.sum);
+		CHECK(aggregate.count == expected.count);
+	}
+
+	// The extremes in the tail, past the last full set of lanes
+	values[20] = -100;
+	values[21] = 100;
+	CHECK(HourlyMinimum(values, 22) == -100);
+	CHECK(HourlyMaximum(values, 22) == 100);
+
+	// Nothing but missing values
+	float missing[13];
+	for (int32 i = 0; i < 13; i++)
+		missing[i] = NAN;
+	hourly_aggregate aggregate;
+	AggregateHourly(missing, 13, aggregate);
+	CHECK(isnan(aggregate.minimum) && isnan(aggregate.maximum));
+	CHECK(aggregate.sum == 0 && aggregate.count == 0);
+	CHECK(isnan(HourlyMinimum(missing, 13)));
+	CHECK(isnan(HourlyMaximum(missing, 13)));
+	CHECK(HourlySum(missing, 13) == 0);
+}
+
+
+static void
+test_derived_weather()
+{
+	// 2026-04-17 07:00 UTC, 08:00 at UTC+1: the first day has 16 hours
+	const int64 kHour = 60 * 60;
+	const int64 kStart = 1776409200;
+	const int32 kOffset = 3600;
+
+	hourly_weather* hourly = new hourly_weather;
+	hourly->count = 48;
+	hourly->startTime = kStart;
+	for (int32 i = 0; i < hourly->count; i++) {
+		hourly->values[HOURLY_TEMPERATURE][i] = i;
+		hourly->values[HOURLY_PRECIPITATION_PROBABILITY][i] = i % 30;
+		hourly->values[HOURLY_PRECIPITATION][i] = 0.5f;
+		hourly->values[HOURLY_WEATHER_CODE][i] = 3;
+		hourly->values[HOURLY_IS_DAY][i] = NAN;
+	}
+	hourly->values[HOURLY_WEATHER_CODE][5] = 95;
+	// The last day has no temperatures at all
+	for (int32 i = 40; i < hourly->count; i++)
+		hourly->values[HOURLY_TEMPERATURE][i] = NAN;
+
+	daily_weather* daily = new daily_weather;
+	DeriveDailyWeather(*hourly, kOffset, *daily);
+	CHECK(daily->count == 3);
+	CHECK(daily->time[0] == kStart - 8 * kHour);
+	CHECK(daily->time[2] == kStart - 8 * kHour + 48 * kHour);
+	CHECK(daily->minTemperature[0] == 0 && daily->maxTemperature[0] == 15);
+	CHECK(daily->minTemperature[1] == 16 && daily->maxTemperature[1] == 39);
+	CHECK(isnan(daily->minTemperature[2]) && isnan(daily->maxTemperature[2]));
+	// The most severe condition of the day
+	CHECK(daily->weatherCode[0] == 95 && daily->weatherCode[1] == 3);
+	CHECK(daily->precipitationSum[0] == 8);
+	CHECK(daily->precipitationSum[1] == 12);
+	CHECK(daily->precipitationSum[2] == 4);
+	CHECK(daily->maxPrecipitationProbability[1] == 29);
+
+	// Halfway between two hours
+	current_weather current = {};
+	CHECK(DeriveCurrentWeather(*hourly, kStart + 2 * kHour + kHour / 2,
+		current));
+	CHECK(current.valid);
+	CHECK(current.time == kStart + 2 * kHour);
+	CHECK(current.temperature == 2.5f);
+	CHECK(current.weatherCode == 3);
+	// Day, unless told otherwise
+	CHECK(current.isDay);
+
+	hourly->values[HOURLY_IS_DAY][5] = 0;
+	CHECK(DeriveCurrentWeather(*hourly, kStart + 5 * kHour, current));
+	CHECK(current.temperature == 5 && current.weatherCode == 95);
+	CHECK(!current.isDay);
+
+	// The hour after is missing, nothing to interpolate with
+	CHECK(DeriveCurrentWeather(*hourly, kStart + 39 * kHour + kHour / 2,
+		current));
+	CHECK(current.temperature == 39);
+
+	// The hour itself is missing
+	CHECK(DeriveCurrentWeather(*hourly, kStart, current));
+	CHECK(!DeriveCurrentWeather(*hourly, kStart + 40 * kHour, current));
+	CHECK(!current.valid);
+
+	// Not one of the hours, the first or the last one isn't taken instead
+	CHECK(DeriveCurrentWeather(*hourly, kStart, current));
+	CHECK(!DeriveCurrentWeather(*hourly, kStart - 1, current));
+	CHECK(!current.valid);
+	hourly->values[HOURLY_TEMPERATURE][47] = 47;
+	CHECK(DeriveCurrentWeather(*hourly, kStart + 48 * kHour - 1, current));
+	CHECK(current.temperature == 47);
+	CHECK(!DeriveCurrentWeather(*hourly, kStart + 48 * kHour, current));
+	CHECK(!current.valid);
+	CHECK(!DeriveCurrentWeather(*hourly, kStart + 30 * 24 * kHour, current));
+
+	hourly->count = 0;
+	CHECK(!DeriveCurrentWeather(*hourly, kStart, current));
+	DeriveDailyWeather(*hourly, kOffset, *daily);
+	CHECK(daily->count == 0);
+
+	delete daily;
+	delete hourly;
+}
+
+
+static void
+test_urls()
+{
+	unsetenv("WEATHER_FORECAST_URL");
+	unsetenv("WEATHER_GEOCODING_URL");
+
+	forecast_location locations[kMaxBatchLocations + 10];
+	for (int32 i = 0; i < kMaxBatchLocations + 10; i++) {
+		locations[i].latitude = 52.52;
+		locations[i].longitude = 13.41;
+	}
+	locations[1].latitude = -33.8688;
+	locations[1].longitude = 151.2093;
+
+	CHECK(ForecastUrl(locations, 2, CELSIUS)
+		== "https://api.open-meteo.com/v1/forecast"
+			"?latitude=52.52,-33.87&longitude=13.41,151.21"
+			"&hourly=temperature_2m,precipitation_probability,precipitation,"
+			"weathercode,is_day&forecast_days=16&timeformat=unixtime"
+			"&timezone=auto&temperature_unit=celsius");
+
+	std::string url = ForecastUrl(locations, 1, FAHRENHEIT);
+	CHECK(url.find("?latitude=52.52&longitude=13.41&") != std::string::npos);
+	CHECK(url.find("&temperature_unit=fahrenheit") != std::string::npos);
+
+	// A larger batch is cut, the rest goes into another request
+	url = ForecastUrl(locations, kMaxBatchLocations + 10, CELSIUS);
+	size_t begin = url.find("latitude=");
+	size_t end = url.find('&', begin);
+	int32 separators = 0;
+	for (size_t i = begin; i < end; i++)
+		separators += url[i] == ',';
+	CHECK(separators == kMaxBatchLocations - 1);
+
+	// Another server, with a trailing slash
+	setenv("WEATHER_FORECAST_URL", "http://127.0.0.1:8080/", 1);
+	CHECK(ForecastUrl(locations, 1, CELSIUS).compare(0, 34,
+		"http://127.0.0.1:8080/v1/forecast?") == 0);
+	unsetenv("WEATHER_FORECAST_URL");
+
+	CHECK(CitySearchUrl("New <York>\"", "DE")
+		== "https://geocoding-api.open-meteo.com/v1/search?name=New+York"
+			"&language=de");
+	CHECK(CitySearchUrl("Z\xc3\xbcrich", NULL)
+		== "https://geocoding-api.open-meteo.com/v1/search?name=Z\xc3\xbcrich");
+	CHECK(CitySearchUrl("Oslo", "").find("language") == std::string::npos);
+
+	setenv("WEATHER_GEOCODING_URL", "http://localhost:8081", 1);
+	CHECK(CitySearchUrl("Oslo", "en")
+		== "http://localhost:8081/v1/search?name=Oslo&language=en");
+	unsetenv("WEATHER_GEOCODING_URL");
+}
+
+
+static void
+test_conditions()
+{
+	for (int32 code = 0; code < kWeatherCodeCount; code++) {
+		const weather_condition& condition = WeatherCondition(code);
+		CHECK(condition.icon < kWeatherIconCount);
+		CHECK(condition.nightIcon < kWeatherIconCount);
+		CHECK(condition.text != NULL
+			&& strcmp(condition.text, "Not available") != 0);
+	}
+
+	const weather_condition& clear = WeatherCondition(0);
+	CHECK(clear.icon == ICON_CLEAR && clear.nightIcon == ICON_CLEAR_NIGHT);
+	CHECK(clear.severity == SEVERITY_NONE);
+	CHECK(strcmp(WeatherCondition(61).text, "Slight rain") == 0);
+	CHECK(WeatherCondition(82).severity == SEVERITY_SEVERE);
+	// A range shares one entry
+	CHECK(strcmp(WeatherCondition(93).text, "Thunderstorm") == 0);
+	CHECK(WeatherCondition(99).icon == ICON_SEVERE_THUNDERSTORM);
+
+	// Out of range, negative ones included
+	const weather_condition& unknown = WeatherCondition(kWeatherCodeCount);
+	CHECK(strcmp(unknown.text, "Not available") == 0);
+	CHECK(&WeatherCondition(-1) == &unknown);
+	CHECK(&WeatherCondition(INT32_MIN) == &unknown);
+	CHECK(&WeatherCondition(12345) == &unknown);
+}
+
+
+static std::string
+fold(const std::string& text)
+{
+	std::string folded(text.size(), '\0');
+	folded.resize(FoldCase(text.data(), text.size(), &folded[0]));
+	return folded;
+}
+
+
+static void
+test_case_fold()
+{
+	static const char* const kCases[][2] = {
+		{"Z\xc3\x9cRICH", "z\xc3\xbcrich"},
+		// Shorter once folded
+		{"\xc4\xb0STANBUL", "istanbul"},
+		{"\xc5\x81\xc3\x93" "D\xc5\xb9", "\xc5\x82\xc3\xb3" "d\xc5\xba"},
+		{"\xce\x91\xce\x98\xce\x89\xce\x9d\xce\x91",
+			"\xce\xb1\xce\xb8\xce\xae\xce\xbd\xce\xb1"},
+		{"\xd0\x81\xd0\x9b\xd0\x9a\xd0\x98 \xd0\x9c\xd0\x9e\xd0\xa1\xd0\x9a"
+			"\xd0\x92\xd0\x90",
+			"\xd1\x91\xd0\xbb\xd0\xba\xd0\xb8 \xd0\xbc\xd0\xbe\xd1\x81\xd0\xba"
+			"\xd0\xb2\xd0\xb0"},
+		{"\xd4\xb5\xd5\x90\xd4\xb5\xd5\x8e\xd4\xb1\xd5\x86",
+			"\xd5\xa5\xd6\x80\xd5\xa5\xd5\xbe\xd5\xa1\xd5\xb6"},
+		// No case, and invalid or cut off UTF-8, are kept
+		{"\xe6\x9d\xb1\xe4\xba\xac", "\xe6\x9d\xb1\xe4\xba\xac"},
+		{"A\xff" "B\xc3", "a\xff" "b\xc3"}
+	};
+
+	for (size_t i = 0; i < sizeof(kCases) / sizeof(kCases[0]); i++) {
+		std::string text(kCases[i][0]);
+		std::string folded = fold(text);
+		CHECK(folded == kCases[i][1]);
+		// Folded keys stay as they are
+		CHECK(fold(folded) == folded);
+
+		// BuildPlaceIndex and PlaceIndex::Search() fold into another buffer,
+		// in place must give the same keys
+		std::string inPlace(text);
+		inPlace.resize(FoldCase(inPlace.data(), inPlace.size(), &inPlace[0]));
+		CHECK(inPlace == folded);
+	}
+
+	// A query that is being typed must lead to the folded key of the place
+	std::string key = fold("Z\xc3\x9cRICH");
+	CHECK(key.compare(0, 3, fold("Z\xc3\x9c")) == 0);
+	CHECK(key.compare(0, 3, fold("z\xc3\xbc")) == 0);
+	CHECK(fold("Zu") != fold("Z\xc3\xbc"));
+}
+
+
+int
+main()
+{
+	test_parser();
+	test_decoder();
+	test_hourly_kernels();
+	test_derived_weather();
+	test_urls();
+	test_conditions();
+	test_case_fold();
+	test_store();
+	test_scheduler();
+
+	printf("%" B_PRId32 " checks, %" B_PRId32 " failed\n", sChecks,
+		sFailures);
+	return sFailures > 0 ? 1 : 0;
+}
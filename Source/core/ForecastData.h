@@ -0,0 +1,83 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _FORECASTDATA_H_
+#define _FORECASTDATA_H_
+
+
+#include "CoreDefs.h"
+
+
+// Open-Meteo serves at most 16 days of forecast
+const int32 kMaxForecastDays = 16;
+const int32 kHoursPerDay = 24;
+const int32 kMaxForecastHours = kMaxForecastDays * kHoursPerDay;
+const int32 kMaxCityResults = 100;
+const size_t kMaxPlaceNameLength = 128;
+
+
+struct current_weather {
+	bool			valid;
+	bool			isDay;
+	int32			weatherCode;
+	int64			time;
+	float			temperature;
+};
+
+
+// Daily values are stored column-wise, entry i of every array belongs to
+// the same day.
+struct daily_weather {
+	int32			count;
+	int64			time[kMaxForecastDays];
+	int32			weatherCode[kMaxForecastDays];
+	float			maxTemperature[kMaxForecastDays];
+	float			minTemperature[kMaxForecastDays];
+	float			precipitationSum[kMaxForecastDays];
+	float			maxPrecipitationProbability[kMaxForecastDays];
+};
+
+
+enum hourly_variable {
+	HOURLY_TEMPERATURE = 0,
+	HOURLY_PRECIPITATION_PROBABILITY,
+	HOURLY_PRECIPITATION,
+	HOURLY_WEATHER_CODE,
+	HOURLY_IS_DAY,
+
+	kHourlyVariableCount
+};
+
+
+// One contiguous column per variable, hour i is startTime + i hours.
+// Missing values are NaN.
+struct hourly_weather {
+	int32			count;
+	int64			startTime;
+	float			values[kHourlyVariableCount][kMaxForecastHours];
+};
+
+
+struct forecast_data {
+	int32			utcOffset;
+	current_weather	current;
+	daily_weather	daily;
+	hourly_weather	hourly;
+};
+
+
+struct city_result {
+	int32			id;
+	int32			countryId;
+	double			latitude;
+	double			longitude;
+	char			name[kMaxPlaceNameLength];
+	char			country[kMaxPlaceNameLength];
+	char			admin1[kMaxPlaceNameLength];
+	char			admin2[kMaxPlaceNameLength];
+	char			admin3[kMaxPlaceNameLength];
+};
+
+
+#endif // _FORECASTDATA_H_
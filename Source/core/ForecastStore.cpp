@@ -0,0 +1,679 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifdef __HAIKU__
+#include <Directory.h>
+#include <FindDirectory.h>
+#include <Path.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <new>
+
+#include "ForecastStore.h"
+
+
+static const uint32 kStoreMagic = 'WFcS';
+static const uint32 kStoreVersion = 2;
+static const uint32 kInitialCapacity = 256;
+	// index slots, always a power of two
+static const uint32 kMinDeadRecords = 32;
+static const uint32 kReplacedFlag = 0x01;
+static const int32 kMaxReadSpins = 1000;
+
+
+struct forecast_store_header {
+	uint32			magic;
+	uint32			version;
+	uint32			recordSize;
+	uint32			capacity;
+	uint32			locations;
+	uint32			deadRecords;
+	uint32			flags;
+	uint32			sequence;
+		// odd while a writer changes the index or the header
+};
+
+
+struct forecast_store_slot {
+	int64			locationId;
+	uint64			offset;
+};
+
+
+// Holds the store lock for a scope, like a BAutolock
+class StoreLocker {
+public:
+	StoreLocker(ForecastStore& store)
+		:
+		fStore(store)
+	{
+		fStore.Lock();
+	}
+
+	~StoreLocker()
+	{
+		fStore.Unlock();
+	}
+
+private:
+	ForecastStore&	fStore;
+};
+
+
+static ForecastStore* sDefaultStore = NULL;
+static pthread_once_t sDefaultStoreOnce = PTHREAD_ONCE_INIT;
+
+
+static uint64
+data_offset(uint32 capacity)
+{
+	return sizeof(forecast_store_header)
+		+ (uint64) capacity * sizeof(forecast_store_slot);
+}
+
+
+// Returns the slot holding the location, or the free slot where it belongs,
+// or -1 when the index is full
+static int32
+find_slot(const forecast_store_slot* slots, uint32 capacity, int64 locationId)
+{
+	uint32 mask = capacity - 1;
+	uint32 index = (uint32) (((uint64) locationId * 0x9e3779b97f4a7c15ULL) >> 32)
+		& mask;
+
+	for (uint32 i = 0; i < capacity; i++) {
+		int64 slotId = slots[index].locationId;
+		if (slotId == locationId || slotId == 0)
+			return index;
+		index = (index + 1) & mask;
+	}
+	return -1;
+}
+
+
+static void
+create_default_store()
+{
+#ifdef __HAIKU__
+	BPath path;
+	if (find_directory(B_USER_CACHE_DIRECTORY, &path, true) != B_OK
+		|| path.Append("Weather") != B_OK
+		|| create_directory(path.Path(), 0755) != B_OK
+		|| path.Append("Forecasts") != B_OK)
+		return;
+
+	sDefaultStore = new(std::nothrow) ForecastStore(path.Path());
+#else
+	// The XDG cache directory
+	std::string path;
+	const char* cache = getenv("XDG_CACHE_HOME");
+	const char* home = getenv("HOME");
+	if (cache != NULL && cache[0] == '/')
+		path = cache;
+	else if (home != NULL)
+		path = std::string(home) + "/.cache";
+	else
+		return;
+
+	path += "/Weather";
+	if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST)
+		return;
+
+	sDefaultStore = new(std::nothrow) ForecastStore(
+		(path + "/Forecasts").c_str());
+#endif
+}
+
+
+int64
+ForecastLocationId(double latitude, double longitude, int32 unit)
+{
+	int64 quantizedLatitude = lround(latitude * 100) + 9000;
+	int64 quantizedLongitude = lround(longitude * 100) + 18000;
+	return ((quantizedLatitude << 32) | (quantizedLongitude << 8)
+		| (unit & 0xff)) + 1;
+}
+
+
+ForecastStore::ForecastStore(const char* path)
+	:
+	fPath(path),
+	fFD(-1),
+	fMapping(NULL),
+	fMappedSize(0),
+	fStatus(B_NO_INIT)
+{
+	// Recursive like a BLocker
+	pthread_mutexattr_t attributes;
+	pthread_mutexattr_init(&attributes);
+	pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&fLock, &attributes);
+	pthread_mutexattr_destroy(&attributes);
+
+	fStatus = _Open();
+}
+
+
+ForecastStore::~ForecastStore()
+{
+	_Close();
+	pthread_mutex_destroy(&fLock);
+}
+
+
+status_t
+ForecastStore::InitCheck() const
+{
+	return fStatus;
+}
+
+
+/*static*/ ForecastStore*
+ForecastStore::Default()
+{
+	pthread_once(&sDefaultStoreOnce, &create_default_store);
+	return sDefaultStore;
+}
+
+
+bool
+ForecastStore::Lock()
+{
+	return pthread_mutex_lock(&fLock) == 0;
+}
+
+
+void
+ForecastStore::Unlock()
+{
+	pthread_mutex_unlock(&fLock);
+}
+
+
+const forecast_record*
+ForecastStore::Lookup(int64 locationId)
+{
+	if (_Validate() != B_OK)
+		return NULL;
+
+	const forecast_store_header* header = _Header();
+	int32 index = find_slot(_Slots(), header->capacity, locationId);
+	if (index < 0)
+		return NULL;
+
+	// A new slot gets its offset before its id, so a matching id always
+	// comes with a complete record
+	const forecast_store_slot& slot = _Slots()[index];
+	if (slot.locationId != locationId
+		|| slot.offset < data_offset(header->capacity))
+		return NULL;
+
+	uint64 offset = slot.offset;
+	if (offset + sizeof(forecast_record) > fMappedSize) {
+		// Appended since we mapped the file
+		if (_Map() != B_OK || offset + sizeof(forecast_record) > fMappedSize)
+			return NULL;
+	}
+
+	const forecast_record* record
+		= reinterpret_cast<const forecast_record*>(fMapping + offset);
+	if (record->locationId != locationId)
+		return NULL;
+
+	return record;
+}
+
+
+uint32
+ForecastStore::Sequence()
+{
+	StoreLocker locker(*this);
+	if (_Validate() != B_OK)
+		return 0;
+
+	return __atomic_load_n(&_Header()->sequence, __ATOMIC_ACQUIRE);
+}
+
+
+uint32
+ForecastStore::BeginRead()
+{
+	if (_Validate() != B_OK)
+		return 0;
+
+	// A writer only has a few writes to do, and one that died halfway
+	// must not block the readers forever
+	uint32 sequence = 0;
+	for (int32 i = 0; i < kMaxReadSpins; i++) {
+		sequence = __atomic_load_n(&_Header()->sequence, __ATOMIC_ACQUIRE);
+		if ((sequence & 1) == 0)
+			break;
+		snooze(50);
+	}
+	return sequence;
+}
+
+
+bool
+ForecastStore::EndRead(uint32 sequence)
+{
+	if (fMapping == NULL)
+		return false;
+
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	const forecast_store_header* header = _Header();
+	return (sequence & 1) == 0
+		&& __atomic_load_n(&header->sequence, __ATOMIC_RELAXED) == sequence
+		&& (header->flags & kReplacedFlag) == 0;
+}
+
+
+int32
+ForecastStore::CountLocations()
+{
+	StoreLocker locker(*this);
+	if (_Validate() != B_OK)
+		return 0;
+
+	return _Header()->locations;
+}
+
+
+status_t
+ForecastStore::Append(int64 locationId, int64 fetchTime, int32 timeToLive,
+	const forecast_data& data)
+{
+	forecast_record* record = new(std::nothrow) forecast_record;
+	if (record == NULL)
+		return B_NO_MEMORY;
+
+	memset(record, 0, offsetof(forecast_record, data));
+	record->locationId = locationId;
+	record->fetchTime = fetchTime;
+	record->timeToLive = timeToLive;
+	record->data = data;
+
+	StoreLocker locker(*this);
+	status_t status = _Validate();
+	if (status == B_OK)
+		status = _LockFile();
+	if (status != B_OK) {
+		delete record;
+		return status;
+	}
+
+	const forecast_store_header* header = _Header();
+	int32 index = find_slot(_Slots(), header->capacity, locationId);
+	if (index < 0 || (_Slots()[index].locationId == 0
+			&& (header->locations + 1) * 4 > header->capacity * 3)) {
+		// Keep the index at most 3/4 full, a fuller one still works as
+		// long as there is a free slot
+		status_t compactStatus = _Compact(header->capacity * 2);
+		if (fMapping == NULL)
+			status = fStatus;
+		else if (compactStatus == B_OK) {
+			header = _Header();
+			index = find_slot(_Slots(), header->capacity, locationId);
+		} else if (index < 0)
+			status = compactStatus;
+	}
+	if (status == B_OK && index < 0)
+		status = B_DEVICE_FULL;
+
+	// The record goes to the end of the file and is only then published
+	// in the index
+	uint64 offset = 0;
+	struct stat stat;
+	if (status == B_OK) {
+		if (fstat(fFD, &stat) == 0)
+			offset = stat.st_size;
+		else
+			status = B_FROM_POSIX_ERROR(errno);
+	}
+	if (status == B_OK && pwrite(fFD, record, sizeof(forecast_record), offset)
+			!= (ssize_t) sizeof(forecast_record))
+		status = B_IO_ERROR;
+	delete record;
+
+	if (status == B_OK) {
+		off_t slotOffset = sizeof(forecast_store_header)
+			+ index * sizeof(forecast_store_slot);
+		bool isNew = _Slots()[index].locationId == 0;
+
+		forecast_store_header updated = *header;
+		if (isNew)
+			updated.locations++;
+		else
+			updated.deadRecords++;
+		// Odd for the writes. A writer that died halfway left it odd
+		// already, which must not turn the parity around.
+		updated.sequence = header->sequence | 1;
+
+		if (_WriteSequence(updated.sequence) != B_OK
+			|| pwrite(fFD, &offset, sizeof(offset),
+				slotOffset + offsetof(forecast_store_slot, offset))
+					!= (ssize_t) sizeof(offset)
+			|| (isNew && pwrite(fFD, &locationId, sizeof(locationId),
+				slotOffset) != (ssize_t) sizeof(locationId))
+			|| pwrite(fFD, &updated, sizeof(updated), 0)
+				!= (ssize_t) sizeof(updated))
+			status = B_IO_ERROR;
+
+		// Even again, also when a write failed: what has been written is
+		// as consistent as it gets
+		updated.sequence++;
+		if (_WriteSequence(updated.sequence) != B_OK)
+			status = B_IO_ERROR;
+
+		if (status == B_OK && updated.deadRecords >= kMinDeadRecords
+			&& updated.deadRecords > updated.locations)
+			_Compact(updated.capacity);
+	}
+
+	_UnlockFile();
+	return status;
+}
+
+
+status_t
+ForecastStore::Compact()
+{
+	StoreLocker locker(*this);
+	status_t status = _Validate();
+	if (status == B_OK)
+		status = _LockFile();
+	if (status != B_OK)
+		return status;
+
+	status = _Compact(_Header()->capacity);
+
+	_UnlockFile();
+	return status;
+}
+
+
+status_t
+ForecastStore::_Open()
+{
+	// Another team may replace the file between our open() and flock(),
+	// in which case we have to open the new one
+	for (int32 attempt = 0; attempt < 3; attempt++) {
+		fFD = open(fPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+		if (fFD < 0)
+			return B_FROM_POSIX_ERROR(errno);
+
+		if (flock(fFD, LOCK_EX) != 0) {
+			status_t status = B_FROM_POSIX_ERROR(errno);
+			_Close();
+			return status;
+		}
+
+		struct stat stat;
+		forecast_store_header header;
+		bool valid = fstat(fFD, &stat) == 0
+			&& stat.st_size >= (off_t) sizeof(header)
+			&& pread(fFD, &header, sizeof(header), 0)
+				== (ssize_t) sizeof(header)
+			&& header.magic == kStoreMagic
+			&& header.version == kStoreVersion
+			&& header.recordSize == sizeof(forecast_record)
+			&& header.capacity != 0
+			&& (header.capacity & (header.capacity - 1)) == 0
+			&& (uint64) stat.st_size >= data_offset(header.capacity);
+
+		if (valid && (header.flags & kReplacedFlag) != 0) {
+			_Close();
+			continue;
+		}
+
+		// Unknown or damaged files are started over, it's only a cache
+		status_t status = B_OK;
+		if (!valid)
+			status = _Initialize(fFD, kInitialCapacity);
+
+		flock(fFD, LOCK_UN);
+
+		if (status == B_OK)
+			status = _Map();
+		if (status != B_OK)
+			_Close();
+		return status;
+	}
+
+	return B_BUSY;
+}
+
+
+void
+ForecastStore::_Close()
+{
+	if (fMapping != NULL)
+		munmap(fMapping, fMappedSize);
+	fMapping = NULL;
+	fMappedSize = 0;
+
+	if (fFD >= 0)
+		close(fFD);
+	fFD = -1;
+}
+
+
+status_t
+ForecastStore::_Map()
+{
+	struct stat stat;
+	if (fstat(fFD, &stat) != 0)
+		return B_FROM_POSIX_ERROR(errno);
+
+	if (fMapping != NULL)
+		munmap(fMapping, fMappedSize);
+	fMappedSize = 0;
+
+	void* mapping = mmap(NULL, stat.st_size, PROT_READ, MAP_SHARED, fFD, 0);
+	if (mapping == MAP_FAILED) {
+		fMapping = NULL;
+		return B_FROM_POSIX_ERROR(errno);
+	}
+
+	fMapping = static_cast<uint8*>(mapping);
+	fMappedSize = stat.st_size;
+	return B_OK;
+}
+
+
+status_t
+ForecastStore::_Validate()
+{
+	if (fFD < 0)
+		fStatus = _Open();
+	else if ((_Header()->flags & kReplacedFlag) != 0) {
+		// Compacted by another team
+		_Close();
+		fStatus = _Open();
+	}
+
+	return fStatus;
+}
+
+
+status_t
+ForecastStore::_Initialize(int fd, uint32 capacity)
+{
+	if (ftruncate(fd, 0) != 0 || ftruncate(fd, data_offset(capacity)) != 0)
+		return B_FROM_POSIX_ERROR(errno);
+
+	forecast_store_header header;
+	memset(&header, 0, sizeof(header));
+	header.magic = kStoreMagic;
+	header.version = kStoreVersion;
+	header.recordSize = sizeof(forecast_record);
+	header.capacity = capacity;
+
+	if (pwrite(fd, &header, sizeof(header), 0) != (ssize_t) sizeof(header))
+		return B_IO_ERROR;
+
+	return B_OK;
+}
+
+
+status_t
+ForecastStore::_LockFile()
+{
+	for (;;) {
+		if (flock(fFD, LOCK_EX) != 0)
+			return B_FROM_POSIX_ERROR(errno);
+		if ((_Header()->flags & kReplacedFlag) == 0)
+			return B_OK;
+
+		// Compacted while we were waiting for the lock
+		flock(fFD, LOCK_UN);
+		_Close();
+		fStatus = _Open();
+		if (fStatus != B_OK)
+			return fStatus;
+	}
+}
+
+
+void
+ForecastStore::_UnlockFile()
+{
+	flock(fFD, LOCK_UN);
+}
+
+
+status_t
+ForecastStore::_WriteSequence(uint32 sequence)
+{
+	if (pwrite(fFD, &sequence, sizeof(sequence),
+			offsetof(forecast_store_header, sequence))
+				!= (ssize_t) sizeof(sequence))
+		return B_IO_ERROR;
+
+	return B_OK;
+}
+
+
+status_t
+ForecastStore::_Compact(uint32 capacity)
+{
+	// Needs all records in the mapping
+	status_t status = _Map();
+	if (status != B_OK)
+		return status;
+
+	std::string temporaryPath = fPath + ".tmp";
+
+	int fd = open(temporaryPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+		0644);
+	if (fd < 0)
+		return B_FROM_POSIX_ERROR(errno);
+
+	// Nobody else knows the new file yet, so this lock is ours right away
+	// and still held once the file is in place
+	flock(fd, LOCK_EX);
+
+	forecast_store_slot* slots = new(std::nothrow) forecast_store_slot[capacity];
+	if (slots == NULL)
+		status = B_NO_MEMORY;
+	else {
+		memset(slots, 0, capacity * sizeof(forecast_store_slot));
+		status = _Initialize(fd, capacity);
+	}
+
+	const forecast_store_header* header = _Header();
+	const forecast_store_slot* oldSlots = _Slots();
+	uint64 offset = data_offset(capacity);
+	uint32 locations = 0;
+
+	for (uint32 i = 0; status == B_OK && i < header->capacity; i++) {
+		const forecast_store_slot& slot = oldSlots[i];
+		if (slot.locationId == 0
+			|| slot.offset + sizeof(forecast_record) > fMappedSize)
+			continue;
+
+		int32 index = find_slot(slots, capacity, slot.locationId);
+		if (index < 0) {
+			status = B_DEVICE_FULL;
+			break;
+		}
+
+		if (pwrite(fd, fMapping + slot.offset, sizeof(forecast_record), offset)
+				!= (ssize_t) sizeof(forecast_record)) {
+			status = B_IO_ERROR;
+			break;
+		}
+
+		slots[index].locationId = slot.locationId;
+		slots[index].offset = offset;
+		offset += sizeof(forecast_record);
+		locations++;
+	}
+
+	if (status == B_OK) {
+		forecast_store_header compacted = *header;
+		compacted.capacity = capacity;
+		compacted.locations = locations;
+		compacted.deadRecords = 0;
+		compacted.flags = 0;
+		// Differs from the sequence a reader of the old file started with
+		compacted.sequence = (header->sequence | 1) + 1;
+
+		ssize_t slotsSize = capacity * sizeof(forecast_store_slot);
+		if (pwrite(fd, slots, slotsSize, sizeof(forecast_store_header))
+				!= slotsSize
+			|| pwrite(fd, &compacted, sizeof(compacted), 0)
+				!= (ssize_t) sizeof(compacted))
+			status = B_IO_ERROR;
+	}
+	delete[] slots;
+
+	if (status == B_OK && rename(temporaryPath.c_str(), fPath.c_str()) != 0)
+		status = B_FROM_POSIX_ERROR(errno);
+
+	if (status != B_OK) {
+		close(fd);
+		unlink(temporaryPath.c_str());
+		return status;
+	}
+
+	// Send the readers of the old file over to the new one
+	forecast_store_header replaced = *header;
+	replaced.flags |= kReplacedFlag;
+	replaced.sequence = (header->sequence | 1) + 1;
+	pwrite(fFD, &replaced, sizeof(replaced), 0);
+
+	_Close();
+	fFD = fd;
+	fStatus = _Map();
+	return fStatus;
+}
+
+
+const forecast_store_header*
+ForecastStore::_Header() const
+{
+	return reinterpret_cast<const forecast_store_header*>(fMapping);
+}
+
+
+const forecast_store_slot*
+ForecastStore::_Slots() const
+{
+	return reinterpret_cast<const forecast_store_slot*>(
+		fMapping + sizeof(forecast_store_header));
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _FORECASTSTORE_H_
+#define _FORECASTSTORE_H_
+
+
+#include <pthread.h>
+
+#include <string>
+
+#include "ForecastData.h"
+
+
+struct forecast_store_header;
+struct forecast_store_slot;
+
+
+// One forecast as it is laid out in the store file
+struct forecast_record {
+	int64			locationId;
+	int64			fetchTime;
+	int32			timeToLive;
+	int32			reserved;
+	forecast_data	data;
+};
+
+
+// Identifies a location by its coordinates quantized to 1/100 of a degree
+// (about 1 km, finer than the forecast model grid) and the unit.
+// Never 0, which marks a free index slot.
+int64				ForecastLocationId(double latitude, double longitude,
+						int32 unit);
+
+
+// Memory-mapped file holding the latest forecast of any number of
+// locations, shared by every team that shows the weather.
+//
+// The file starts with a header and an open addressing hash index of
+// location id to record offset, followed by the fixed size records.
+// Records are never modified: a new forecast is appended and the index
+// slot is switched to it afterwards, so readers look records up straight
+// in the mapping without parsing, copying or locking the file. Writers
+// serialize on a file lock. Once superseded records outnumber the live
+// ones, the file is rewritten without them into a new file that replaces
+// the old one; readers notice and map the new file.
+//
+// The header holds a sequence number that writers make odd before they
+// change the index and even again afterwards, which makes it a seqlock:
+// a reader that saw the same even number before and after a lookup got
+// a consistent record, without ever taking the file lock or asking
+// another team. Views poll Sequence() to find out cheaply whether there
+// is anything new in the store.
+class ForecastStore
+{
+public:
+						ForecastStore(const char* path);
+						~ForecastStore();
+
+			status_t	InitCheck() const;
+			const char*	Path() const { return fPath.c_str(); }
+
+	static	ForecastStore* Default();
+
+			bool		Lock();
+			void		Unlock();
+
+			// The store must be locked while the returned record is used,
+			// it points into the mapping
+			const forecast_record* Lookup(int64 locationId);
+			int32		CountLocations();
+
+			// Changes whenever a forecast is added or the file is replaced
+			uint32		Sequence();
+
+			// Everything read from the mapping between these two is
+			// consistent if EndRead() returns true, otherwise it has to
+			// be done again. A single Lookup() doesn't need them, its
+			// record never changes; reads of several records or of the
+			// index do. The store must be locked around both.
+			uint32		BeginRead();
+			bool		EndRead(uint32 sequence);
+
+			status_t	Append(int64 locationId, int64 fetchTime,
+							int32 timeToLive, const forecast_data& data);
+			status_t	Compact();
+
+private:
+			status_t	_Open();
+			void		_Close();
+			status_t	_Map();
+			status_t	_Validate();
+			status_t	_Initialize(int fd, uint32 capacity);
+			status_t	_LockFile();
+			void		_UnlockFile();
+			status_t	_WriteSequence(uint32 sequence);
+			status_t	_Compact(uint32 capacity);
+
+			const forecast_store_header* _Header() const;
+			const forecast_store_slot* _Slots() const;
+
+			pthread_mutex_t fLock;
+			std::string	fPath;
+			int			fFD;
+			uint8*		fMapping;
+			size_t		fMappedSize;
+			status_t	fStatus;
+};
+
+
+#endif // _FORECASTSTORE_H_
@@ -0,0 +1,278 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#include <math.h>
+
+#include "HourlyForecast.h"
+
+
+static const int32 kLanes = 8;
+static const int64 kSecondsPerHour = 60 * 60;
+static const int64 kSecondsPerDay = kHoursPerDay * kSecondsPerHour;
+
+
+float
+HourlyMinimum(const float* values, int32 count)
+{
+	float lanes[kLanes];
+	for (int32 lane = 0; lane < kLanes; lane++)
+		lanes[lane] = HUGE_VALF;
+
+	int32 i = 0;
+	for (; i + kLanes <= count; i += kLanes) {
+		for (int32 lane = 0; lane < kLanes; lane++) {
+			float value = values[i + lane];
+			// false for NaN, which keeps the accumulator
+			lanes[lane] = value < lanes[lane] ? value : lanes[lane];
+		}
+	}
+	for (; i < count; i++)
+		lanes[0] = values[i] < lanes[0] ? values[i] : lanes[0];
+
+	float minimum = lanes[0];
+	for (int32 lane = 1; lane < kLanes; lane++)
+		minimum = lanes[lane] < minimum ? lanes[lane] : minimum;
+
+	return minimum == HUGE_VALF ? NAN : minimum;
+}
+
+
+float
+HourlyMaximum(const float* values, int32 count)
+{
+	float lanes[kLanes];
+	for (int32 lane = 0; lane < kLanes; lane++)
+		lanes[lane] = -HUGE_VALF;
+
+	int32 i = 0;
+	for (; i + kLanes <= count; i += kLanes) {
+		for (int32 lane = 0; lane < kLanes; lane++) {
+			float value = values[i + lane];
+			lanes[lane] = value > lanes[lane] ? value : lanes[lane];
+		}
+	}
+	for (; i < count; i++)
+		lanes[0] = values[i] > lanes[0] ? values[i] : lanes[0];
+
+	float maximum = lanes[0];
+	for (int32 lane = 1; lane < kLanes; lane++)
+		maximum = lanes[lane] > maximum ? lanes[lane] : maximum;
+
+	return maximum == -HUGE_VALF ? NAN : maximum;
+}
+
+
+float
+HourlySum(const float* values, int32 count)
+{
+	float lanes[kLanes];
+	for (int32 lane = 0; lane < kLanes; lane++)
+		lanes[lane] = 0;
+
+	int32 i = 0;
+	for (; i + kLanes <= count; i += kLanes) {
+		for (int32 lane = 0; lane < kLanes; lane++) {
+			float value = values[i + lane];
+			// NaN != NaN
+			lanes[lane] += value == value ? value : 0;
+		}
+	}
+	for (; i < count; i++)
+		lanes[0] += values[i] == values[i] ? values[i] : 0;
+
+	float sum = 0;
+	for (int32 lane = 0; lane < kLanes; lane++)
+		sum += lanes[lane];
+	return sum;
+}
+
+
+void
+AggregateHourly(const float* values, int32 count, hourly_aggregate& aggregate)
+{
+	float minimum[kLanes];
+	float maximum[kLanes];
+	float sum[kLanes];
+	int32 valid[kLanes];
+	for (int32 lane = 0; lane < kLanes; lane++) {
+		minimum[lane] = HUGE_VALF;
+		maximum[lane] = -HUGE_VALF;
+		sum[lane] = 0;
+		valid[lane] = 0;
+	}
+
+	int32 i = 0;
+	for (; i + kLanes <= count; i += kLanes) {
+		for (int32 lane = 0; lane < kLanes; lane++) {
+			float value = values[i + lane];
+			bool isValid = value == value;
+			minimum[lane] = value < minimum[lane] ? value : minimum[lane];
+			maximum[lane] = value > maximum[lane] ? value : maximum[lane];
+			sum[lane] += isValid ? value : 0;
+			valid[lane] += isValid;
+		}
+	}
+	for (; i < count; i++) {
+		float value = values[i];
+		bool isValid = value == value;
+		minimum[0] = value < minimum[0] ? value : minimum[0];
+		maximum[0] = value > maximum[0] ? value : maximum[0];
+		sum[0] += isValid ? value : 0;
+		valid[0] += isValid;
+	}
+
+	aggregate.minimum = HUGE_VALF;
+	aggregate.maximum = -HUGE_VALF;
+	aggregate.sum = 0;
+	aggregate.count = 0;
+	for (int32 lane = 0; lane < kLanes; lane++) {
+		if (minimum[lane] < aggregate.minimum)
+			aggregate.minimum = minimum[lane];
+		if (maximum[lane] > aggregate.maximum)
+			aggregate.maximum = maximum[lane];
+		aggregate.sum += sum[lane];
+		aggregate.count += valid[lane];
+	}
+
+	if (aggregate.count == 0) {
+		aggregate.minimum = NAN;
+		aggregate.maximum = NAN;
+	}
+}
+
+
+void
+AggregateWindow(const hourly_weather& hourly, hourly_variable variable,
+	int32 begin, int32 end, hourly_aggregate& aggregate)
+{
+	if (begin < 0)
+		begin = 0;
+	if (end > hourly.count)
+		end = hourly.count;
+	if (end < begin)
+		end = begin;
+
+	AggregateHourly(hourly.values[variable] + begin, end - begin, aggregate);
+}
+
+
+static int32
+_FirstLocalHour(const hourly_weather& hourly, int32 utcOffset)
+{
+	int64 seconds = (hourly.startTime + utcOffset) % kSecondsPerDay;
+	if (seconds < 0)
+		seconds += kSecondsPerDay;
+	return seconds / kSecondsPerHour;
+}
+
+
+int32
+AggregateDays(const hourly_weather& hourly, hourly_variable variable,
+	int32 utcOffset, hourly_aggregate* days, int32 maxDays)
+{
+	if (hourly.count <= 0)
+		return 0;
+
+	// The first day may start in the middle of it
+	int32 firstHour = _FirstLocalHour(hourly, utcOffset);
+	int32 count = (hourly.count + firstHour + kHoursPerDay - 1) / kHoursPerDay;
+	if (count > maxDays)
+		count = maxDays;
+
+	for (int32 day = 0; day < count; day++) {
+		int32 begin = day * kHoursPerDay - firstHour;
+		AggregateWindow(hourly, variable, begin, begin + kHoursPerDay,
+			days[day]);
+	}
+	return count;
+}
+
+
+int32
+HourIndex(const hourly_weather& hourly, int64 time)
+{
+	if (hourly.count <= 0)
+		return -1;
+
+	int64 index = (time - hourly.startTime) / kSecondsPerHour;
+	if (time < hourly.startTime)
+		index = 0;
+	if (index >= hourly.count)
+		index = hourly.count - 1;
+	return index;
+}
+
+
+void
+DeriveDailyWeather(const hourly_weather& hourly, int32 utcOffset,
+	daily_weather& daily)
+{
+	hourly_aggregate temperature[kMaxForecastDays];
+	hourly_aggregate code[kMaxForecastDays];
+	hourly_aggregate precipitation[kMaxForecastDays];
+	hourly_aggregate probability[kMaxForecastDays];
+
+	int32 count = AggregateDays(hourly, HOURLY_TEMPERATURE, utcOffset,
+		temperature, kMaxForecastDays);
+	AggregateDays(hourly, HOURLY_WEATHER_CODE, utcOffset, code,
+		kMaxForecastDays);
+	AggregateDays(hourly, HOURLY_PRECIPITATION, utcOffset, precipitation,
+		kMaxForecastDays);
+	AggregateDays(hourly, HOURLY_PRECIPITATION_PROBABILITY, utcOffset,
+		probability, kMaxForecastDays);
+
+	int64 midnight = hourly.startTime
+		- _FirstLocalHour(hourly, utcOffset) * kSecondsPerHour;
+
+	daily.count = count;
+	for (int32 day = 0; day < count; day++) {
+		daily.time[day] = midnight + day * kSecondsPerDay;
+		daily.maxTemperature[day] = temperature[day].maximum;
+		daily.minTemperature[day] = temperature[day].minimum;
+		// Like Open-Meteo's daily value: the most severe condition of the day
+		daily.weatherCode[day] = code[day].count > 0
+			? (int32) code[day].maximum : 0;
+		daily.precipitationSum[day] = precipitation[day].sum;
+		daily.maxPrecipitationProbability[day] = probability[day].maximum;
+	}
+}
+
+
+bool
+DeriveCurrentWeather(const hourly_weather& hourly, int64 now,
+	current_weather& current)
+{
+	// HourIndex() clamps, an hour outside of the forecast isn't current
+	current.valid = false;
+	if (hourly.count <= 0 || now < hourly.startTime
+		|| now >= hourly.startTime + hourly.count * kSecondsPerHour)
+		return false;
+
+	int32 index = HourIndex(hourly, now);
+
+	const float* temperature = hourly.values[HOURLY_TEMPERATURE];
+	float value = temperature[index];
+	if (value != value)
+		return false;
+
+	// Interpolate between the two closest hours
+	if (index + 1 < hourly.count && now > hourly.startTime) {
+		float next = temperature[index + 1];
+		float fraction = (float) ((now - hourly.startTime) % kSecondsPerHour)
+			/ kSecondsPerHour;
+		if (next == next)
+			value += (next - value) * fraction;
+	}
+
+	float code = hourly.values[HOURLY_WEATHER_CODE][index];
+	float isDay = hourly.values[HOURLY_IS_DAY][index];
+
+	current.valid = true;
+	current.time = hourly.startTime + index * kSecondsPerHour;
+	current.temperature = value;
+	current.weatherCode = code == code ? (int32) code : 0;
+	current.isDay = isDay == isDay ? isDay != 0 : true;
+	return true;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _HOURLYFORECAST_H_
+#define _HOURLYFORECAST_H_
+
+
+#include "ForecastData.h"
+
+
+struct hourly_aggregate {
+	float			minimum;
+	float			maximum;
+	float			sum;
+	int32			count;
+};
+
+
+// Kernels over one column of hourly values. They are written with
+// independent accumulators and no branches in the inner loop, so that the
+// compiler turns them into SIMD code. NaN (missing) values are skipped.
+float				HourlyMinimum(const float* values, int32 count);
+float				HourlyMaximum(const float* values, int32 count);
+float				HourlySum(const float* values, int32 count);
+void				AggregateHourly(const float* values, int32 count,
+						hourly_aggregate& aggregate);
+
+// Aggregates the hours [begin, end) of a variable
+void				AggregateWindow(const hourly_weather& hourly,
+						hourly_variable variable, int32 begin, int32 end,
+						hourly_aggregate& aggregate);
+
+// Aggregates a variable per local calendar day, returns the number of days
+int32				AggregateDays(const hourly_weather& hourly,
+						hourly_variable variable, int32 utcOffset,
+						hourly_aggregate* days, int32 maxDays);
+
+int32				HourIndex(const hourly_weather& hourly, int64 time);
+
+// Rebuild the daily and current data from the hourly columns. The current
+// weather is invalid when now isn't one of the hours.
+void				DeriveDailyWeather(const hourly_weather& hourly,
+						int32 utcOffset, daily_weather& daily);
+bool				DeriveCurrentWeather(const hourly_weather& hourly,
+						int64 now, current_weather& current);
+
+
+#endif // _HOURLYFORECAST_H_
@@ -0,0 +1,637 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "JsonStreamParser.h"
+
+
+static const double kPowersOfTen[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+	1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const int32 kMaxExactPower = 22;
+static const int32 kMaxMantissaDigits = 19;
+static const size_t kMinBufferSize = 256;
+
+
+JsonStreamListener::~JsonStreamListener()
+{
+}
+
+
+void
+JsonStreamListener::ObjectStarted()
+{
+}
+
+
+void
+JsonStreamListener::ObjectEnded()
+{
+}
+
+
+void
+JsonStreamListener::ArrayStarted()
+{
+}
+
+
+void
+JsonStreamListener::ArrayEnded()
+{
+}
+
+
+void
+JsonStreamListener::Key(const char* key, size_t length)
+{
+}
+
+
+void
+JsonStreamListener::String(const char* value, size_t length)
+{
+}
+
+
+void
+JsonStreamListener::Number(double value)
+{
+}
+
+
+void
+JsonStreamListener::Boolean(bool value)
+{
+}
+
+
+void
+JsonStreamListener::Null()
+{
+}
+
+
+JsonStreamParser::JsonStreamParser(JsonStreamListener* listener)
+	:
+	fListener(listener),
+	fBuffer(NULL),
+	fBufferLength(0),
+	fBufferSize(0)
+{
+	Reset();
+}
+
+
+JsonStreamParser::~JsonStreamParser()
+{
+	free(fBuffer);
+}
+
+
+void
+JsonStreamParser::Reset()
+{
+	fState = STATE_VALUE;
+	fStatus = B_OK;
+	fOffset = 0;
+	fDepth = 0;
+	fStringIsKey = false;
+	fBufferLength = 0;
+	fHighSurrogate = 0;
+	fLiteral = NULL;
+	fLiteralPosition = 0;
+	_StartNumber();
+}
+
+
+status_t
+JsonStreamParser::Feed(const char* data, size_t length)
+{
+	if (fState == STATE_ERROR)
+		return fStatus;
+
+	const char* position = data;
+	const char* end = data + length;
+	while (position < end) {
+		if (!_Step(position, end)) {
+			fOffset += position - data;
+			return _Fail();
+		}
+	}
+
+	fOffset += length;
+	return B_OK;
+}
+
+
+status_t
+JsonStreamParser::Finish()
+{
+	if (fState == STATE_ERROR)
+		return fStatus;
+
+	// A number is only terminated by the character following it
+	if (fState == STATE_NUMBER) {
+		if (!_EmitNumber())
+			return _Fail();
+		_ValueDone();
+	}
+
+	if (fState != STATE_DONE)
+		return _Fail();
+
+	return B_OK;
+}
+
+
+status_t
+JsonStreamParser::_Fail()
+{
+	fState = STATE_ERROR;
+	if (fStatus == B_OK)
+		fStatus = B_BAD_DATA;
+	return fStatus;
+}
+
+
+bool
+JsonStreamParser::_Step(const char*& data, const char* end)
+{
+	switch (fState) {
+		case STATE_STRING:
+			return _ScanString(data, end);
+
+		case STATE_STRING_ESCAPE:
+		{
+			char c = *data++;
+			fState = STATE_STRING;
+			if (c == 'u') {
+				fUnicode = 0;
+				fUnicodeDigits = 0;
+				fState = STATE_STRING_UNICODE;
+				return true;
+			}
+			if (!_FlushSurrogate())
+				return false;
+			switch (c) {
+				case '"':
+				case '\\':
+				case '/':
+					return _Append(&c, 1);
+				case 'b':
+					return _Append("\b", 1);
+				case 'f':
+					return _Append("\f", 1);
+				case 'n':
+					return _Append("\n", 1);
+				case 'r':
+					return _Append("\r", 1);
+				case 't':
+					return _Append("\t", 1);
+			}
+			return false;
+		}
+
+		case STATE_STRING_UNICODE:
+		{
+			char c = *data++;
+			uint32 digit;
+			if (c >= '0' && c <= '9')
+				digit = c - '0';
+			else if (c >= 'a' && c <= 'f')
+				digit = c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F')
+				digit = c - 'A' + 10;
+			else
+				return false;
+
+			fUnicode = (fUnicode << 4) | digit;
+			if (++fUnicodeDigits < 4)
+				return true;
+
+			fState = STATE_STRING;
+			uint32 codePoint = fUnicode;
+			if (fHighSurrogate != 0) {
+				if (codePoint >= 0xdc00 && codePoint <= 0xdfff) {
+					codePoint = 0x10000 + ((fHighSurrogate - 0xd800) << 10)
+						+ (codePoint - 0xdc00);
+					fHighSurrogate = 0;
+					return _AppendCodePoint(codePoint);
+				}
+				if (!_FlushSurrogate())
+					return false;
+			}
+			if (codePoint >= 0xd800 && codePoint <= 0xdbff) {
+				fHighSurrogate = codePoint;
+				return true;
+			}
+			if (codePoint >= 0xdc00 && codePoint <= 0xdfff)
+				codePoint = 0xfffd;
+			return _AppendCodePoint(codePoint);
+		}
+
+		case STATE_NUMBER:
+			if (_NumberChar(*data)) {
+				data++;
+				return true;
+			}
+			// The character ends the number, and is parsed as the next token
+			if (!_EmitNumber())
+				return false;
+			_ValueDone();
+			return true;
+
+		case STATE_LITERAL:
+			if (*data != fLiteral[fLiteralPosition])
+				return false;
+			data++;
+			if (fLiteral[++fLiteralPosition] != '\0')
+				return true;
+			if (fLiteral[0] == 'n')
+				fListener->Null();
+			else
+				fListener->Boolean(fLiteral[0] == 't');
+			_ValueDone();
+			return true;
+
+		case STATE_ERROR:
+			return false;
+
+		default:
+			break;
+	}
+
+	char c = *data;
+	if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+		data++;
+		return true;
+	}
+
+	data++;
+	switch (fState) {
+		case STATE_VALUE:
+			return _StartValue(c);
+
+		case STATE_ARRAY_FIRST:
+			if (c == ']')
+				return _Pop(false);
+			return _StartValue(c);
+
+		case STATE_OBJECT_FIRST:
+			if (c == '}')
+				return _Pop(true);
+			// fall through
+		case STATE_KEY:
+			if (c != '"')
+				return false;
+			fStringIsKey = true;
+			fBufferLength = 0;
+			fState = STATE_STRING;
+			return true;
+
+		case STATE_COLON:
+			if (c != ':')
+				return false;
+			fState = STATE_VALUE;
+			return true;
+
+		case STATE_AFTER_VALUE:
+			if (c == ',') {
+				fState = fStack[fDepth - 1] ? STATE_KEY : STATE_VALUE;
+				return true;
+			}
+			if (c == '}')
+				return _Pop(true);
+			if (c == ']')
+				return _Pop(false);
+			return false;
+
+		default:
+			// Anything but white space after the document is an error
+			return false;
+	}
+}
+
+
+bool
+JsonStreamParser::_ScanString(const char*& data, const char* end)
+{
+	const char* start = data;
+	while (data < end && *data != '"' && *data != '\\'
+		&& static_cast<uint8>(*data) >= 0x20) {
+		data++;
+	}
+
+	if (data > start && !_FlushSurrogate())
+		return false;
+
+	if (data == end)
+		return _Append(start, data - start);
+
+	char c = *data++;
+	if (c == '\\') {
+		fState = STATE_STRING_ESCAPE;
+		return _Append(start, data - 1 - start);
+	}
+	if (c != '"') {
+		// Unescaped control character
+		return false;
+	}
+
+	if (!_FlushSurrogate())
+		return false;
+
+	if (fBufferLength == 0) {
+		// The whole string is in this chunk, hand it out without copying
+		_EmitString(start, data - 1 - start);
+	} else {
+		if (!_Append(start, data - 1 - start))
+			return false;
+		_EmitString(fBuffer, fBufferLength);
+	}
+	fBufferLength = 0;
+
+	if (fStringIsKey)
+		fState = STATE_COLON;
+	else
+		_ValueDone();
+	return true;
+}
+
+
+bool
+JsonStreamParser::_Push(bool isObject)
+{
+	if (fDepth >= kMaxDepth)
+		return false;
+
+	fStack[fDepth++] = isObject;
+	if (isObject) {
+		fListener->ObjectStarted();
+		fState = STATE_OBJECT_FIRST;
+	} else {
+		fListener->ArrayStarted();
+		fState = STATE_ARRAY_FIRST;
+	}
+	return true;
+}
+
+
+bool
+JsonStreamParser::_Pop(bool isObject)
+{
+	if (fDepth == 0 || fStack[fDepth - 1] != isObject)
+		return false;
+
+	fDepth--;
+	if (isObject)
+		fListener->ObjectEnded();
+	else
+		fListener->ArrayEnded();
+	_ValueDone();
+	return true;
+}
+
+
+void
+JsonStreamParser::_ValueDone()
+{
+	fState = fDepth == 0 ? STATE_DONE : STATE_AFTER_VALUE;
+}
+
+
+bool
+JsonStreamParser::_StartValue(char c)
+{
+	switch (c) {
+		case '{':
+			return _Push(true);
+		case '[':
+			return _Push(false);
+		case '"':
+			fStringIsKey = false;
+			fBufferLength = 0;
+			fState = STATE_STRING;
+			return true;
+		case 't':
+			fLiteral = "true";
+			break;
+		case 'f':
+			fLiteral = "false";
+			break;
+		case 'n':
+			fLiteral = "null";
+			break;
+		default:
+			if (c != '-' && (c < '0' || c > '9'))
+				return false;
+			_StartNumber();
+			fState = STATE_NUMBER;
+			return _NumberChar(c);
+	}
+
+	fLiteralPosition = 1;
+	fState = STATE_LITERAL;
+	return true;
+}
+
+
+bool
+JsonStreamParser::_Append(const char* data, size_t length)
+{
+	if (length == 0)
+		return true;
+
+	if (fBufferLength + length + 1 > fBufferSize) {
+		size_t size = fBufferSize > 0 ? fBufferSize : kMinBufferSize;
+		while (size < fBufferLength + length + 1)
+			size *= 2;
+		char* buffer = static_cast<char*>(realloc(fBuffer, size));
+		if (buffer == NULL) {
+			fStatus = B_NO_MEMORY;
+			return false;
+		}
+		fBuffer = buffer;
+		fBufferSize = size;
+	}
+
+	memcpy(fBuffer + fBufferLength, data, length);
+	fBufferLength += length;
+	fBuffer[fBufferLength] = '\0';
+	return true;
+}
+
+
+bool
+JsonStreamParser::_AppendCodePoint(uint32 codePoint)
+{
+	char utf8[4];
+	size_t length;
+	if (codePoint < 0x80) {
+		utf8[0] = codePoint;
+		length = 1;
+	} else if (codePoint < 0x800) {
+		utf8[0] = 0xc0 | (codePoint >> 6);
+		utf8[1] = 0x80 | (codePoint & 0x3f);
+		length = 2;
+	} else if (codePoint < 0x10000) {
+		utf8[0] = 0xe0 | (codePoint >> 12);
+		utf8[1] = 0x80 | ((codePoint >> 6) & 0x3f);
+		utf8[2] = 0x80 | (codePoint & 0x3f);
+		length = 3;
+	} else {
+		utf8[0] = 0xf0 | (codePoint >> 18);
+		utf8[1] = 0x80 | ((codePoint >> 12) & 0x3f);
+		utf8[2] = 0x80 | ((codePoint >> 6) & 0x3f);
+		utf8[3] = 0x80 | (codePoint & 0x3f);
+		length = 4;
+	}
+	return _Append(utf8, length);
+}
+
+
+bool
+JsonStreamParser::_FlushSurrogate()
+{
+	// A high surrogate that is not followed by a low one
+	if (fHighSurrogate == 0)
+		return true;
+	fHighSurrogate = 0;
+	return _AppendCodePoint(0xfffd);
+}
+
+
+void
+JsonStreamParser::_EmitString(const char* data, size_t length)
+{
+	if (fStringIsKey)
+		fListener->Key(data, length);
+	else
+		fListener->String(data, length);
+}
+
+
+void
+JsonStreamParser::_StartNumber()
+{
+	fNumberPart = NUMBER_SIGN;
+	fNegative = false;
+	fMantissa = 0;
+	fDecimalExponent = 0;
+	fExponent = 0;
+	fExponentNegative = false;
+	fDigits = 0;
+}
+
+
+bool
+JsonStreamParser::_NumberChar(char c)
+{
+	bool isDigit = c >= '0' && c <= '9';
+
+	switch (fNumberPart) {
+		case NUMBER_SIGN:
+			if (c == '-' && !fNegative) {
+				fNegative = true;
+				return true;
+			}
+			if (!isDigit)
+				return false;
+			_AddDigit(c, false);
+			fNumberPart = NUMBER_INTEGER;
+			return true;
+
+		case NUMBER_INTEGER:
+			if (isDigit) {
+				_AddDigit(c, false);
+				return true;
+			}
+			if (c == '.') {
+				fNumberPart = NUMBER_FRACTION_START;
+				return true;
+			}
+			if (c == 'e' || c == 'E') {
+				fNumberPart = NUMBER_EXPONENT_SIGN;
+				return true;
+			}
+			return false;
+
+		case NUMBER_FRACTION_START:
+		case NUMBER_FRACTION:
+			if (isDigit) {
+				_AddDigit(c, true);
+				fNumberPart = NUMBER_FRACTION;
+				return true;
+			}
+			if (fNumberPart == NUMBER_FRACTION && (c == 'e' || c == 'E')) {
+				fNumberPart = NUMBER_EXPONENT_SIGN;
+				return true;
+			}
+			return false;
+
+		case NUMBER_EXPONENT_SIGN:
+			if (c == '+' || c == '-') {
+				fExponentNegative = c == '-';
+				fNumberPart = NUMBER_EXPONENT_START;
+				return true;
+			}
+			// fall through
+		case NUMBER_EXPONENT_START:
+		case NUMBER_EXPONENT:
+			if (!isDigit)
+				return false;
+			if (fExponent < 10000)
+				fExponent = fExponent * 10 + (c - '0');
+			fNumberPart = NUMBER_EXPONENT;
+			return true;
+	}
+	return false;
+}
+
+
+void
+JsonStreamParser::_AddDigit(char c, bool fraction)
+{
+	if (fDigits < kMaxMantissaDigits) {
+		fMantissa = fMantissa * 10 + (c - '0');
+		if (fMantissa != 0)
+			fDigits++;
+		if (fraction)
+			fDecimalExponent--;
+	} else if (!fraction) {
+		// Digits beyond the precision of the mantissa only scale it
+		fDecimalExponent++;
+	}
+}
+
+
+bool
+JsonStreamParser::_EmitNumber()
+{
+	if (fNumberPart != NUMBER_INTEGER && fNumberPart != NUMBER_FRACTION
+		&& fNumberPart != NUMBER_EXPONENT) {
+		return false;
+	}
+
+	int32 exponent = fDecimalExponent
+		+ (fExponentNegative ? -fExponent : fExponent);
+	double value = static_cast<double>(fMantissa);
+	if (value != 0 && exponent != 0) {
+		if (exponent > 0 && exponent <= kMaxExactPower)
+			value *= kPowersOfTen[exponent];
+		else if (exponent < 0 && -exponent <= kMaxExactPower)
+			value /= kPowersOfTen[-exponent];
+		else
+			value *= pow(10.0, exponent);
+	}
+
+	fListener->Number(fNegative ? -value : value);
+	return true;
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _JSONSTREAMPARSER_H_
+#define _JSONSTREAMPARSER_H_
+
+
+#include "CoreDefs.h"
+
+
+// Receives the events produced by JsonStreamParser. Strings and keys point
+// into the data being fed whenever possible: they are only valid for the
+// duration of the call and are not NUL terminated.
+class JsonStreamListener
+{
+public:
+	virtual				~JsonStreamListener();
+
+	virtual	void		ObjectStarted();
+	virtual	void		ObjectEnded();
+	virtual	void		ArrayStarted();
+	virtual	void		ArrayEnded();
+	virtual	void		Key(const char* key, size_t length);
+	virtual	void		String(const char* value, size_t length);
+	virtual	void		Number(double value);
+	virtual	void		Boolean(bool value);
+	virtual	void		Null();
+};
+
+
+// Incremental (SAX style) JSON parser. The document can be fed in chunks
+// of any size, split at any byte; no tree is built and strings are only
+// copied when they straddle two chunks or contain escape sequences.
+class JsonStreamParser
+{
+public:
+						JsonStreamParser(JsonStreamListener* listener);
+						~JsonStreamParser();
+
+			void		Reset();
+			status_t	Feed(const char* data, size_t length);
+			status_t	Finish();
+
+			status_t	Status() const { return fStatus; }
+			size_t		Offset() const { return fOffset; }
+
+private:
+			enum {
+				kMaxDepth = 64
+			};
+
+			enum parser_state {
+				STATE_VALUE,
+				STATE_ARRAY_FIRST,
+				STATE_OBJECT_FIRST,
+				STATE_KEY,
+				STATE_COLON,
+				STATE_AFTER_VALUE,
+				STATE_STRING,
+				STATE_STRING_ESCAPE,
+				STATE_STRING_UNICODE,
+				STATE_NUMBER,
+				STATE_LITERAL,
+				STATE_DONE,
+				STATE_ERROR
+			};
+
+			enum number_part {
+				NUMBER_SIGN,
+				NUMBER_INTEGER,
+				NUMBER_FRACTION_START,
+				NUMBER_FRACTION,
+				NUMBER_EXPONENT_SIGN,
+				NUMBER_EXPONENT_START,
+				NUMBER_EXPONENT
+			};
+
+			status_t	_Fail();
+			bool		_Step(const char*& data, const char* end);
+			bool		_ScanString(const char*& data, const char* end);
+			bool		_Push(bool isObject);
+			bool		_Pop(bool isObject);
+			void		_ValueDone();
+			bool		_StartValue(char c);
+			bool		_Append(const char* data, size_t length);
+			bool		_AppendCodePoint(uint32 codePoint);
+			bool		_FlushSurrogate();
+			void		_EmitString(const char* data, size_t length);
+			void		_StartNumber();
+			bool		_NumberChar(char c);
+			void		_AddDigit(char c, bool fraction);
+			bool		_EmitNumber();
+
+			JsonStreamListener* fListener;
+			parser_state fState;
+			status_t	fStatus;
+			size_t		fOffset;
+
+			bool		fStack[kMaxDepth];
+			int32		fDepth;
+
+			// string token
+			bool		fStringIsKey;
+			char*		fBuffer;
+			size_t		fBufferLength;
+			size_t		fBufferSize;
+			uint32		fUnicode;
+			int32		fUnicodeDigits;
+			uint32		fHighSurrogate;
+
+			// number token
+			number_part	fNumberPart;
+			bool		fNegative;
+			uint64		fMantissa;
+			int32		fDecimalExponent;
+			int32		fExponent;
+			bool		fExponentNegative;
+			int32		fDigits;
+
+			// true, false, null
+			const char*	fLiteral;
+			int32		fLiteralPosition;
+};
+
+
+#endif // _JSONSTREAMPARSER_H_
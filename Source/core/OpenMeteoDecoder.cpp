@@ -0,0 +1,617 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ * Weather data by Open-Meteo.com at https://open-meteo.com/
+ * under Attribution-NonCommercial 4.0 International (CC BY-NC 4.0).
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <new>
+
+#include "OpenMeteoDecoder.h"
+
+
+enum {
+	KEY_UTC_OFFSET = 2,
+	KEY_CURRENT_WEATHER,
+	KEY_TEMPERATURE,
+	KEY_WEATHERCODE,
+	KEY_TIME,
+	KEY_IS_DAY,
+	KEY_DAILY,
+	KEY_TEMPERATURE_MAX,
+	KEY_TEMPERATURE_MIN,
+	KEY_HOURLY,
+	KEY_TEMPERATURE_2M,
+	KEY_PRECIPITATION_PROBABILITY,
+	KEY_PRECIPITATION
+};
+
+static const char* const kForecastKeys[] = {
+	"error",
+	"reason",
+	"utc_offset_seconds",
+	"current_weather",
+	"temperature",
+	"weathercode",
+	"time",
+	"is_day",
+	"daily",
+	"temperature_2m_max",
+	"temperature_2m_min",
+	"hourly",
+	"temperature_2m",
+	"precipitation_probability",
+	"precipitation",
+	NULL
+};
+
+
+enum {
+	KEY_RESULTS = 2,
+	KEY_ID,
+	KEY_NAME,
+	KEY_LATITUDE,
+	KEY_LONGITUDE,
+	KEY_COUNTRY,
+	KEY_COUNTRY_ID,
+	KEY_ADMIN1,
+	KEY_ADMIN2,
+	KEY_ADMIN3
+};
+
+static const char* const kCityKeys[] = {
+	"error",
+	"reason",
+	"results",
+	"id",
+	"name",
+	"latitude",
+	"longitude",
+	"country",
+	"country_id",
+	"admin1",
+	"admin2",
+	"admin3",
+	NULL
+};
+
+
+OpenMeteoDecoder::OpenMeteoDecoder(const char* const* keys)
+	:
+	fParser(this),
+	fKeys(keys)
+{
+	OpenMeteoDecoder::Reset();
+}
+
+
+OpenMeteoDecoder::~OpenMeteoDecoder()
+{
+}
+
+
+void
+OpenMeteoDecoder::Reset()
+{
+	fParser.Reset();
+	fDepth = 0;
+	fBatch = false;
+	fKey[0] = kUnknownKey;
+	fIndex[0] = -1;
+	fIsArray[0] = false;
+	fServiceError = false;
+	fReason[0] = '\0';
+}
+
+
+status_t
+OpenMeteoDecoder::Feed(const char* data, size_t length)
+{
+	return fParser.Feed(data, length);
+}
+
+
+status_t
+OpenMeteoDecoder::Finish()
+{
+	return fParser.Finish();
+}
+
+
+status_t
+OpenMeteoDecoder::Status() const
+{
+	return fParser.Status();
+}
+
+
+void
+OpenMeteoDecoder::ObjectStarted()
+{
+	_Push(false);
+}
+
+
+void
+OpenMeteoDecoder::ObjectEnded()
+{
+	ObjectCompleted();
+	_Pop();
+}
+
+
+void
+OpenMeteoDecoder::ArrayStarted()
+{
+	_Push(true);
+}
+
+
+void
+OpenMeteoDecoder::ArrayEnded()
+{
+	_Pop();
+}
+
+
+void
+OpenMeteoDecoder::Key(const char* key, size_t length)
+{
+	if (fDepth > kMaxTrackedDepth)
+		return;
+
+	int32 id = kUnknownKey;
+	for (int32 i = 0; fKeys[i] != NULL; i++) {
+		if (strncmp(fKeys[i], key, length) == 0 && fKeys[i][length] == '\0') {
+			id = i;
+			break;
+		}
+	}
+	fKey[fDepth] = id;
+}
+
+
+void
+OpenMeteoDecoder::String(const char* value, size_t length)
+{
+	if (fDepth == 1 && fKey[1] == kReasonKey)
+		CopyString(fReason, sizeof(fReason), value, length);
+	else
+		StringFound(value, length);
+	_ValueEnded();
+}
+
+
+void
+OpenMeteoDecoder::Number(double value)
+{
+	NumberFound(value);
+	_ValueEnded();
+}
+
+
+void
+OpenMeteoDecoder::Boolean(bool value)
+{
+	if (fDepth == 1 && fKey[1] == kErrorKey)
+		fServiceError = value;
+	_ValueEnded();
+}
+
+
+void
+OpenMeteoDecoder::Null()
+{
+	_ValueEnded();
+}
+
+
+void
+OpenMeteoDecoder::NumberFound(double value)
+{
+}
+
+
+void
+OpenMeteoDecoder::StringFound(const char* value, size_t length)
+{
+}
+
+
+void
+OpenMeteoDecoder::ObjectCompleted()
+{
+}
+
+
+int32
+OpenMeteoDecoder::Depth() const
+{
+	return fBatch ? fDepth - 1 : fDepth;
+}
+
+
+int32
+OpenMeteoDecoder::KeyAt(int32 depth) const
+{
+	int32 level = _Level(depth);
+	if (level < 0 || fIsArray[level])
+		return kUnknownKey;
+	return fKey[level];
+}
+
+
+int32
+OpenMeteoDecoder::IndexAt(int32 depth) const
+{
+	int32 level = _Level(depth);
+	if (level < 0 || !fIsArray[level])
+		return -1;
+	return fIndex[level];
+}
+
+
+int32
+OpenMeteoDecoder::LocationIndex() const
+{
+	if (!fBatch)
+		return 0;
+	return fDepth >= 1 ? fIndex[1] : -1;
+}
+
+
+/*static*/ void
+OpenMeteoDecoder::CopyString(char* target, size_t size, const char* value,
+	size_t length)
+{
+	if (length >= size) {
+		// Do not cut a multi-byte UTF-8 character in half
+		length = size - 1;
+		while (length > 0 && (value[length] & 0xc0) == 0x80)
+			length--;
+	}
+	memcpy(target, value, length);
+	target[length] = '\0';
+}
+
+
+void
+OpenMeteoDecoder::_Push(bool isArray)
+{
+	fDepth++;
+	if (fDepth > kMaxTrackedDepth)
+		return;
+
+	if (fDepth == 1)
+		fBatch = isArray;
+
+	fIsArray[fDepth] = isArray;
+	fIndex[fDepth] = 0;
+	fKey[fDepth] = kUnknownKey;
+}
+
+
+void
+OpenMeteoDecoder::_Pop()
+{
+	fDepth--;
+	_ValueEnded();
+}
+
+
+void
+OpenMeteoDecoder::_ValueEnded()
+{
+	if (fDepth <= kMaxTrackedDepth && fIsArray[fDepth])
+		fIndex[fDepth]++;
+}
+
+
+// Maps a depth as the subclasses see it to the level in the path
+int32
+OpenMeteoDecoder::_Level(int32 depth) const
+{
+	if (depth < 1)
+		return -1;
+
+	int32 level = fBatch ? depth + 1 : depth;
+	if (level > fDepth || level > kMaxTrackedDepth)
+		return -1;
+	return level;
+}
+
+
+// #pragma mark - ForecastDecoder
+
+
+ForecastDecoder::ForecastDecoder(int32 locationCount)
+	:
+	OpenMeteoDecoder(kForecastKeys),
+	fForecasts(NULL),
+	fLocationCount(0),
+	fCount(0)
+{
+	SetLocationCount(locationCount);
+}
+
+
+ForecastDecoder::~ForecastDecoder()
+{
+	delete[] fForecasts;
+}
+
+
+void
+ForecastDecoder::Reset()
+{
+	OpenMeteoDecoder::Reset();
+	fCount = 0;
+
+	for (int32 index = 0; index < fLocationCount; index++) {
+		forecast_data& data = fForecasts[index];
+		memset(&data, 0, sizeof(data));
+
+		// Hours missing from the response, or null in it, stay NaN
+		for (int32 i = 0; i < kHourlyVariableCount; i++) {
+			float* values = data.hourly.values[i];
+			for (int32 hour = 0; hour < kMaxForecastHours; hour++)
+				values[hour] = NAN;
+		}
+	}
+}
+
+
+// Also resets the decoder
+status_t
+ForecastDecoder::SetLocationCount(int32 count)
+{
+	if (count < 1)
+		count = 1;
+
+	if (count != fLocationCount) {
+		forecast_data* forecasts = new(std::nothrow) forecast_data[count];
+		if (forecasts == NULL)
+			return B_NO_MEMORY;
+
+		delete[] fForecasts;
+		fForecasts = forecasts;
+		fLocationCount = count;
+	}
+
+	Reset();
+	return B_OK;
+}
+
+
+forecast_data*
+ForecastDecoder::_Current()
+{
+	// Responses for more locations than asked for are ignored
+	int32 index = LocationIndex();
+	if (index < 0 || index >= fLocationCount)
+		return NULL;
+
+	if (index >= fCount)
+		fCount = index + 1;
+	return &fForecasts[index];
+}
+
+
+void
+ForecastDecoder::NumberFound(double value)
+{
+	if (Depth() < 1 || Depth() > 3)
+		return;
+
+	forecast_data* data = _Current();
+	if (data == NULL)
+		return;
+
+	switch (Depth()) {
+		case 1:
+			if (KeyAt(1) == KEY_UTC_OFFSET)
+				data->utcOffset = (int32) value;
+			break;
+
+		case 2:
+		{
+			if (KeyAt(1) != KEY_CURRENT_WEATHER)
+				break;
+
+			current_weather& current = data->current;
+			switch (KeyAt(2)) {
+				case KEY_TEMPERATURE:
+					current.temperature = value;
+					break;
+				case KEY_WEATHERCODE:
+					current.weatherCode = (int32) value;
+					break;
+				case KEY_TIME:
+					current.time = (int64) value;
+					break;
+				case KEY_IS_DAY:
+					current.isDay = value != 0;
+					break;
+				default:
+					return;
+			}
+			current.valid = true;
+			break;
+		}
+
+		case 3:
+		{
+			if (KeyAt(1) == KEY_HOURLY) {
+				_HourlyNumberFound(*data, value);
+				break;
+			}
+
+			int32 day = IndexAt(3);
+			if (KeyAt(1) != KEY_DAILY || day < 0 || day >= kMaxForecastDays)
+				break;
+
+			daily_weather& daily = data->daily;
+			switch (KeyAt(2)) {
+				case KEY_TIME:
+					daily.time[day] = (int64) value;
+					break;
+				case KEY_WEATHERCODE:
+					daily.weatherCode[day] = (int32) value;
+					break;
+				case KEY_TEMPERATURE_MAX:
+					daily.maxTemperature[day] = value;
+					break;
+				case KEY_TEMPERATURE_MIN:
+					daily.minTemperature[day] = value;
+					break;
+				default:
+					return;
+			}
+			if (day >= daily.count)
+				daily.count = day + 1;
+			break;
+		}
+	}
+}
+
+
+void
+ForecastDecoder::_HourlyNumberFound(forecast_data& data, double value)
+{
+	int32 hour = IndexAt(3);
+	if (hour < 0 || hour >= kMaxForecastHours)
+		return;
+
+	hourly_weather& hourly = data.hourly;
+	hourly_variable variable;
+	switch (KeyAt(2)) {
+		case KEY_TIME:
+			// Hours are consecutive, only the first one is needed
+			if (hour == 0)
+				hourly.startTime = (int64) value;
+			return;
+		case KEY_TEMPERATURE_2M:
+			variable = HOURLY_TEMPERATURE;
+			break;
+		case KEY_PRECIPITATION_PROBABILITY:
+			variable = HOURLY_PRECIPITATION_PROBABILITY;
+			break;
+		case KEY_PRECIPITATION:
+			variable = HOURLY_PRECIPITATION;
+			break;
+		case KEY_WEATHERCODE:
+			variable = HOURLY_WEATHER_CODE;
+			break;
+		case KEY_IS_DAY:
+			variable = HOURLY_IS_DAY;
+			break;
+		default:
+			return;
+	}
+
+	hourly.values[variable][hour] = value;
+	if (hour >= hourly.count)
+		hourly.count = hour + 1;
+}
+
+
+// #pragma mark - CityDecoder
+
+
+CityDecoder::CityDecoder()
+	:
+	OpenMeteoDecoder(kCityKeys),
+	fResults(new city_result[kMaxCityResults])
+{
+	CityDecoder::Reset();
+}
+
+
+CityDecoder::~CityDecoder()
+{
+	delete[] fResults;
+}
+
+
+void
+CityDecoder::Reset()
+{
+	OpenMeteoDecoder::Reset();
+	memset(&fCurrent, 0, sizeof(fCurrent));
+	fCount = 0;
+}
+
+
+bool
+CityDecoder::_InResult() const
+{
+	return Depth() == 3 && KeyAt(1) == KEY_RESULTS && IndexAt(2) >= 0;
+}
+
+
+void
+CityDecoder::NumberFound(double value)
+{
+	if (!_InResult())
+		return;
+
+	switch (KeyAt(3)) {
+		case KEY_ID:
+			fCurrent.id = (int32) value;
+			break;
+		case KEY_COUNTRY_ID:
+			fCurrent.countryId = (int32) value;
+			break;
+		case KEY_LATITUDE:
+			fCurrent.latitude = value;
+			break;
+		case KEY_LONGITUDE:
+			fCurrent.longitude = value;
+			break;
+	}
+}
+
+
+void
+CityDecoder::StringFound(const char* value, size_t length)
+{
+	if (!_InResult())
+		return;
+
+	char* target;
+	switch (KeyAt(3)) {
+		case KEY_NAME:
+			target = fCurrent.name;
+			break;
+		case KEY_COUNTRY:
+			target = fCurrent.country;
+			break;
+		case KEY_ADMIN1:
+			target = fCurrent.admin1;
+			break;
+		case KEY_ADMIN2:
+			target = fCurrent.admin2;
+			break;
+		case KEY_ADMIN3:
+			target = fCurrent.admin3;
+			break;
+		default:
+			return;
+	}
+	CopyString(target, kMaxPlaceNameLength, value, length);
+}
+
+
+void
+CityDecoder::ObjectCompleted()
+{
+	if (!_InResult())
+		return;
+
+	if (fCount < kMaxCityResults)
+		fResults[fCount++] = fCurrent;
+	memset(&fCurrent, 0, sizeof(fCurrent));
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _OPENMETEODECODER_H_
+#define _OPENMETEODECODER_H_
+
+
+#include "ForecastData.h"
+#include "JsonStreamParser.h"
+
+
+// Decodes an Open-Meteo response while it is being received. Keeps track of
+// the key path of the current value so that subclasses can pick the fields
+// they know about and store them straight into typed structures.
+//
+// A request for several locations is answered with an array holding one
+// response per location. The array level is hidden from the subclasses:
+// they see the same paths as for a single location, and LocationIndex()
+// tells them which location the current value belongs to.
+class OpenMeteoDecoder : public JsonStreamListener
+{
+public:
+						OpenMeteoDecoder(const char* const* keys);
+	virtual				~OpenMeteoDecoder();
+
+	virtual	void		Reset();
+			status_t	Feed(const char* data, size_t length);
+			status_t	Finish();
+
+			status_t	Status() const;
+			size_t		Offset() const { return fParser.Offset(); }
+			bool		IsServiceError() const { return fServiceError; }
+			const char*	ServiceErrorReason() const { return fReason; }
+
+	virtual	void		ObjectStarted();
+	virtual	void		ObjectEnded();
+	virtual	void		ArrayStarted();
+	virtual	void		ArrayEnded();
+	virtual	void		Key(const char* key, size_t length);
+	virtual	void		String(const char* value, size_t length);
+	virtual	void		Number(double value);
+	virtual	void		Boolean(bool value);
+	virtual	void		Null();
+
+protected:
+			enum {
+				kMaxTrackedDepth = 8,
+				kUnknownKey = -1,
+				// Every key table starts with these
+				kErrorKey = 0,
+				kReasonKey = 1
+			};
+
+	// Hooks for the subclasses, called with the path already up to date
+	virtual	void		NumberFound(double value);
+	virtual	void		StringFound(const char* value, size_t length);
+	virtual	void		ObjectCompleted();
+
+			int32		Depth() const;
+			int32		KeyAt(int32 depth) const;
+			int32		IndexAt(int32 depth) const;
+			int32		LocationIndex() const;
+
+	static	void		CopyString(char* target, size_t size,
+							const char* value, size_t length);
+
+private:
+			void		_Push(bool isArray);
+			void		_Pop();
+			void		_ValueEnded();
+			int32		_Level(int32 depth) const;
+
+			JsonStreamParser fParser;
+			const char* const* fKeys;
+			int32		fDepth;
+			bool		fBatch;
+			int32		fKey[kMaxTrackedDepth + 1];
+			int32		fIndex[kMaxTrackedDepth + 1];
+			bool		fIsArray[kMaxTrackedDepth + 1];
+
+			bool		fServiceError;
+			char		fReason[256];
+};
+
+
+class ForecastDecoder : public OpenMeteoDecoder
+{
+public:
+						ForecastDecoder(int32 locationCount = 1);
+	virtual				~ForecastDecoder();
+
+	virtual	void		Reset();
+			status_t	SetLocationCount(int32 count);
+
+			// Locations past the last one the response had data for are
+			// not counted
+			int32		CountForecasts() const { return fCount; }
+			const forecast_data& ForecastAt(int32 index) const
+							{ return fForecasts[index]; }
+			const forecast_data& Data() const { return fForecasts[0]; }
+
+protected:
+	virtual	void		NumberFound(double value);
+
+private:
+			forecast_data* _Current();
+			void		_HourlyNumberFound(forecast_data& data,
+							double value);
+
+			forecast_data* fForecasts;
+			int32		fLocationCount;
+			int32		fCount;
+};
+
+
+class CityDecoder : public OpenMeteoDecoder
+{
+public:
+						CityDecoder();
+	virtual				~CityDecoder();
+
+	virtual	void		Reset();
+
+			int32		CountResults() const { return fCount; }
+			const city_result& ResultAt(int32 index) const
+							{ return fResults[index]; }
+
+protected:
+	virtual	void		NumberFound(double value);
+	virtual	void		StringFound(const char* value, size_t length);
+	virtual	void		ObjectCompleted();
+
+private:
+			bool		_InResult() const;
+
+			city_result* fResults;
+			city_result	fCurrent;
+			int32		fCount;
+};
+
+
+#endif // _OPENMETEODECODER_H_
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ForecastData.h"
+#include "OpenMeteoUrl.h"
+
+
+static const char* kForecastUrl = "https://api.open-meteo.com";
+static const char* kGeocodingUrl = "https://geocoding-api.open-meteo.com";
+
+
+static std::string
+base_url(const char* variable, const char* defaultUrl)
+{
+	const char* override = getenv(variable);
+	std::string url(override != NULL && override[0] != '\0'
+		? override : defaultUrl);
+	while (!url.empty() && url[url.size() - 1] == '/')
+		url.erase(url.size() - 1);
+	return url;
+}
+
+
+// Two decimals, about 1 km, as the coordinates were always sent
+static void
+append_coordinate(std::string& url, double coordinate)
+{
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%.2f", coordinate);
+	url += buffer;
+}
+
+
+std::string
+ForecastBaseUrl()
+{
+	return base_url("WEATHER_FORECAST_URL", kForecastUrl);
+}
+
+
+std::string
+GeocodingBaseUrl()
+{
+	return base_url("WEATHER_GEOCODING_URL", kGeocodingUrl);
+}
+
+
+std::string
+ForecastUrl(const forecast_location* locations, int32 count,
+	DisplayUnit unit)
+{
+	if (count > kMaxBatchLocations)
+		count = kMaxBatchLocations;
+
+	std::string url = ForecastBaseUrl();
+	url += "/v1/forecast?latitude=";
+	for (int32 i = 0; i < count; i++) {
+		if (i > 0)
+			url += ",";
+		append_coordinate(url, locations[i].latitude);
+	}
+	url += "&longitude=";
+	for (int32 i = 0; i < count; i++) {
+		if (i > 0)
+			url += ",";
+		append_coordinate(url, locations[i].longitude);
+	}
+
+	url += "&hourly=temperature_2m,precipitation_probability,precipitation,"
+		"weathercode,is_day&forecast_days=";
+	url += std::to_string(kMaxForecastDays);
+	url += "&timeformat=unixtime&timezone=auto";
+
+	// Anything else is an old setting, Celsius was the default
+	url += unit == FAHRENHEIT
+		? "&temperature_unit=fahrenheit" : "&temperature_unit=celsius";
+	return url;
+}
+
+
+std::string
+CitySearchUrl(const char* query, const char* language)
+{
+	std::string url = GeocodingBaseUrl();
+	url += "/v1/search?name=";
+
+	// Filter out characters that trip up BUrl
+	for (const char* c = query; *c != '\0'; c++) {
+		if (*c == ' ')
+			url += '+';
+		else if (*c != '<' && *c != '>' && *c != '"')
+			url += *c;
+	}
+
+	// Results in the local language if available, otherwise in English or
+	// the native name of the place. Lower-cased.
+	if (language != NULL && language[0] != '\0') {
+		url += "&language=";
+		for (const char* c = language; *c != '\0'; c++)
+			url += tolower((unsigned char) *c);
+	}
+	return url;
+}
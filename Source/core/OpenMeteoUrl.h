@@ -0,0 +1,40 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _OPENMETEOURL_H_
+#define _OPENMETEOURL_H_
+
+
+#include <string>
+
+#include "CoreDefs.h"
+#include "Units.h"
+
+
+// Forecasts asked for in one request. Every location is billed as one call
+// and makes the URL longer, larger batches are split into several requests.
+const int32 kMaxBatchLocations = 50;
+
+struct forecast_location {
+	double			latitude;
+	double			longitude;
+};
+
+
+// Where forecasts and city searches are requested from, Open-Meteo unless
+// the WEATHER_FORECAST_URL and WEATHER_GEOCODING_URL environment variables
+// name another server, like tools/MockOpenMeteo
+std::string			ForecastBaseUrl();
+std::string			GeocodingBaseUrl();
+
+// The hourly forecast of up to kMaxBatchLocations locations. Only hourly
+// data is requested, the daily and current values are derived from it.
+std::string			ForecastUrl(const forecast_location* locations,
+						int32 count, DisplayUnit unit);
+
+// Cities matching the query, named in the given language if it isn't NULL
+std::string			CitySearchUrl(const char* query, const char* language);
+
+
+#endif // _OPENMETEOURL_H_
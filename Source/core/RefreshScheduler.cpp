@@ -0,0 +1,138 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#include <algorithm>
+
+#include "RefreshScheduler.h"
+
+
+// New model data is available some minutes after every full hour
+static const int64 kPublicationInterval = 60 * 60;
+static const int64 kPublicationDelay = 15 * 60;
+
+static const int32 kMinRefreshInterval = 60;
+static const int32 kMaxJitter = 5 * 60;
+static const int32 kMinBackoff = 30;
+static const int32 kMaxBackoff = 30 * 60;
+// Data this fresh isn't fetched again only because the window was shown
+static const int32 kMinShowAge = 5 * 60;
+
+
+RefreshScheduler::RefreshScheduler(int32 interval)
+	:
+	fInterval(std::max(interval, kMinRefreshInterval)),
+	fFetchTime(0),
+	fNextRefresh(0),
+	fFailures(0)
+{
+	fRandomState = (uint32) system_time()
+		^ ((uint32) find_thread(NULL) << 16);
+	if (fRandomState == 0)
+		fRandomState = 1;
+}
+
+
+void
+RefreshScheduler::SetInterval(int32 interval)
+{
+	interval = std::max(interval, kMinRefreshInterval);
+	if (interval == fInterval)
+		return;
+
+	fInterval = interval;
+	if (fFetchTime > 0 && fFailures == 0)
+		_Schedule();
+}
+
+
+void
+RefreshScheduler::Succeeded(int64 fetchTime)
+{
+	fFetchTime = fetchTime;
+	fFailures = 0;
+	_Schedule();
+}
+
+
+void
+RefreshScheduler::Failed(int64 now, int32 retryAfter)
+{
+	// Half of the backoff is fixed, the other half jitter
+	int32 backoff = kMinBackoff << std::min(fFailures, (int32) 16);
+	backoff = std::min(std::min(backoff, kMaxBackoff), fInterval);
+	fFailures++;
+
+	fNextRefresh = now + backoff / 2 + _Random(backoff / 2 + 1);
+
+	// Past the interval as well: asking sooner would only fail again. The
+	// jitter keeps the clients told the same from all coming back at once.
+	if (retryAfter > 0 && now + retryAfter >= fNextRefresh)
+		fNextRefresh = now + retryAfter + _Random(kMinBackoff + 1);
+}
+
+
+bigtime_t
+RefreshScheduler::Delay(int64 now) const
+{
+	if (fNextRefresh <= now)
+		return 0;
+	return (fNextRefresh - now) * 1000000;
+}
+
+
+bool
+RefreshScheduler::IsDue(int64 now) const
+{
+	return now >= fNextRefresh;
+}
+
+
+bool
+RefreshScheduler::ShouldRefreshOnShow(int64 now) const
+{
+	if (IsDue(now))
+		return true;
+	if (fFailures > 0)
+		return false;
+
+	return _LastPublication(now) > fFetchTime
+		&& now - fFetchTime >= kMinShowAge;
+}
+
+
+int64
+RefreshScheduler::_LastPublication(int64 time) const
+{
+	int64 publication = (time - kPublicationDelay) / kPublicationInterval
+		* kPublicationInterval + kPublicationDelay;
+	if (publication > time)
+		publication -= kPublicationInterval;
+	return publication;
+}
+
+
+void
+RefreshScheduler::_Schedule()
+{
+	// The last publication within the interval, or if the interval is too
+	// short for one, the next publication
+	int64 refresh = _LastPublication(fFetchTime + fInterval);
+	if (refresh <= fFetchTime)
+		refresh += kPublicationInterval;
+	refresh = std::max(refresh, fFetchTime + kMinRefreshInterval);
+
+	fNextRefresh = refresh + _Random(std::min(kMaxJitter, fInterval / 4) + 1);
+}
+
+
+int32
+RefreshScheduler::_Random(int32 range)
+{
+	// xorshift32, only needs to differ between clients
+	fRandomState ^= fRandomState << 13;
+	fRandomState ^= fRandomState >> 17;
+	fRandomState ^= fRandomState << 5;
+	return range > 0 ? fRandomState % range : 0;
+}
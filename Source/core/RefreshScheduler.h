@@ -0,0 +1,60 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _REFRESHSCHEDULER_H_
+#define _REFRESHSCHEDULER_H_
+
+
+#include "CoreDefs.h"
+
+
+// Decides when the forecast is fetched again. Open-Meteo publishes new
+// model data once an hour, so a refresh is moved to the last publication
+// before the configured interval runs out: it gets the same data as one at
+// the end of the interval, only sooner. A refresh never happens before new
+// data could have been published since the last one.
+//
+// Every refresh is delayed by a random jitter, so that the many clients
+// started at the same time don't all ask at the publication time. Failed
+// refreshes are retried after an exponential backoff, which is capped, or
+// once the time the server asked to wait is over.
+//
+// Times are in seconds since the epoch, like the fetch times of the
+// snapshots; delays are in microseconds, for a BMessageRunner.
+class RefreshScheduler
+{
+public:
+						RefreshScheduler(int32 interval);
+
+			void		SetInterval(int32 interval);
+			int32		Interval() const { return fInterval; }
+
+			void		Succeeded(int64 fetchTime);
+			// The server may ask to wait a number of seconds before the
+			// next attempt, which is then put off at least that long
+			void		Failed(int64 now, int32 retryAfter = 0);
+
+			int64		NextRefresh() const { return fNextRefresh; }
+			bigtime_t	Delay(int64 now) const;
+			bool		IsDue(int64 now) const;
+
+			// Whether a view that became visible should refresh right away
+			// instead of waiting: new data was published since the last
+			// refresh, or one was put off while it was hidden.
+			bool		ShouldRefreshOnShow(int64 now) const;
+
+private:
+			int64		_LastPublication(int64 time) const;
+			void		_Schedule();
+			int32		_Random(int32 range);
+
+			int32		fInterval;
+			int64		fFetchTime;
+			int64		fNextRefresh;
+			int32		fFailures;
+			uint32		fRandomState;
+};
+
+
+#endif // _REFRESHSCHEDULER_H_
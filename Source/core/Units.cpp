@@ -0,0 +1,18 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#include <stdio.h>
+
+#include "Units.h"
+
+
+int
+FormatTemperature(char* buffer, size_t size, DisplayUnit unit,
+	int32 temperature)
+{
+	// Anything else is an old setting, Celsius was the default
+	const char* symbol = unit == FAHRENHEIT ? "°F" : "°C";
+	return snprintf(buffer, size, "%" B_PRId32 "%s", temperature, symbol);
+}
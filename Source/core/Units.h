@@ -0,0 +1,29 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _UNITS_H_
+#define _UNITS_H_
+
+
+#include "CoreDefs.h"
+
+
+// Open-Meteo sends temperatures in the unit they were requested in, so
+// they are never converted
+enum DisplayUnit {
+	CELSIUS = 1,
+	FAHRENHEIT = 2
+};
+typedef enum DisplayUnit DisplayUnit;
+
+const size_t kMaxTemperatureLength = 16;
+
+
+// Writes a temperature the way the views show it, like "21°C", and returns
+// its length as snprintf() does
+int					FormatTemperature(char* buffer, size_t size,
+						DisplayUnit unit, int32 temperature);
+
+
+#endif // _UNITS_H_
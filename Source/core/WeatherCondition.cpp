@@ -0,0 +1,178 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifdef __HAIKU__
+#include <Catalog.h>
+#else
+// The texts are only marked for translation, they are translated by the
+// views
+#define B_TRANSLATE_MARK(string) (string)
+#endif
+
+#include "WeatherCondition.h"
+
+
+#undef B_TRANSLATION_CONTEXT
+#define B_TRANSLATION_CONTEXT "ForecastView"
+
+
+struct condition_range {
+	int32				first;
+	int32				last;
+	weather_condition	condition;
+};
+
+
+// Consecutive codes of one kind share an entry. Open-Meteo only sends the
+// codes of the present weather, the others are mapped to their closest one
+// in case they show up.
+static constexpr condition_range kConditionRanges[] = {
+	{0, 0, {ICON_CLEAR, ICON_CLEAR_NIGHT, SEVERITY_NONE,
+		B_TRANSLATE_MARK("Clear sky")}},
+	{1, 1, {ICON_FEW_CLOUDS, ICON_NIGHT_FEW_CLOUDS, SEVERITY_NONE,
+		B_TRANSLATE_MARK("Mainly clear")}},
+	{2, 2, {ICON_PARTLY_CLOUDY, ICON_MOSTLY_CLOUDY_NIGHT, SEVERITY_NONE,
+		B_TRANSLATE_MARK("Partly cloudy")}},
+	{3, 3, {ICON_CLOUDS, ICON_CLOUDS, SEVERITY_NONE,
+		B_TRANSLATE_MARK("Overcast")}},
+	{4, 9, {ICON_SMOKY, ICON_SMOKY, SEVERITY_LIGHT,
+		B_TRANSLATE_MARK("Haze")}},
+	{10, 12, {ICON_FOG, ICON_FOG, SEVERITY_LIGHT,
+		B_TRANSLATE_MARK("Mist")}},
+	{13, 17, {ICON_THUNDER, ICON_THUNDER, SEVERITY_MODERATE,
+		B_TRANSLATE_MARK("Thunder")}},
+	{18, 18, {ICON_STORM, ICON_STORM, SEVERITY_SEVERE,
+		B_TRANSLATE_MARK("Squalls")}},
+	{19, 19, {ICON_TORNADO, ICON_TORNADO, SEVERITY_SEVERE,
+		B_TRANSLATE_MARK("Funnel cloud")}},
+	{20, 28, {ICON_RAINING_SCATTERED, ICON_RAINING_SCATTERED, SEVERITY_LIGHT,
+		B_TRANSLATE_MARK("Recent precipitation")}},
+	{29, 29, {ICON_ISOLATED_THUNDERSTORM, ICON_ISOLATED_THUNDERSTORM,
+		SEVERITY_MODERATE, B_TRANSLATE_MARK("Recent thunderstorm")}},
+	{30, 35, {ICON_SMOKY, ICON_SMOKY, SEVERITY_SEVERE,
+		B_TRANSLATE_MARK("Duststorm")}},
+	{36, 39, {ICON_SNOW, ICON_SNOW, SEVERITY_MODERATE,
+		B_TRANSLATE_MARK("Blowing snow")}},
+	{40, 47, {ICON_FOG, ICON_FOG, SEVERITY_LIGHT,
+		B_TRANSLATE_MARK("Fog")}},
+	{48, 49, {ICON_SMOKY, ICON_SMOKY, SEVERITY_MODERATE,
+		B_TRANSLATE_MARK("Depositing rime fog")}},
+	{50, 51, {ICON_LIGHT_DRIZZLE, ICON_LIGHT_DRIZZLE, SEVERITY_LIGHT,
+		B_TRANSLATE_MARK("Light drizzle")}},
+	{52, 53, {ICON_MODERATE_DENSE_DRIZZLE, ICON_MODERATE_DENSE_DRIZZLE,
+		SEVERITY_LIGHT, B_TRANSLATE_MARK("Moderate drizzle")}},
+	{54, 55, {ICON_MODERATE_DENSE_DRIZZLE, ICON_MODERATE_DENSE_DRIZZLE,
+		SEVERITY_MODERATE, B_TRANSLATE_MARK("Dense drizzle")}},
+	{56, 56, {ICON_FREEZING_DRIZZLE, ICON_FREEZING_DRIZZLE, SEVERITY_MODERATE,
+		B_TRANSLATE_MARK("Freezing light drizzle")}},
+	{57, 57, {ICON_FREEZING_DRIZZLE, ICON_FREEZING_DRIZZLE, SEVERITY_MODERATE,
+		B_TRANSLATE_MARK("Freezing dense drizzle")}},
+	{58, 59, {ICON_RAINING_SCATTERED, ICON_RAINING_SCATTERED, SEVERITY_LIGHT,
+		B_TRANSLATE_MARK("Drizzle and rain")}},
+	{60, 61, {ICON_RAINING_SCATTERED, ICON_RAINING_SCATTERED, SEVERITY_LIGHT,
+		B_TRANSLATE_MARK("Slight rain")}},
+	{62, 63, {ICON_RAINING, ICON_RAINING, SEVERITY_MODERATE,
+		B_TRANSLATE_MARK("Moderate rain")}},
+	{64, 65, {ICON_ISOLATED_THUNDERSHOWERS, ICON_ISOLATED_THUNDERSHOWERS,
+		SEVERITY_SEVERE, B_TRANSLATE_MARK("Heavy rain")}},
+	{66, 66, {ICON_MIXED_SNOW_RAIN, ICON_MIXED_SNOW_RAIN, SEVERITY_MODERATE,
+		B_TRANSLATE_MARK("Light freezing rain")}},
+	{67, 67, {ICON_SNOW, ICON_SNOW, SEVERITY_SEVERE,
+		B_TRANSLATE_MARK("Heavy freezing rain")}},
+	{68, 69, {ICON_MIXED_SNOW_RAIN, ICON_MIXED_SNOW_RAIN, SEVERITY_MODERATE,
+		B_TRANSLATE_MARK("Rain and snow")}},
+	{70, 71, {ICON_SNOW_SHOWERS, ICON_SNOW_SHOWERS, SEVERITY_LIGHT,
+		B_TRANSLATE_MARK("Slight snow fall")}},
+	{72, 73, {ICON_SCATTERED_SNOW_SHOWERS, ICON_SCATTERED_SNOW_SHOWERS,
+		SEVERITY_MODERATE, B_TRANSLATE_MARK("Moderate snow fall")}},
+	{74, 75, {ICON_SNOW, ICON_SNOW, SEVERITY_SEVERE,
+		B_TRANSLATE_MARK("Heavy snow fall")}},
+	{76, 77, {ICON_MIXED_SNOW_RAIN, ICON_MIXED_SNOW_RAIN, SEVERITY_LIGHT,
+		B_TRANSLATE_MARK("Snow grains")}},
+	{78, 79, {ICON_MIXED_SNOW_RAIN, ICON_MIXED_SNOW_RAIN, SEVERITY_MODERATE,
+		B_TRANSLATE_MARK("Ice pellets")}},
+	{80, 80, {ICON_RAINING_SCATTERED, ICON_RAINING_SCATTERED, SEVERITY_LIGHT,
+		B_TRANSLATE_MARK("Slight rain showers")}},
+	{81, 81, {ICON_ISOLATED_THUNDERSHOWERS, ICON_ISOLATED_THUNDERSHOWERS,
+		SEVERITY_MODERATE, B_TRANSLATE_MARK("Moderate rain showers")}},
+	{82, 82, {ICON_ISOLATED_THUNDERSHOWERS, ICON_ISOLATED_THUNDERSHOWERS,
+		SEVERITY_SEVERE, B_TRANSLATE_MARK("Heavy rain showers")}},
+	{83, 84, {ICON_MIXED_SNOW_RAIN, ICON_MIXED_SNOW_RAIN, SEVERITY_MODERATE,
+		B_TRANSLATE_MARK("Rain and snow showers")}},
+	{85, 85, {ICON_SCATTERED_SNOW_SHOWERS, ICON_SCATTERED_SNOW_SHOWERS,
+		SEVERITY_LIGHT, B_TRANSLATE_MARK("Slight snow showers")}},
+	{86, 86, {ICON_SNOW_SHOWERS, ICON_SNOW_SHOWERS, SEVERITY_SEVERE,
+		B_TRANSLATE_MARK("Heavy snow showers")}},
+	{87, 90, {ICON_ALERT, ICON_ALERT, SEVERITY_SEVERE,
+		B_TRANSLATE_MARK("Hail showers")}},
+	{91, 95, {ICON_ISOLATED_THUNDERSTORM, ICON_ISOLATED_THUNDERSTORM,
+		SEVERITY_SEVERE, B_TRANSLATE_MARK("Thunderstorm")}},
+	{96, 96, {ICON_ALERT, ICON_ALERT, SEVERITY_SEVERE,
+		B_TRANSLATE_MARK("Thunderstorm with slight hail")}},
+	{97, 98, {ICON_SEVERE_THUNDERSTORM, ICON_SEVERE_THUNDERSTORM,
+		SEVERITY_SEVERE, B_TRANSLATE_MARK("Heavy thunderstorm")}},
+	{99, 99, {ICON_SEVERE_THUNDERSTORM, ICON_SEVERE_THUNDERSTORM,
+		SEVERITY_SEVERE, B_TRANSLATE_MARK("Thunderstorm with heavy hail")}}
+};
+
+static constexpr int32 kConditionRangeCount
+	= sizeof(kConditionRanges) / sizeof(kConditionRanges[0]);
+
+// Everything else, the last entry of the table
+static constexpr weather_condition kUnknownCondition = {ICON_ALERT, ICON_ALERT,
+	SEVERITY_NONE, B_TRANSLATE_MARK("Not available")};
+
+
+static constexpr bool
+_CoversAllCodes()
+{
+	// The ranges must follow each other without gap nor overlap
+	int32 next = 0;
+	for (int32 i = 0; i < kConditionRangeCount; i++) {
+		const condition_range& range = kConditionRanges[i];
+		if (range.first != next || range.last < range.first)
+			return false;
+		if (range.condition.icon >= kWeatherIconCount
+			|| range.condition.nightIcon >= kWeatherIconCount
+			|| range.condition.text == NULL)
+			return false;
+		next = range.last + 1;
+	}
+	return next == kWeatherCodeCount;
+}
+
+static_assert(_CoversAllCodes(),
+	"every WMO weather code from 0 to 99 needs exactly one condition");
+
+
+struct condition_table {
+	weather_condition	conditions[kWeatherCodeCount + 1];
+};
+
+
+static constexpr condition_table
+_BuildConditionTable()
+{
+	condition_table table = {};
+	for (int32 i = 0; i < kConditionRangeCount; i++) {
+		const condition_range& range = kConditionRanges[i];
+		for (int32 code = range.first; code <= range.last; code++)
+			table.conditions[code] = range.condition;
+	}
+	table.conditions[kWeatherCodeCount] = kUnknownCondition;
+	return table;
+}
+
+static constexpr condition_table kConditionTable = _BuildConditionTable();
+
+
+const weather_condition&
+WeatherCondition(int32 code)
+{
+	// A single unsigned compare also catches negative codes
+	uint32 index = (uint32)code < (uint32)kWeatherCodeCount
+		? (uint32)code : (uint32)kWeatherCodeCount;
+	return kConditionTable.conditions[index];
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef _WEATHERCONDITION_H_
+#define _WEATHERCONDITION_H_
+
+
+#include "CoreDefs.h"
+
+
+// The artwork in the application resources, see IconAtlas
+enum weather_icon {
+	ICON_ALERT = 0,
+	ICON_CLEAR_NIGHT,
+	ICON_CLEAR,
+	ICON_CLOUDS,
+	ICON_COLD,
+	ICON_LIGHT_DRIZZLE,
+	ICON_MODERATE_DENSE_DRIZZLE,
+	ICON_FEW_CLOUDS,
+	ICON_FOG,
+	ICON_FREEZING_DRIZZLE,
+	ICON_ISOLATED_THUNDERSTORM,
+	ICON_LIGHT_SNOW,
+	ICON_MIXED_SNOW_RAIN,
+	ICON_MOSTLY_CLOUDY_NIGHT,
+	ICON_NIGHT_FEW_CLOUDS,
+	ICON_RAINING_SCATTERED,
+	ICON_RAINING,
+	ICON_SEVERE_THUNDERSTORM,
+	ICON_ISOLATED_THUNDERSHOWERS,
+	ICON_SHINING,
+	ICON_SHINY,
+	ICON_SNOW,
+	ICON_STORM,
+	ICON_THUNDER,
+	ICON_TORNADO,
+	ICON_TROPICAL_STORM,
+	ICON_CLOUD,
+	ICON_PARTLY_CLOUDY,
+	ICON_HURRICANE,
+	ICON_SMOKY,
+	ICON_SCATTERED_SNOW_SHOWERS,
+	ICON_SNOW_SHOWERS,
+
+	kWeatherIconCount
+};
+
+
+// WMO 4677 weather interpretation codes, as sent by Open-Meteo
+const int32 kWeatherCodeCount = 100;
+
+enum condition_severity {
+	SEVERITY_NONE = 0,
+	SEVERITY_LIGHT,
+	SEVERITY_MODERATE,
+	SEVERITY_SEVERE
+};
+
+struct weather_condition {
+	weather_icon		icon;
+	weather_icon		nightIcon;
+	condition_severity	severity;
+	// Untranslated, look it up with B_TRANSLATE_NOCOLLECT() in the
+	// "ForecastView" context
+	const char*			text;
+};
+
+
+// Codes outside of 0 - 99 get a "Not available" condition
+const weather_condition& WeatherCondition(int32 code);
+
+
+#endif // _WEATHERCONDITION_H_
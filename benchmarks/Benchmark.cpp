@@ -0,0 +1,531 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+// Times the way from a received Open-Meteo response to what the views draw,
+// on the synthetic responses of the corpus directory, which
+// tools/MakeCorpus writes:
+//	decode/		the streaming decoder alone, fed like HttpSession does
+//	process/	WSOpenMeteo the way the download thread runs it: decoding,
+//				building the snapshots and the replies
+//	snapshot/	building a ForecastSnapshot from decoded data
+//	icons/		looking up the icon of every day and hour in the atlas
+//
+// Every case prints the median time per operation of several runs, and
+// the bytes and number of C++ allocations (operator new) of one operation;
+// malloc() calls, like the ones of BMessage, aren't counted. The output is
+// tab separated. Given the output of an earlier run with --baseline, the
+// change of the time is shown as well.
+
+#include <Application.h>
+#include <File.h>
+#include <Message.h>
+#include <Path.h>
+#include <String.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <new>
+
+#include "ForecastSnapshot.h"
+#include "IconAtlas.h"
+#include "OpenMeteoDecoder.h"
+#include "WeatherCondition.h"
+#include "WSOpenMeteo.h"
+
+
+// IconAtlas falls back to the resources of the installed application
+const char* kSignature = "application/x-vnd.przemub.Weather";
+
+static const char* kBenchmarkSignature
+	= "application/x-vnd.przemub.Weather-benchmark";
+
+// Like the receive buffer of HttpSession
+static const size_t kChunkSize = 16384;
+
+static const bigtime_t kMinRunTime = 100000;
+static const int32 kRuns = 7;
+
+
+enum response_kind {
+	FORECAST_RESPONSE,
+	CITY_RESPONSE
+};
+
+struct corpus_entry {
+	const char*		name;
+	response_kind	kind;
+	int32			locations;
+};
+
+// The locations of a batch are the ones the response was made for
+static const corpus_entry kCorpus[] = {
+	{ "forecast-hourly-1d", FORECAST_RESPONSE, 1 },
+	{ "forecast-hourly-16d", FORECAST_RESPONSE, 1 },
+	{ "forecast-batch-4x16d", FORECAST_RESPONSE, 4 },
+	{ "geocoding-10", CITY_RESPONSE, 0 },
+	{ "geocoding-100", CITY_RESPONSE, 0 }
+};
+static const int32 kCorpusCount = sizeof(kCorpus) / sizeof(kCorpus[0]);
+
+
+struct corpus_file {
+	const corpus_entry* entry;
+	char*			data;
+	size_t			size;
+	OpenMeteoDecoder* decoder;
+	forecast_location* locations;
+
+	ForecastSnapshot** snapshots;
+	int32			snapshotCount;
+	int32*			codes;
+	int32			codeCount;
+	int32			largeCodeCount;
+		// the first codes, looked up in the large size
+	IconAtlas*		atlas;
+};
+
+typedef void (*benchmark_function)(corpus_file& file);
+
+
+static uint64 sAllocations = 0;
+static uint64 sAllocatedBytes = 0;
+
+
+// #pragma mark - Allocation counting
+
+
+static void*
+counted_malloc(size_t size)
+{
+	sAllocations++;
+	sAllocatedBytes += size;
+	return malloc(size > 0 ? size : 1);
+}
+
+
+void*
+operator new(size_t size)
+{
+	void* memory = counted_malloc(size);
+	if (memory == NULL)
+		throw std::bad_alloc();
+	return memory;
+}
+
+
+void*
+operator new[](size_t size)
+{
+	void* memory = counted_malloc(size);
+	if (memory == NULL)
+		throw std::bad_alloc();
+	return memory;
+}
+
+
+void*
+operator new(size_t size, const std::nothrow_t&) throw()
+{
+	return counted_malloc(size);
+}
+
+
+void*
+operator new[](size_t size, const std::nothrow_t&) throw()
+{
+	return counted_malloc(size);
+}
+
+
+void
+operator delete(void* memory) throw()
+{
+	free(memory);
+}
+
+
+void
+operator delete[](void* memory) throw()
+{
+	free(memory);
+}
+
+
+void
+operator delete(void* memory, size_t) throw()
+{
+	free(memory);
+}
+
+
+void
+operator delete[](void* memory, size_t) throw()
+{
+	free(memory);
+}
+
+
+void
+operator delete(void* memory, const std::nothrow_t&) throw()
+{
+	free(memory);
+}
+
+
+void
+operator delete[](void* memory, const std::nothrow_t&) throw()
+{
+	free(memory);
+}
+
+
+// #pragma mark - Cases
+
+
+static status_t
+feed_decoder(OpenMeteoDecoder& decoder, const corpus_file& file)
+{
+	decoder.Reset();
+	for (size_t offset = 0; offset < file.size; offset += kChunkSize) {
+		status_t status = decoder.Feed(file.data + offset,
+			std::min(kChunkSize, file.size - offset));
+		if (status != B_OK)
+			return status;
+	}
+	return decoder.Finish();
+}
+
+
+static void
+benchmark_decode(corpus_file& file)
+{
+	feed_decoder(*file.decoder, file);
+}
+
+
+static void
+benchmark_process(corpus_file& file)
+{
+	// The replies go nowhere, sending them isn't measured
+	bool forecast = file.entry->kind == FORECAST_RESPONSE;
+	WSOpenMeteo listener(BMessenger(),
+		forecast ? WEATHER_REQUEST : CITY_REQUEST);
+	if (forecast)
+		listener.SetLocations(file.locations, file.entry->locations, CELSIUS);
+
+	for (size_t offset = 0; offset < file.size; offset += kChunkSize) {
+		if (listener.DataReceived(file.data + offset,
+				std::min(kChunkSize, file.size - offset)) != B_OK)
+			break;
+	}
+
+	http_timing timing;
+	memset(&timing, 0, sizeof(timing));
+	listener.RequestCompleted(B_OK, timing, 0);
+}
+
+
+static int64
+snapshot_time(const forecast_data& data)
+{
+	// The first hour of the response, so that the result doesn't depend on the
+	// clock
+	return data.hourly.count > 0 ? data.hourly.startTime : data.current.time;
+}
+
+
+static void
+benchmark_snapshot(corpus_file& file)
+{
+	ForecastDecoder* decoder = static_cast<ForecastDecoder*>(file.decoder);
+	for (int32 i = 0; i < decoder->CountForecasts(); i++) {
+		const forecast_data& data = decoder->ForecastAt(i);
+		ForecastSnapshot* snapshot = new(std::nothrow) ForecastSnapshot(data,
+			snapshot_time(data), snapshot_time(data));
+		if (snapshot != NULL)
+			snapshot->ReleaseReference();
+	}
+}
+
+
+static void
+benchmark_icons(corpus_file& file)
+{
+	uint32 smallSize = (uint32) (kSizeSmallIcon * IconAtlas::ScaleFactor());
+	uint32 largeSize = (uint32) (kSizeLargeIcon * IconAtlas::ScaleFactor());
+
+	for (int32 i = 0; i < file.codeCount; i++) {
+		const weather_condition& condition = WeatherCondition(file.codes[i]);
+		atlas_icon icon;
+		file.atlas->GetIcon(condition.icon,
+			i < file.largeCodeCount ? largeSize : smallSize, icon);
+	}
+}
+
+
+// #pragma mark - Setup
+
+
+static status_t
+load_file(const char* directory, const corpus_entry& entry, corpus_file& file)
+{
+	memset(&file, 0, sizeof(file));
+	file.entry = &entry;
+
+	BPath path(directory);
+	BString name(entry.name);
+	name << ".json";
+	status_t status = path.Append(name.String());
+	if (status != B_OK)
+		return status;
+
+	BFile input(path.Path(), B_READ_ONLY);
+	off_t size;
+	status = input.GetSize(&size);
+	if (status != B_OK)
+		return status;
+
+	file.data = static_cast<char*>(malloc(size));
+	if (file.data == NULL)
+		return B_NO_MEMORY;
+	file.size = size;
+	if (input.ReadAt(0, file.data, size) != size)
+		return B_IO_ERROR;
+
+	if (entry.kind == FORECAST_RESPONSE) {
+		file.decoder = new(std::nothrow) ForecastDecoder(entry.locations);
+		file.locations = new(std::nothrow) forecast_location[entry.locations];
+		if (file.locations == NULL)
+			return B_NO_MEMORY;
+		for (int32 i = 0; i < entry.locations; i++) {
+			file.locations[i].latitude = 0;
+			file.locations[i].longitude = 0;
+		}
+	} else
+		file.decoder = new(std::nothrow) CityDecoder();
+	if (file.decoder == NULL)
+		return B_NO_MEMORY;
+
+	status = feed_decoder(*file.decoder, file);
+	if (status != B_OK) {
+		fprintf(stderr, "%s: not decoded at offset %" B_PRIuSIZE ": %s\n",
+			entry.name, file.decoder->Offset(), strerror(status));
+		return status;
+	}
+	if (entry.kind != FORECAST_RESPONSE)
+		return B_OK;
+
+	// What the views look icons up for: the current conditions in the
+	// large size, then the days and the hours
+	ForecastDecoder* decoder = static_cast<ForecastDecoder*>(file.decoder);
+	int32 forecasts = decoder->CountForecasts();
+	file.snapshots = new(std::nothrow) ForecastSnapshot*[forecasts];
+	file.codes = new(std::nothrow) int32[forecasts
+		* (1 + kMaxForecastDays + kMaxForecastHours)];
+	if (file.snapshots == NULL || file.codes == NULL)
+		return B_NO_MEMORY;
+
+	for (int32 i = 0; i < forecasts; i++) {
+		const forecast_data& data = decoder->ForecastAt(i);
+		ForecastSnapshot* snapshot = new(std::nothrow) ForecastSnapshot(data,
+			snapshot_time(data), snapshot_time(data));
+		if (snapshot == NULL)
+			return B_NO_MEMORY;
+		file.snapshots[file.snapshotCount++] = snapshot;
+
+		if (snapshot->HasCurrentWeather())
+			file.codes[file.codeCount++] = snapshot->Condition();
+	}
+	file.largeCodeCount = file.codeCount;
+
+	for (int32 i = 0; i < file.snapshotCount; i++) {
+		ForecastSnapshot* snapshot = file.snapshots[i];
+		for (int32 day = 0; day < snapshot->CountDays(); day++)
+			file.codes[file.codeCount++] = snapshot->DayCondition(day);
+
+		const hourly_weather& hourly = snapshot->Data().hourly;
+		for (int32 hour = 0; hour < hourly.count; hour++) {
+			float code = hourly.values[HOURLY_WEATHER_CODE][hour];
+			if (!isnan(code))
+				file.codes[file.codeCount++] = (int32) code;
+		}
+	}
+
+	file.atlas = IconAtlas::Acquire();
+	return B_OK;
+}
+
+
+static void
+unload_file(corpus_file& file)
+{
+	for (int32 i = 0; i < file.snapshotCount; i++)
+		file.snapshots[i]->ReleaseReference();
+	delete[] file.snapshots;
+	delete[] file.codes;
+	delete[] file.locations;
+	delete file.decoder;
+	free(file.data);
+	if (file.atlas != NULL)
+		IconAtlas::Release(file.atlas);
+}
+
+
+static status_t
+load_baseline(const char* path, BMessage& baseline)
+{
+	BFile input(path, B_READ_ONLY);
+	off_t size;
+	status_t status = input.GetSize(&size);
+	if (status != B_OK)
+		return status;
+
+	BString text;
+	char* buffer = text.LockBuffer(size + 1);
+	ssize_t bytesRead = input.ReadAt(0, buffer, size);
+	text.UnlockBuffer(bytesRead >= 0 ? bytesRead : 0);
+
+	// name<tab>ns/op<tab>...
+	int32 start = 0;
+	while (start < text.Length()) {
+		int32 end = text.FindFirst('\n', start);
+		if (end < 0)
+			end = text.Length();
+
+		BString line(text.String() + start, end - start);
+		int32 tab = line.FindFirst('\t');
+		if (!line.StartsWith("#") && tab > 0) {
+			BString name(line.String(), tab);
+			baseline.AddDouble(name.String(),
+				strtod(line.String() + tab + 1, NULL));
+		}
+		start = end + 1;
+	}
+	return B_OK;
+}
+
+
+// #pragma mark - Running
+
+
+static void
+run_case(const char* prefix, benchmark_function function, corpus_file& file,
+	const BMessage& baseline)
+{
+	BString name(prefix);
+	name << "/" << file.entry->name;
+
+	// Warm up, and find an iteration count that runs long enough to be
+	// measured well
+	function(file);
+	int32 iterations = 1;
+	for (;;) {
+		bigtime_t start = system_time();
+		for (int32 i = 0; i < iterations; i++)
+			function(file);
+		if (system_time() - start >= kMinRunTime || iterations >= 1 << 24)
+			break;
+		iterations *= 2;
+	}
+
+	double times[kRuns];
+	for (int32 run = 0; run < kRuns; run++) {
+		bigtime_t start = system_time();
+		for (int32 i = 0; i < iterations; i++)
+			function(file);
+		times[run] = (system_time() - start) * 1000.0 / iterations;
+	}
+	std::sort(times, times + kRuns);
+	double nanoseconds = times[kRuns / 2];
+
+	uint64 allocations = sAllocations;
+	uint64 allocatedBytes = sAllocatedBytes;
+	function(file);
+	allocations = sAllocations - allocations;
+	allocatedBytes = sAllocatedBytes - allocatedBytes;
+
+	printf("%s\t%.0f\t%" B_PRIu64 "\t%" B_PRIu64, name.String(), nanoseconds,
+		allocatedBytes, allocations);
+
+	double previous;
+	if (baseline.FindDouble(name.String(), &previous) == B_OK
+		&& previous > 0)
+		printf("\t%+.1f%%", (nanoseconds - previous) * 100 / previous);
+	printf("\n");
+	fflush(stdout);
+}
+
+
+static void
+usage(const char* program)
+{
+	fprintf(stderr, "Usage: %s [--corpus <directory>] [--baseline <file>] "
+		"[--filter <text>]\n", program);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	const char* corpus = "corpus";
+	const char* baselinePath = NULL;
+	const char* filter = NULL;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--corpus") == 0 && i + 1 < argc)
+			corpus = argv[++i];
+		else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+			baselinePath = argv[++i];
+		else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			filter = argv[++i];
+		else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	// The icon atlas needs the application server
+	BApplication app(kBenchmarkSignature);
+
+	BMessage baseline;
+	if (baselinePath != NULL && load_baseline(baselinePath, baseline) != B_OK) {
+		fprintf(stderr, "Could not read the baseline %s\n", baselinePath);
+		return 1;
+	}
+
+	printf("# name\tns/op\tbytes/op\tallocs/op%s\n",
+		baselinePath != NULL ? "\tchange" : "");
+
+	int result = 0;
+	for (int32 i = 0; i < kCorpusCount; i++) {
+		if (filter != NULL && strstr(kCorpus[i].name, filter) == NULL)
+			continue;
+
+		corpus_file file;
+		status_t status = load_file(corpus, kCorpus[i], file);
+		if (status != B_OK) {
+			fprintf(stderr, "%s: %s\n", kCorpus[i].name, strerror(status));
+			unload_file(file);
+			result = 1;
+			continue;
+		}
+
+		run_case("decode", &benchmark_decode, file, baseline);
+		run_case("process", &benchmark_process, file, baseline);
+		if (kCorpus[i].kind == FORECAST_RESPONSE) {
+			run_case("snapshot", &benchmark_snapshot, file, baseline);
+			if (file.atlas != NULL)
+				run_case("icons", &benchmark_icons, file, baseline);
+		}
+
+		unload_file(file);
+	}
+
+	return result;
+}
@@ -0,0 +1,420 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+// Builds the offline place index read by PlaceIndex from a GeoNames dump
+// (https://download.geonames.org/export/dump/), e.g. cities500.txt, and the
+// matching admin1CodesASCII.txt, admin2Codes.txt and countryInfo.txt.
+// GeoNames publishes no admin3 names, but a file in the admin2Codes.txt
+// format ("CC.A1.A2.A3<tab>name") can be given for them.
+//
+// This is a host tool: it uses only the C++ standard library and the case
+// folding of the core, so the index can be built on any platform and then
+// bundled with the application.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../Source/PlaceIndexFormat.h"
+#include "../Source/core/CaseFold.h"
+
+
+struct place {
+	place_index_place	record;
+	std::string			keys[2];
+};
+
+
+struct key_entry {
+	std::string			key;
+	uint32_t			place;
+
+	bool operator<(const key_entry& other) const
+	{
+		if (key != other.key)
+			return key < other.key;
+		return place < other.place;
+	}
+};
+
+
+typedef std::map<std::string, std::string> name_map;
+
+
+static std::vector<place> sPlaces;
+static std::vector<key_entry> sKeys;
+static std::vector<place_index_node> sNodes;
+static std::vector<uint32_t> sTop;
+static std::string sLabels;
+static std::string sStrings;
+static std::map<std::string, uint32_t> sStringOffsets;
+
+
+static void
+split(const std::string& line, std::vector<std::string>& fields)
+{
+	fields.clear();
+	size_t start = 0;
+	for (;;) {
+		size_t end = line.find('\t', start);
+		if (end == std::string::npos) {
+			fields.push_back(line.substr(start));
+			return;
+		}
+		fields.push_back(line.substr(start, end - start));
+		start = end + 1;
+	}
+}
+
+
+static bool
+read_line(FILE* file, std::string& line)
+{
+	line.clear();
+	int c;
+	while ((c = fgetc(file)) != EOF) {
+		if (c == '\n')
+			return true;
+		if (c != '\r')
+			line += (char) c;
+	}
+	return !line.empty();
+}
+
+
+// Reads "code<tab>name..." files, like admin1CodesASCII.txt
+static bool
+read_names(const char* path, name_map& names)
+{
+	FILE* file = fopen(path, "r");
+	if (file == NULL) {
+		fprintf(stderr, "Could not open %s\n", path);
+		return false;
+	}
+
+	std::string line;
+	std::vector<std::string> fields;
+	while (read_line(file, line)) {
+		split(line, fields);
+		if (fields.size() >= 2)
+			names[fields[0]] = fields[1];
+	}
+	fclose(file);
+	return true;
+}
+
+
+// countryInfo.txt maps the ISO code to the name and the GeoNames id, which
+// is what Open-Meteo reports as country_id
+static bool
+read_countries(const char* path, name_map& names, std::map<std::string,
+	int32_t>& ids)
+{
+	FILE* file = fopen(path, "r");
+	if (file == NULL) {
+		fprintf(stderr, "Could not open %s\n", path);
+		return false;
+	}
+
+	std::string line;
+	std::vector<std::string> fields;
+	while (read_line(file, line)) {
+		if (line.empty() || line[0] == '#')
+			continue;
+		split(line, fields);
+		if (fields.size() < 17)
+			continue;
+		names[fields[0]] = fields[4];
+		ids[fields[0]] = atoi(fields[16].c_str());
+	}
+	fclose(file);
+	return true;
+}
+
+
+static std::string
+lookup(const name_map& names, const std::string& code)
+{
+	name_map::const_iterator found = names.find(code);
+	return found != names.end() ? found->second : std::string();
+}
+
+
+// PlaceIndex::Search() folds the queries the same way
+static std::string
+normalize(const std::string& name)
+{
+	std::string key(name);
+	key.resize(FoldCase(name.data(), name.size(), &key[0]));
+	return key;
+}
+
+
+static uint32_t
+add_string(const std::string& string)
+{
+	std::map<std::string, uint32_t>::iterator found
+		= sStringOffsets.find(string);
+	if (found != sStringOffsets.end())
+		return found->second;
+
+	uint32_t offset = sStrings.size();
+	sStrings.append(string);
+	sStrings += '\0';
+	sStringOffsets[string] = offset;
+	return offset;
+}
+
+
+static bool
+more_populous(uint32_t a, uint32_t b)
+{
+	uint32_t populationA = sPlaces[a].record.population;
+	uint32_t populationB = sPlaces[b].record.population;
+	if (populationA != populationB)
+		return populationA > populationB;
+	return a < b;
+}
+
+
+static void
+set_top(place_index_node& node, std::vector<uint32_t>& candidates)
+{
+	std::sort(candidates.begin(), candidates.end(), more_populous);
+	candidates.erase(std::unique(candidates.begin(), candidates.end()),
+		candidates.end());
+	if (candidates.size() > PLACE_INDEX_TOP_PLACES)
+		candidates.resize(PLACE_INDEX_TOP_PLACES);
+
+	node.firstTop = sTop.size();
+	node.topCount = candidates.size();
+	sTop.insert(sTop.end(), candidates.begin(), candidates.end());
+}
+
+
+// Builds the node for the sorted keys [begin, end), which share their
+// first depth bytes. Its children get consecutive slots.
+static void
+build_node(uint32_t index, size_t begin, size_t end, size_t depth)
+{
+	std::vector<uint32_t> candidates;
+
+	// Places whose name ends here come first in sort order
+	size_t i = begin;
+	for (; i < end && sKeys[i].key.size() == depth; i++)
+		candidates.push_back(sKeys[i].place);
+
+	std::vector<size_t> groups;
+	for (size_t j = i; j < end; j++) {
+		if (j == i || sKeys[j].key[depth] != sKeys[j - 1].key[depth])
+			groups.push_back(j);
+	}
+	groups.push_back(end);
+
+	uint32_t childCount = groups.size() - 1;
+	uint32_t firstChild = sNodes.size();
+	sNodes.resize(sNodes.size() + childCount);
+	sNodes[index].firstChild = firstChild;
+	sNodes[index].childCount = childCount;
+
+	for (uint32_t child = 0; child < childCount; child++) {
+		size_t groupBegin = groups[child];
+		size_t groupEnd = groups[child + 1];
+
+		// Sorted keys: the common prefix of the group is the one of its
+		// first and last key
+		const std::string& first = sKeys[groupBegin].key;
+		const std::string& last = sKeys[groupEnd - 1].key;
+		size_t common = depth;
+		while (common < first.size() && common < last.size()
+			&& first[common] == last[common])
+			common++;
+
+		place_index_node& node = sNodes[firstChild + child];
+		memset(&node, 0, sizeof(node));
+		node.labelOffset = sLabels.size();
+		node.labelLength = common - depth;
+		sLabels.append(first, depth, common - depth);
+
+		build_node(firstChild + child, groupBegin, groupEnd, common);
+
+		const place_index_node& built = sNodes[firstChild + child];
+		candidates.insert(candidates.end(), sTop.begin() + built.firstTop,
+			sTop.begin() + built.firstTop + built.topCount);
+	}
+
+	set_top(sNodes[index], candidates);
+}
+
+
+static bool
+write_section(FILE* file, const void* data, size_t size, uint32_t& offset)
+{
+	// Sections start 8 byte aligned
+	long position = ftell(file);
+	while (position % 8 != 0) {
+		fputc(0, file);
+		position++;
+	}
+	offset = position;
+	return size == 0 || fwrite(data, size, 1, file) == 1;
+}
+
+
+static void
+usage()
+{
+	fprintf(stderr, "Usage: BuildPlaceIndex [--countries countryInfo.txt] "
+		"[--admin1 admin1CodesASCII.txt]\n"
+		"\t[--admin2 admin2Codes.txt] [--admin3 file] [--min-population n]\n"
+		"\tcities.txt output\n");
+	exit(1);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	name_map countries, admin1, admin2, admin3;
+	std::map<std::string, int32_t> countryIds;
+	uint32_t minPopulation = 0;
+
+	int argument = 1;
+	for (; argument + 1 < argc && argv[argument][0] == '-'; argument += 2) {
+		const char* option = argv[argument];
+		const char* value = argv[argument + 1];
+		bool success = true;
+		if (strcmp(option, "--countries") == 0)
+			success = read_countries(value, countries, countryIds);
+		else if (strcmp(option, "--admin1") == 0)
+			success = read_names(value, admin1);
+		else if (strcmp(option, "--admin2") == 0)
+			success = read_names(value, admin2);
+		else if (strcmp(option, "--admin3") == 0)
+			success = read_names(value, admin3);
+		else if (strcmp(option, "--min-population") == 0)
+			minPopulation = strtoul(value, NULL, 10);
+		else
+			usage();
+		if (!success)
+			return 1;
+	}
+	if (argument + 2 != argc)
+		usage();
+
+	FILE* input = fopen(argv[argument], "r");
+	if (input == NULL) {
+		fprintf(stderr, "Could not open %s\n", argv[argument]);
+		return 1;
+	}
+
+	std::string line;
+	std::vector<std::string> fields;
+	while (read_line(input, line)) {
+		split(line, fields);
+		if (fields.size() < 15)
+			continue;
+
+		uint32_t population = strtoul(fields[14].c_str(), NULL, 10);
+		if (population < minPopulation)
+			continue;
+
+		const std::string& countryCode = fields[8];
+		std::string admin1Code = countryCode + "." + fields[10];
+		std::string admin2Code = admin1Code + "." + fields[11];
+		std::string admin3Code = admin2Code + "." + fields[12];
+
+		place entry;
+		memset(&entry.record, 0, sizeof(entry.record));
+		entry.record.id = atoi(fields[0].c_str());
+		entry.record.latitude = atof(fields[4].c_str());
+		entry.record.longitude = atof(fields[5].c_str());
+		entry.record.population = population;
+		entry.record.name = add_string(fields[1]);
+
+		std::string country = lookup(countries, countryCode);
+		entry.record.country = add_string(country.empty()
+			? countryCode : country);
+		std::map<std::string, int32_t>::iterator countryId
+			= countryIds.find(countryCode);
+		if (countryId != countryIds.end())
+			entry.record.countryId = countryId->second;
+
+		entry.record.admin1 = add_string(lookup(admin1, admin1Code));
+		entry.record.admin2 = add_string(lookup(admin2, admin2Code));
+		entry.record.admin3 = add_string(lookup(admin3, admin3Code));
+
+		// The ASCII name makes "zurich" find Zürich
+		entry.keys[0] = normalize(fields[1]);
+		entry.keys[1] = normalize(fields[2]);
+		sPlaces.push_back(entry);
+	}
+	fclose(input);
+
+	for (uint32_t i = 0; i < sPlaces.size(); i++) {
+		for (int k = 0; k < 2; k++) {
+			if (sPlaces[i].keys[k].empty()
+				|| (k == 1 && sPlaces[i].keys[1] == sPlaces[i].keys[0]))
+				continue;
+			key_entry key = { sPlaces[i].keys[k], i };
+			sKeys.push_back(key);
+		}
+	}
+	std::sort(sKeys.begin(), sKeys.end());
+
+	sNodes.resize(1);
+	memset(&sNodes[0], 0, sizeof(sNodes[0]));
+	build_node(0, 0, sKeys.size(), 0);
+
+	std::vector<place_index_place> records;
+	for (size_t i = 0; i < sPlaces.size(); i++)
+		records.push_back(sPlaces[i].record);
+
+	FILE* output = fopen(argv[argument + 1], "wb");
+	if (output == NULL) {
+		fprintf(stderr, "Could not create %s\n", argv[argument + 1]);
+		return 1;
+	}
+
+	place_index_header header;
+	memset(&header, 0, sizeof(header));
+	header.magic = PLACE_INDEX_MAGIC;
+	header.version = PLACE_INDEX_VERSION;
+	header.nodeCount = sNodes.size();
+	header.placeCount = records.size();
+	header.topCount = sTop.size();
+	header.labelsSize = sLabels.size();
+	header.stringsSize = sStrings.size();
+
+	// The header is written again once the offsets are known
+	bool success = fwrite(&header, sizeof(header), 1, output) == 1
+		&& write_section(output, sNodes.data(),
+			sNodes.size() * sizeof(place_index_node), header.nodesOffset)
+		&& write_section(output, sTop.data(), sTop.size() * sizeof(uint32_t),
+			header.topOffset)
+		&& write_section(output, records.data(),
+			records.size() * sizeof(place_index_place), header.placesOffset)
+		&& write_section(output, sLabels.data(), sLabels.size(),
+			header.labelsOffset)
+		&& write_section(output, sStrings.data(), sStrings.size(),
+			header.stringsOffset)
+		&& fseek(output, 0, SEEK_SET) == 0
+		&& fwrite(&header, sizeof(header), 1, output) == 1;
+
+	if (fclose(output) != 0 || !success) {
+		fprintf(stderr, "Could not write %s\n", argv[argument + 1]);
+		return 1;
+	}
+
+	printf("%zu places, %zu names, %zu nodes, %ld bytes\n", sPlaces.size(),
+		sKeys.size(), sNodes.size(), (long) (header.stringsOffset
+			+ header.stringsSize));
+	return 0;
+}
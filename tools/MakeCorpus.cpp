@@ -0,0 +1,666 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+// Writes the synthetic Open-Meteo responses of benchmarks/corpus/, which the
+// benchmark times and MockOpenMeteo serves:
+//	MakeCorpus ../benchmarks/corpus
+//
+// The forecasts answer the request Weather makes (hourly temperature,
+// precipitation probability and amount, weather code and day flag, in
+// unixtime, 16 days from 2026-04-17 local time). The weather is made up but
+// consistent: the temperature follows the time of day, it only rains or
+// snows in wet hours, and it snows only below freezing. The city searches
+// hold real places with their approximate coordinates, regions and time
+// zones; their ids are made up. The output is the same on every run.
+//
+// This is a host tool: it uses only the C++ standard library.
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+
+// 2026-04-17 00:00 UTC
+static const long kFirstDay = 1776384000;
+static const int kHoursPerDay = 24;
+
+
+struct forecast_place {
+	double				latitude;
+	double				longitude;
+	double				elevation;
+	const char*			timezone;
+	const char*			abbreviation;
+	long				utcOffset;
+	// Of the season: the daily mean temperature and the swing around it,
+	// and sunrise and sunset in local hours
+	double				meanTemperature;
+	double				dailySwing;
+	int					sunrise;
+	int					sunset;
+};
+
+
+struct country {
+	const char*			code;
+	const char*			name;
+	long				id;
+};
+
+
+struct city {
+	const char*			name;
+	const char*			admin1;
+	const char*			countryCode;
+	double				latitude;
+	double				longitude;
+	double				elevation;
+	long				population;
+	const char*			timezone;
+	bool				capital;
+};
+
+
+static const forecast_place kWarsaw = { 52.23, 21.01, 113,
+	"Europe/Warsaw", "CEST", 7200, 9, 5, 6, 20 };
+static const forecast_place kZurich = { 47.37, 8.55, 429,
+	"Europe/Zurich", "CEST", 7200, 10, 6, 7, 20 };
+static const forecast_place kSanFrancisco = { 37.77, -122.42, 16,
+	"America/Los_Angeles", "PDT", -25200, 14, 4, 7, 20 };
+static const forecast_place kTokyo = { 35.69, 139.69, 40,
+	"Asia/Tokyo", "JST", 32400, 15, 5, 5, 18 };
+static const forecast_place kSydney = { -33.87, 151.21, 58,
+	"Australia/Sydney", "AEST", 36000, 18, 4, 6, 17 };
+
+
+static const country kCountries[] = {
+	{ "AR", "Argentina", 3865483 },
+	{ "AT", "Austria", 2782113 },
+	{ "AU", "Australia", 2077456 },
+	{ "BD", "Bangladesh", 1210997 },
+	{ "BE", "Belgium", 2802361 },
+	{ "BR", "Brazil", 3469034 },
+	{ "CA", "Canada", 6251999 },
+	{ "CH", "Switzerland", 2658434 },
+	{ "CL", "Chile", 3895114 },
+	{ "CN", "China", 1814991 },
+	{ "CO", "Colombia", 3686110 },
+	{ "CZ", "Czechia", 3077311 },
+	{ "DE", "Germany", 2921044 },
+	{ "DK", "Denmark", 2623032 },
+	{ "EG", "Egypt", 357994 },
+	{ "ES", "Spain", 2510769 },
+	{ "FI", "Finland", 660013 },
+	{ "FR", "France", 3017382 },
+	{ "GB", "United Kingdom", 2635167 },
+	{ "GR", "Greece", 390903 },
+	{ "HR", "Croatia", 3202326 },
+	{ "HU", "Hungary", 719819 },
+	{ "ID", "Indonesia", 1643084 },
+	{ "IE", "Ireland", 2963597 },
+	{ "IN", "India", 1269750 },
+	{ "IR", "Iran", 130758 },
+	{ "IT", "Italy", 3175395 },
+	{ "JP", "Japan", 1861060 },
+	{ "KE", "Kenya", 192950 },
+	{ "KR", "South Korea", 1835841 },
+	{ "MA", "Morocco", 2542007 },
+	{ "MX", "Mexico", 3996063 },
+	{ "NG", "Nigeria", 2328926 },
+	{ "NL", "The Netherlands", 2750405 },
+	{ "NO", "Norway", 3144096 },
+	{ "NZ", "New Zealand", 2186224 },
+	{ "PE", "Peru", 3932488 },
+	{ "PH", "Philippines", 1694008 },
+	{ "PK", "Pakistan", 1168579 },
+	{ "PL", "Poland", 798544 },
+	{ "PT", "Portugal", 2264397 },
+	{ "RO", "Romania", 798549 },
+	{ "RU", "Russia", 2017370 },
+	{ "SA", "Saudi Arabia", 102358 },
+	{ "SE", "Sweden", 2661886 },
+	{ "SG", "Singapore", 1880251 },
+	{ "TH", "Thailand", 1605651 },
+	{ "TR", "Türkiye", 298795 },
+	{ "UA", "Ukraine", 690791 },
+	{ "US", "United States", 6252001 },
+	{ "VN", "Vietnam", 1562822 },
+	{ "ZA", "South Africa", 953987 }
+};
+
+
+// A search for a name many places share
+static const city kSpringfields[] = {
+	{ "Springfield", "Missouri", "US", 37.22, -93.30, 396, 169176,
+		"America/Chicago", false },
+	{ "Springfield", "Massachusetts", "US", 42.10, -72.59, 21, 155929,
+		"America/New_York", false },
+	{ "Springfield", "Illinois", "US", 39.80, -89.64, 183, 114394,
+		"America/Chicago", false },
+	{ "Springfield", "Oregon", "US", 44.05, -123.02, 139, 62256,
+		"America/Los_Angeles", false },
+	{ "Springfield", "Ohio", "US", 39.92, -83.81, 298, 58662,
+		"America/New_York", false },
+	{ "Springfield", "Virginia", "US", 38.79, -77.19, 66, 31339,
+		"America/New_York", false },
+	{ "Springfield", "Pennsylvania", "US", 39.93, -75.32, 64, 24211,
+		"America/New_York", false },
+	{ "Springfield", "Tennessee", "US", 36.51, -86.89, 213, 18782,
+		"America/Chicago", false },
+	{ "Springfield", "New Jersey", "US", 40.70, -74.32, 55, 17258,
+		"America/New_York", false },
+	{ "Springfield", "Vermont", "US", 43.30, -72.48, 127, 9062,
+		"America/New_York", false }
+};
+
+// The largest result list Open-Meteo returns, made of large cities
+static const city kLargeCities[] = {
+	{ "Tokyo", "Tokyo", "JP", 35.69, 139.69, 40, 8336599, "Asia/Tokyo",
+		true },
+	{ "Delhi", "NCT", "IN", 28.65, 77.23, 216, 10927986, "Asia/Kolkata",
+		false },
+	{ "Shanghai", "Shanghai", "CN", 31.22, 121.46, 12, 22315474,
+		"Asia/Shanghai", false },
+	{ "São Paulo", "São Paulo", "BR", -23.55, -46.64, 769, 10021295,
+		"America/Sao_Paulo", false },
+	{ "Mexico City", "Mexico City", "MX", 19.43, -99.13, 2240, 12294193,
+		"America/Mexico_City", true },
+	{ "Cairo", "Cairo", "EG", 30.06, 31.25, 23, 7734614, "Africa/Cairo",
+		true },
+	{ "Mumbai", "Maharashtra", "IN", 19.07, 72.88, 14, 12691836,
+		"Asia/Kolkata", false },
+	{ "Beijing", "Beijing", "CN", 39.91, 116.40, 49, 18960744,
+		"Asia/Shanghai", true },
+	{ "Dhaka", "Dhaka Division", "BD", 23.71, 90.41, 9, 10356500,
+		"Asia/Dhaka", true },
+	{ "Osaka", "Osaka", "JP", 34.69, 135.50, 12, 2592413, "Asia/Tokyo",
+		false },
+	{ "New York", "New York", "US", 40.71, -74.01, 10, 8804190,
+		"America/New_York", false },
+	{ "Karachi", "Sindh", "PK", 24.86, 67.01, 8, 11624219, "Asia/Karachi",
+		false },
+	{ "Buenos Aires", "Buenos Aires F.D.", "AR", -34.61, -58.38, 25,
+		13076300, "America/Argentina/Buenos_Aires", true },
+	{ "Istanbul", "Istanbul", "TR", 41.01, 28.95, 39, 14804116,
+		"Europe/Istanbul", false },
+	{ "Kolkata", "West Bengal", "IN", 22.57, 88.36, 9, 4631392,
+		"Asia/Kolkata", false },
+	{ "Manila", "Metro Manila", "PH", 14.60, 120.98, 13, 1600000,
+		"Asia/Manila", true },
+	{ "Lagos", "Lagos", "NG", 6.45, 3.39, 41, 9000000, "Africa/Lagos",
+		false },
+	{ "Rio de Janeiro", "Rio de Janeiro", "BR", -22.91, -43.18, 5, 6023699,
+		"America/Sao_Paulo", false },
+	{ "Moscow", "Moscow", "RU", 55.75, 37.62, 144, 10381222,
+		"Europe/Moscow", true },
+	{ "Los Angeles", "California", "US", 34.05, -118.24, 89, 3898747,
+		"America/Los_Angeles", false },
+	{ "Paris", "Île-de-France", "FR", 48.85, 2.35, 42, 2138551,
+		"Europe/Paris", true },
+	{ "London", "England", "GB", 51.51, -0.13, 25, 8961989,
+		"Europe/London", true },
+	{ "Bangkok", "Bangkok", "TH", 13.75, 100.50, 4, 5104476,
+		"Asia/Bangkok", true },
+	{ "Lima", "Lima region", "PE", -12.04, -77.03, 161, 7737002,
+		"America/Lima", true },
+	{ "Seoul", "Seoul", "KR", 37.57, 126.98, 38, 10349312, "Asia/Seoul",
+		true },
+	{ "Jakarta", "Jakarta", "ID", -6.21, 106.85, 8, 8540121,
+		"Asia/Jakarta", true },
+	{ "Bogotá", "Bogota D.C.", "CO", 4.61, -74.08, 2582, 7674366,
+		"America/Bogota", true },
+	{ "Tehran", "Tehran", "IR", 35.69, 51.42, 1178, 7153309, "Asia/Tehran",
+		true },
+	{ "Chicago", "Illinois", "US", 41.85, -87.65, 179, 2746388,
+		"America/Chicago", false },
+	{ "Ho Chi Minh City", "Ho Chi Minh", "VN", 10.82, 106.63, 10, 3467331,
+		"Asia/Ho_Chi_Minh", false },
+	{ "Hanoi", "Hanoi", "VN", 21.02, 105.84, 12, 8053663,
+		"Asia/Ho_Chi_Minh", true },
+	{ "Riyadh", "Riyadh Region", "SA", 24.69, 46.72, 612, 4205961,
+		"Asia/Riyadh", true },
+	{ "Singapore", "Singapore", "SG", 1.29, 103.85, 15, 5638700,
+		"Asia/Singapore", true },
+	{ "Sydney", "New South Wales", "AU", -33.87, 151.21, 58, 4627345,
+		"Australia/Sydney", false },
+	{ "Melbourne", "Victoria", "AU", -37.81, 144.96, 31, 4246375,
+		"Australia/Melbourne", false },
+	{ "Toronto", "Ontario", "CA", 43.70, -79.42, 175, 2600000,
+		"America/Toronto", false },
+	{ "Montreal", "Quebec", "CA", 45.51, -73.59, 216, 1600000,
+		"America/Toronto", false },
+	{ "Vancouver", "British Columbia", "CA", 49.25, -123.12, 70, 600000,
+		"America/Vancouver", false },
+	{ "Madrid", "Madrid", "ES", 40.42, -3.70, 665, 3255944,
+		"Europe/Madrid", true },
+	{ "Barcelona", "Catalonia", "ES", 41.39, 2.16, 47, 1620343,
+		"Europe/Madrid", false },
+	{ "Málaga", "Andalusia", "ES", 36.72, -4.42, 17, 568305,
+		"Europe/Madrid", false },
+	{ "Rome", "Lazio", "IT", 41.89, 12.51, 20, 2318895, "Europe/Rome",
+		true },
+	{ "Milan", "Lombardy", "IT", 45.46, 9.19, 120, 1236837, "Europe/Rome",
+		false },
+	{ "Naples", "Campania", "IT", 40.85, 14.27, 17, 909048, "Europe/Rome",
+		false },
+	{ "Berlin", "Berlin", "DE", 52.52, 13.41, 74, 3426354, "Europe/Berlin",
+		true },
+	{ "Hamburg", "Hamburg", "DE", 53.55, 10.00, 6, 1845229,
+		"Europe/Berlin", false },
+	{ "Munich", "Bavaria", "DE", 48.14, 11.58, 524, 1260391,
+		"Europe/Berlin", false },
+	{ "Nürnberg", "Bavaria", "DE", 49.45, 11.07, 302, 518370,
+		"Europe/Berlin", false },
+	{ "Cologne", "North Rhine-Westphalia", "DE", 50.93, 6.95, 59, 963395,
+		"Europe/Berlin", false },
+	{ "Vienna", "Vienna", "AT", 48.21, 16.37, 193, 1691468,
+		"Europe/Vienna", true },
+	{ "Zürich", "Zurich", "CH", 47.37, 8.55, 429, 341730, "Europe/Zurich",
+		false },
+	{ "Geneva", "Geneva", "CH", 46.20, 6.15, 375, 183981, "Europe/Zurich",
+		false },
+	{ "Prague", "Prague", "CZ", 50.09, 14.42, 202, 1165581,
+		"Europe/Prague", true },
+	{ "Warsaw", "Masovia", "PL", 52.23, 21.01, 113, 1702139,
+		"Europe/Warsaw", true },
+	{ "Kraków", "Lesser Poland", "PL", 50.06, 19.94, 219, 755050,
+		"Europe/Warsaw", false },
+	{ "Łódź", "Łódź Voivodeship", "PL", 51.77, 19.47, 221, 768755,
+		"Europe/Warsaw", false },
+	{ "Wrocław", "Lower Silesia", "PL", 51.10, 17.03, 120, 634893,
+		"Europe/Warsaw", false },
+	{ "Gdańsk", "Pomerania", "PL", 54.35, 18.65, 12, 461865,
+		"Europe/Warsaw", false },
+	{ "Budapest", "Budapest", "HU", 47.50, 19.04, 102, 1741041,
+		"Europe/Budapest", true },
+	{ "Bucharest", "Bucureşti", "RO", 44.43, 26.11, 83, 1877155,
+		"Europe/Bucharest", true },
+	{ "Athens", "Attica", "GR", 37.98, 23.73, 70, 664046, "Europe/Athens",
+		true },
+	{ "Lisbon", "Lisbon", "PT", 38.72, -9.13, 45, 517802, "Europe/Lisbon",
+		true },
+	{ "Porto", "Porto", "PT", 41.15, -8.61, 104, 249633, "Europe/Lisbon",
+		false },
+	{ "Dublin", "Leinster", "IE", 53.33, -6.25, 17, 1024027,
+		"Europe/Dublin", true },
+	{ "Amsterdam", "North Holland", "NL", 52.37, 4.89, 13, 741636,
+		"Europe/Amsterdam", true },
+	{ "Rotterdam", "South Holland", "NL", 51.92, 4.48, 5, 598199,
+		"Europe/Amsterdam", false },
+	{ "Brussels", "Brussels Capital", "BE", 50.85, 4.35, 28, 1019022,
+		"Europe/Brussels", true },
+	{ "Copenhagen", "Capital Region", "DK", 55.68, 12.57, 14, 1153615,
+		"Europe/Copenhagen", true },
+	{ "Stockholm", "Stockholm", "SE", 59.33, 18.07, 28, 1515017,
+		"Europe/Stockholm", true },
+	{ "Göteborg", "Västra Götaland", "SE", 57.71, 11.97, 12, 572799,
+		"Europe/Stockholm", false },
+	{ "Oslo", "Oslo", "NO", 59.91, 10.75, 26, 580000, "Europe/Oslo",
+		true },
+	{ "Helsinki", "Uusimaa", "FI", 60.17, 24.94, 26, 558457,
+		"Europe/Helsinki", true },
+	{ "Kyiv", "Kyiv City", "UA", 50.45, 30.52, 187, 2797553,
+		"Europe/Kyiv", true },
+	{ "Saint Petersburg", "St.-Petersburg", "RU", 59.94, 30.31, 11,
+		5351935, "Europe/Moscow", false },
+	{ "Dubrovnik", "Dubrovnik-Neretva", "HR", 42.65, 18.09, 20, 41671,
+		"Europe/Zagreb", false },
+	{ "Zagreb", "City of Zagreb", "HR", 45.81, 15.98, 158, 698966,
+		"Europe/Zagreb", true },
+	{ "Edinburgh", "Scotland", "GB", 55.95, -3.20, 47, 464990,
+		"Europe/London", false },
+	{ "Manchester", "England", "GB", 53.48, -2.24, 38, 395515,
+		"Europe/London", false },
+	{ "Marseille", "Provence-Alpes-Côte d'Azur", "FR", 43.30, 5.38, 28,
+		870731, "Europe/Paris", false },
+	{ "Lyon", "Auvergne-Rhône-Alpes", "FR", 45.75, 4.85, 173, 522969,
+		"Europe/Paris", false },
+	{ "San Francisco", "California", "US", 37.77, -122.42, 16, 864816,
+		"America/Los_Angeles", false },
+	{ "Seattle", "Washington", "US", 47.61, -122.33, 56, 737015,
+		"America/Los_Angeles", false },
+	{ "Denver", "Colorado", "US", 39.74, -104.98, 1609, 715522,
+		"America/Denver", false },
+	{ "Houston", "Texas", "US", 29.76, -95.36, 15, 2304580,
+		"America/Chicago", false },
+	{ "Miami", "Florida", "US", 25.77, -80.19, 2, 442241,
+		"America/New_York", false },
+	{ "Boston", "Massachusetts", "US", 42.36, -71.06, 14, 675647,
+		"America/New_York", false },
+	{ "Phoenix", "Arizona", "US", 33.45, -112.07, 331, 1608139,
+		"America/Phoenix", false },
+	{ "Santiago", "Santiago Metropolitan", "CL", -33.46, -70.65, 520,
+		6269384, "America/Santiago", true },
+	{ "Johannesburg", "Gauteng", "ZA", -26.20, 28.04, 1767, 5635127,
+		"Africa/Johannesburg", false },
+	{ "Cape Town", "Western Cape", "ZA", -33.93, 18.42, 25, 4710000,
+		"Africa/Johannesburg", false },
+	{ "Nairobi", "Nairobi County", "KE", -1.28, 36.82, 1795, 4397073,
+		"Africa/Nairobi", true },
+	{ "Casablanca", "Casablanca-Settat", "MA", 33.59, -7.62, 50, 3359818,
+		"Africa/Casablanca", false },
+	{ "Auckland", "Auckland", "NZ", -36.85, 174.76, 26, 1657200,
+		"Pacific/Auckland", false },
+	{ "Wellington", "Wellington", "NZ", -41.29, 174.78, 19, 215400,
+		"Pacific/Auckland", true },
+	{ "Perth", "Western Australia", "AU", -31.95, 115.86, 31, 2192229,
+		"Australia/Perth", false },
+	{ "Kyoto", "Kyoto", "JP", 35.02, 135.75, 49, 1464890, "Asia/Tokyo",
+		false },
+	{ "Busan", "Busan", "KR", 35.10, 129.04, 19, 3678555, "Asia/Seoul",
+		false },
+	{ "Bangalore", "Karnataka", "IN", 12.97, 77.59, 920, 8443675,
+		"Asia/Kolkata", false },
+	{ "Ankara", "Ankara", "TR", 39.92, 32.85, 938, 5663322,
+		"Europe/Istanbul", true },
+	{ "Guadalajara", "Jalisco", "MX", 20.67, -103.39, 1566, 1385629,
+		"America/Mexico_City", false }
+};
+
+
+enum sky {
+	SKY_CLEAR,
+	SKY_PARTLY_CLOUDY,
+	SKY_OVERCAST,
+	SKY_DRIZZLE,
+	SKY_RAIN,
+	SKY_SHOWERS,
+	SKY_THUNDERSTORM,
+	kSkyCount
+};
+
+
+// xorshift32, the same sequence on every platform
+static uint32_t
+next_random(uint32_t& state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+
+static double
+random_between(uint32_t& state, double low, double high)
+{
+	return low + (next_random(state) % 10000) / 10000.0 * (high - low);
+}
+
+
+static void
+append_format(std::string& text, const char* format, double value)
+{
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), format, value);
+	text += buffer;
+}
+
+
+// One decimal like Open-Meteo, without a negative zero
+static void
+append_decimal(std::string& text, double value)
+{
+	value = round(value * 10) / 10;
+	if (value == 0)
+		value = 0;
+	append_format(text, "%.1f", value);
+}
+
+
+static void
+append_array(std::string& text, const char* name,
+	const std::vector<std::string>& values)
+{
+	text += "\"";
+	text += name;
+	text += "\":[";
+	for (size_t i = 0; i < values.size(); i++) {
+		if (i > 0)
+			text += ",";
+		text += values[i];
+	}
+	text += "]";
+}
+
+
+static int
+weather_code(sky state, double temperature, double intensity)
+{
+	bool snow = temperature <= 0.5;
+	switch (state) {
+		case SKY_CLEAR:
+			return intensity < 0.5 ? 0 : 1;
+		case SKY_PARTLY_CLOUDY:
+			return 2;
+		case SKY_OVERCAST:
+			return 3;
+		case SKY_DRIZZLE:
+			return snow ? 71 : 51;
+		case SKY_RAIN:
+			if (snow)
+				return intensity < 0.5 ? 71 : 73;
+			return intensity < 0.5 ? 61 : 63;
+		case SKY_SHOWERS:
+			if (snow)
+				return 85;
+			return intensity < 0.5 ? 80 : 81;
+		case SKY_THUNDERSTORM:
+			return 95;
+		default:
+			return 3;
+	}
+}
+
+
+static std::string
+forecast_response(const forecast_place& place, int days, uint32_t seed)
+{
+	uint32_t random = seed;
+	int hours = days * kHoursPerDay;
+	long firstHour = kFirstDay - place.utcOffset;
+
+	std::vector<std::string> times, temperatures, probabilities,
+		precipitations, codes, dayFlags;
+
+	// Every day is a little warmer or colder than the one before, the sky
+	// changes every three hours
+	double dayOffset = 0;
+	sky state = SKY_PARTLY_CLOUDY;
+	double intensity = 0;
+	for (int hour = 0; hour < hours; hour++) {
+		int localHour = hour % kHoursPerDay;
+		if (localHour == 0)
+			dayOffset = dayOffset * 0.6 + random_between(random, -3, 3);
+		if (hour % 3 == 0) {
+			// Wet weather comes and goes through the clouds
+			int step = (int) (next_random(random) % 5) - 2;
+			int next = (int) state + (step > 0 ? 1 : step < 0 ? -1 : 0);
+			if (next < 0)
+				next = 0;
+			if (next >= kSkyCount)
+				next = kSkyCount - 1;
+			state = (sky) next;
+			intensity = random_between(random, 0, 1);
+		}
+
+		double temperature = place.meanTemperature + dayOffset
+			+ place.dailySwing * sin(2 * M_PI * (localHour - 9) / 24.0)
+			+ random_between(random, -0.4, 0.4);
+		// Thunderstorms need warmth, rain cools the air
+		if (state == SKY_THUNDERSTORM && temperature < 15)
+			state = SKY_SHOWERS;
+		if (state >= SKY_RAIN)
+			temperature -= 1.5;
+
+		double amount = 0;
+		int probability;
+		switch (state) {
+			case SKY_CLEAR:
+			case SKY_PARTLY_CLOUDY:
+				probability = (int) random_between(random, 0, 10);
+				break;
+			case SKY_OVERCAST:
+				probability = (int) random_between(random, 10, 35);
+				break;
+			case SKY_DRIZZLE:
+				amount = 0.1 + intensity * 0.2;
+				probability = (int) random_between(random, 45, 70);
+				break;
+			case SKY_RAIN:
+				amount = 0.4 + intensity * 2.5;
+				probability = (int) random_between(random, 70, 95);
+				break;
+			default:
+				amount = 0.8 + intensity * (state == SKY_THUNDERSTORM ? 7 : 3);
+				probability = (int) random_between(random, 60, 90);
+				break;
+		}
+
+		times.push_back(std::to_string(firstHour + hour * 3600L));
+
+		std::string value;
+		append_decimal(value, temperature);
+		temperatures.push_back(value);
+		probabilities.push_back(std::to_string(probability));
+		value.clear();
+		append_decimal(value, amount);
+		precipitations.push_back(value);
+		codes.push_back(std::to_string(
+			weather_code(state, temperature, intensity)));
+		dayFlags.push_back(localHour >= place.sunrise
+			&& localHour < place.sunset ? "1" : "0");
+	}
+
+	std::string text("{\"latitude\":");
+	append_format(text, "%.2f", place.latitude);
+	text += ",\"longitude\":";
+	append_format(text, "%.2f", place.longitude);
+	text += ",\"generationtime_ms\":";
+	append_format(text, "%.6f", random_between(random, 0.03, 0.2));
+	text += ",\"utc_offset_seconds\":" + std::to_string(place.utcOffset);
+	text += ",\"timezone\":\"" + std::string(place.timezone) + "\"";
+	text += ",\"timezone_abbreviation\":\"" + std::string(place.abbreviation)
+		+ "\"";
+	text += ",\"elevation\":";
+	append_format(text, "%.1f", place.elevation);
+	text += ",\"hourly_units\":{\"time\":\"unixtime\","
+		"\"temperature_2m\":\"°C\",\"precipitation_probability\":\"%\","
+		"\"precipitation\":\"mm\",\"weathercode\":\"wmo code\","
+		"\"is_day\":\"\"},\"hourly\":{";
+	append_array(text, "time", times);
+	text += ",";
+	append_array(text, "temperature_2m", temperatures);
+	text += ",";
+	append_array(text, "precipitation_probability", probabilities);
+	text += ",";
+	append_array(text, "precipitation", precipitations);
+	text += ",";
+	append_array(text, "weathercode", codes);
+	text += ",";
+	append_array(text, "is_day", dayFlags);
+	text += "}}";
+	return text;
+}
+
+
+static const country*
+find_country(const char* code)
+{
+	for (size_t i = 0; i < sizeof(kCountries) / sizeof(kCountries[0]); i++) {
+		if (strcmp(kCountries[i].code, code) == 0)
+			return &kCountries[i];
+	}
+	return NULL;
+}
+
+
+static std::string
+search_response(const city* cities, size_t count, long firstId)
+{
+	std::string text("{\"results\":[");
+	for (size_t i = 0; i < count; i++) {
+		const city& city = cities[i];
+		const country* country = find_country(city.countryCode);
+		if (country == NULL) {
+			fprintf(stderr, "No country %s\n", city.countryCode);
+			continue;
+		}
+
+		if (i > 0)
+			text += ",";
+		text += "{\"id\":" + std::to_string(firstId + i);
+		text += ",\"name\":\"" + std::string(city.name) + "\"";
+		text += ",\"latitude\":";
+		append_format(text, "%.5f", city.latitude);
+		text += ",\"longitude\":";
+		append_format(text, "%.5f", city.longitude);
+		text += ",\"elevation\":";
+		append_format(text, "%.1f", city.elevation);
+		text += ",\"feature_code\":\"";
+		text += city.capital ? "PPLC" : "PPL";
+		text += "\",\"country_code\":\"" + std::string(city.countryCode)
+			+ "\"";
+		text += ",\"timezone\":\"" + std::string(city.timezone) + "\"";
+		text += ",\"population\":" + std::to_string(city.population);
+		text += ",\"country_id\":" + std::to_string(country->id);
+		text += ",\"country\":\"" + std::string(country->name) + "\"";
+		text += ",\"admin1\":\"" + std::string(city.admin1) + "\"}";
+	}
+	text += "],\"generationtime_ms\":0.612345}";
+	return text;
+}
+
+
+static bool
+write_file(const std::string& directory, const char* name,
+	const std::string& data)
+{
+	std::string path = directory + "/" + name + ".json";
+	FILE* file = fopen(path.c_str(), "wb");
+	if (file == NULL) {
+		fprintf(stderr, "Could not create %s\n", path.c_str());
+		return false;
+	}
+
+	bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+	written &= fputc('\n', file) != EOF;
+	written &= fclose(file) == 0;
+	if (!written)
+		fprintf(stderr, "Could not write %s\n", path.c_str());
+	return written;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	if (argc != 2) {
+		fprintf(stderr, "Usage: MakeCorpus <directory>\n");
+		return 1;
+	}
+	std::string directory(argv[1]);
+
+	std::string batch("[");
+	batch += forecast_response(kSanFrancisco, 16, 11) + ",";
+	batch += forecast_response(kWarsaw, 16, 12) + ",";
+	batch += forecast_response(kTokyo, 16, 13) + ",";
+	batch += forecast_response(kSydney, 16, 14) + "]";
+
+	bool written = write_file(directory, "forecast-hourly-1d",
+			forecast_response(kZurich, 1, 1))
+		&& write_file(directory, "forecast-hourly-16d",
+			forecast_response(kWarsaw, 16, 2))
+		&& write_file(directory, "forecast-batch-4x16d", batch)
+		&& write_file(directory, "geocoding-10", search_response(kSpringfields,
+			sizeof(kSpringfields) / sizeof(kSpringfields[0]), 100001))
+		&& write_file(directory, "geocoding-100", search_response(kLargeCities,
+			sizeof(kLargeCities) / sizeof(kLargeCities[0]), 200001));
+	return written ? 0 : 1;
+}
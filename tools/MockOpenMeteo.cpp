@@ -0,0 +1,612 @@
+/*
+ * Copyright 2026 Weather contributors
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+// A local stand-in for the Open-Meteo forecast and geocoding APIs, to run
+// the application without the internet and to make it meet slow and broken
+// servers on purpose. Forecasts and searches are answered from fixture
+// files, by default the synthetic responses in benchmarks/corpus/.
+//
+// Start it and point the application at it:
+//	MockOpenMeteo --port 8080 --latency 300 --status 503:20
+//	export WEATHER_FORECAST_URL=http://127.0.0.1:8080
+//	export WEATHER_GEOCODING_URL=http://127.0.0.1:8080
+//	Weather
+//
+// Every request draws its faults on its own, so a rate of 20 fails about
+// one request in five. Failures are answered like Open-Meteo does, with a
+// JSON error, or with --html-errors like a proxy in front of it, with an
+// HTML page. A service that is down behind one:
+//	MockOpenMeteo --status 503:100 --html-errors The hourly times of a forecast are moved by whole
+// days to start today, the fixtures would be in the past otherwise.
+//
+// This is a host tool: it uses only the C++ standard library and POSIX
+// sockets.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+static const size_t kMaxRequestSize = 64 * 1024;
+static const size_t kChunkSize = 1024;
+static const long kSecondsPerDay = 24 * 60 * 60;
+
+
+struct status_fault {
+	int					code;
+	double				rate;
+};
+
+
+struct options {
+	std::string			address;
+	int					port;
+	std::string			forecastFile;
+	std::string			searchFile;
+	bool				shiftTimes;
+	int					latency;
+	int					jitter;
+	long				bandwidth;
+	long				dripBytes;
+	int					dripInterval;
+	double				truncateRate;
+	double				resetRate;
+	std::vector<status_fault> statusFaults;
+	bool				htmlErrors;
+	int					retryAfter;
+	unsigned			seed;
+};
+
+
+struct http_request {
+	std::string			method;
+	std::string			path;
+	std::string			query;
+	bool				keepAlive;
+};
+
+
+static options sOptions;
+static std::string sForecast;
+static std::string sSearch;
+
+
+static bool
+read_file(const std::string& path, std::string& data)
+{
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == NULL) {
+		fprintf(stderr, "Could not open %s\n", path.c_str());
+		return false;
+	}
+
+	data.clear();
+	char buffer[16 * 1024];
+	size_t bytesRead;
+	while ((bytesRead = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		data.append(buffer, bytesRead);
+	fclose(file);
+
+	// A trailing newline is not part of a response
+	while (!data.empty() && (data.back() == '\n' || data.back() == '\r'))
+		data.pop_back();
+	return true;
+}
+
+
+static void
+sleep_milliseconds(long milliseconds)
+{
+	if (milliseconds > 0) {
+		std::this_thread::sleep_for(
+			std::chrono::milliseconds(milliseconds));
+	}
+}
+
+
+// #pragma mark - Responses
+
+
+// Moves every unixtime of the "time" fields by the given seconds
+static std::string
+shift_times(const std::string& body, long seconds)
+{
+	static const char kTimeField[] = "\"time\":";
+
+	std::string result;
+	result.reserve(body.size());
+
+	size_t position = 0;
+	for (;;) {
+		size_t field = body.find(kTimeField, position);
+		if (field == std::string::npos)
+			break;
+
+		size_t end = field + sizeof(kTimeField) - 1;
+		result.append(body, position, end - position);
+		position = end;
+
+		bool array = position < body.size() && body[position] == '[';
+		if (array)
+			result += body[position++];
+
+		for (;;) {
+			size_t digits = position;
+			while (digits < body.size() && body[digits] >= '0'
+				&& body[digits] <= '9')
+				digits++;
+			if (digits == position)
+				break;
+
+			long value = atol(body.c_str() + position);
+			result += std::to_string(value + seconds);
+			position = digits;
+
+			if (!array || position >= body.size() || body[position] != ',')
+				break;
+			result += body[position++];
+		}
+	}
+
+	result.append(body, position, std::string::npos);
+	return result;
+}
+
+
+static long
+first_time(const std::string& body)
+{
+	size_t field = body.find("\"time\":[");
+	if (field == std::string::npos)
+		return 0;
+	return atol(body.c_str() + field + 8);
+}
+
+
+static std::string
+query_value(const std::string& query, const char* name)
+{
+	std::string key = std::string(name) + "=";
+	size_t start = 0;
+	while (start < query.size()) {
+		size_t end = query.find('&', start);
+		if (end == std::string::npos)
+			end = query.size();
+		if (query.compare(start, key.size(), key) == 0)
+			return query.substr(start + key.size(), end - start - key.size());
+		start = end + 1;
+	}
+	return std::string();
+}
+
+
+static std::string
+forecast_body(const http_request& request)
+{
+	std::string body = sForecast;
+	if (sOptions.shiftTimes) {
+		long first = first_time(body);
+		if (first > 0) {
+			long days = ((long) time(NULL) - first) / kSecondsPerDay;
+			body = shift_times(body, days * kSecondsPerDay);
+		}
+	}
+
+	// A batch gets an array with the fixture once for every location
+	std::string latitudes = query_value(request.query, "latitude");
+	size_t locations = std::count(latitudes.begin(), latitudes.end(), ',') + 1;
+	if (locations == 1 || body.empty() || body[0] != '{')
+		return body;
+
+	std::string batch("[");
+	for (size_t i = 0; i < locations; i++) {
+		if (i > 0)
+			batch += ",";
+		batch += body;
+	}
+	batch += "]";
+	return batch;
+}
+
+
+static const char*
+status_text(int code)
+{
+	switch (code) {
+		case 200:
+			return "OK";
+		case 400:
+			return "Bad Request";
+		case 404:
+			return "Not Found";
+		case 429:
+			return "Too Many Requests";
+		case 500:
+			return "Internal Server Error";
+		case 502:
+			return "Bad Gateway";
+		case 503:
+			return "Service Unavailable";
+		case 504:
+			return "Gateway Timeout";
+		default:
+			return "Error";
+	}
+}
+
+
+static std::string
+error_body(const char* reason)
+{
+	return std::string("{\"error\":true,\"reason\":\"") + reason + "\"}";
+}
+
+
+static std::string
+html_error_body(int code)
+{
+	std::string title = std::to_string(code) + " " + status_text(code);
+	return "<html>\r\n<head><title>" + title + "</title></head>\r\n"
+		"<body>\r\n<center><h1>" + title + "</h1></center>\r\n"
+		"<hr><center>nginx</center>\r\n</body>\r\n</html>\r\n";
+}
+
+
+// #pragma mark - Connections
+
+
+static bool
+send_all(int socket, const char* data, size_t size)
+{
+	while (size > 0) {
+		ssize_t bytesSent = send(socket, data, size, 0);
+		if (bytesSent <= 0)
+			return false;
+		data += bytesSent;
+		size -= bytesSent;
+	}
+	return true;
+}
+
+
+// Sends the body the slow way if asked to, in drips or at the given rate
+static bool
+send_body(int socket, const std::string& body, size_t size)
+{
+	if (sOptions.dripBytes > 0) {
+		for (size_t offset = 0; offset < size;
+				offset += sOptions.dripBytes) {
+			if (offset > 0)
+				sleep_milliseconds(sOptions.dripInterval);
+			size_t chunk = std::min((size_t) sOptions.dripBytes,
+				size - offset);
+			if (!send_all(socket, body.data() + offset, chunk))
+				return false;
+		}
+		return true;
+	}
+
+	if (sOptions.bandwidth > 0) {
+		auto start = std::chrono::steady_clock::now();
+		for (size_t offset = 0; offset < size; offset += kChunkSize) {
+			size_t chunk = std::min(kChunkSize, size - offset);
+			if (!send_all(socket, body.data() + offset, chunk))
+				return false;
+
+			auto due = start + std::chrono::microseconds(
+				(long long) (offset + chunk) * 1000000 / sOptions.bandwidth);
+			std::this_thread::sleep_until(due);
+		}
+		return true;
+	}
+
+	return send_all(socket, body.data(), size);
+}
+
+
+// Ends the connection with a RST instead of a FIN
+static void
+reset_connection(int socket)
+{
+	struct linger linger;
+	linger.l_onoff = 1;
+	linger.l_linger = 0;
+	setsockopt(socket, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+	close(socket);
+}
+
+
+static bool
+read_request(int socket, std::string& buffer, http_request& request)
+{
+	size_t end;
+	while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+		if (buffer.size() > kMaxRequestSize)
+			return false;
+
+		char data[4096];
+		ssize_t bytesRead = recv(socket, data, sizeof(data), 0);
+		if (bytesRead <= 0)
+			return false;
+		buffer.append(data, bytesRead);
+	}
+
+	std::string head = buffer.substr(0, end + 2);
+	buffer.erase(0, end + 4);
+
+	// GET /v1/forecast?latitude=... HTTP/1.1
+	size_t lineEnd = head.find("\r\n");
+	std::string line = head.substr(0, lineEnd);
+	size_t methodEnd = line.find(' ');
+	size_t targetEnd = line.rfind(' ');
+	if (methodEnd == std::string::npos || targetEnd <= methodEnd)
+		return false;
+
+	request.method = line.substr(0, methodEnd);
+	std::string target = line.substr(methodEnd + 1,
+		targetEnd - methodEnd - 1);
+	size_t queryStart = target.find('?');
+	request.path = target.substr(0, queryStart);
+	request.query = queryStart != std::string::npos
+		? target.substr(queryStart + 1) : std::string();
+
+	request.keepAlive = line.compare(targetEnd + 1, std::string::npos,
+		"HTTP/1.0") != 0;
+	std::string lowerHead = head;
+	std::transform(lowerHead.begin(), lowerHead.end(), lowerHead.begin(),
+		::tolower);
+	if (lowerHead.find("\r\nconnection: close\r\n") != std::string::npos)
+		request.keepAlive = false;
+	else if (lowerHead.find("\r\nconnection: keep-alive\r\n")
+			!= std::string::npos)
+		request.keepAlive = true;
+
+	return true;
+}
+
+
+static void
+serve_connection(int socket, unsigned seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<double> percent(0, 100);
+
+	std::string buffer;
+	http_request request;
+	while (read_request(socket, buffer, request)) {
+		if (sOptions.resetRate > 0 && percent(random) < sOptions.resetRate) {
+			printf("%s %s: reset\n", request.method.c_str(),
+				request.path.c_str());
+			reset_connection(socket);
+			return;
+		}
+
+		int code = 200;
+		bool html = false;
+		std::string body;
+		if (request.method != "GET") {
+			code = 400;
+			body = error_body("Only GET is supported");
+		} else if (request.path == "/v1/forecast")
+			body = forecast_body(request);
+		else if (request.path == "/v1/search")
+			body = sSearch;
+		else {
+			code = 404;
+			body = error_body("Not found");
+		}
+
+		for (size_t i = 0; code == 200 && i < sOptions.statusFaults.size();
+				i++) {
+			const status_fault& fault = sOptions.statusFaults[i];
+			if (percent(random) < fault.rate) {
+				code = fault.code;
+				html = sOptions.htmlErrors;
+				body = html ? html_error_body(code)
+					: error_body(status_text(code));
+			}
+		}
+
+		size_t size = body.size();
+		bool truncated = code == 200 && sOptions.truncateRate > 0
+			&& percent(random) < sOptions.truncateRate;
+		if (truncated)
+			size /= 2;
+
+		long delay = sOptions.latency;
+		if (sOptions.jitter > 0) {
+			delay += std::uniform_int_distribution<int>(0,
+				sOptions.jitter)(random);
+		}
+		sleep_milliseconds(delay);
+
+		std::string head = "HTTP/1.1 " + std::to_string(code) + " "
+			+ status_text(code) + "\r\n"
+			"Content-Type: " + (html ? "text/html" : "application/json")
+			+ "; charset=utf-8\r\n"
+			"Content-Length: " + std::to_string(body.size()) + "\r\n";
+		if (code == 429 || code == 503) {
+			head += "Retry-After: " + std::to_string(sOptions.retryAfter)
+				+ "\r\n";
+		}
+		head += request.keepAlive && !truncated
+			? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+
+		bool sent = send_all(socket, head.data(), head.size())
+			&& send_body(socket, body, size);
+
+		printf("%s %s: %d, %zu of %zu bytes%s\n", request.method.c_str(),
+			request.path.c_str(), code, size, body.size(),
+			truncated ? ", truncated" : sent ? "" : ", not sent");
+		fflush(stdout);
+
+		if (!sent || truncated || !request.keepAlive)
+			break;
+	}
+
+	close(socket);
+}
+
+
+// #pragma mark -
+
+
+static void
+usage()
+{
+	fprintf(stderr, "Usage: MockOpenMeteo [--address 127.0.0.1] "
+		"[--port 8080]\n"
+		"\t[--forecast file] [--search file] [--no-shift]\n"
+		"\t[--latency ms[:jitter ms]] [--bandwidth bytes/s] "
+		"[--drip bytes:ms]\n"
+		"\t[--truncate percent] [--reset percent] "
+		"[--status code:percent ...]\n"
+		"\t[--html-errors] [--retry-after s] [--seed n]\n");
+	exit(1);
+}
+
+
+static void
+parse_pair(const char* value, long& first, long& second)
+{
+	char* end;
+	first = strtol(value, &end, 10);
+	if (*end == ':')
+		second = strtol(end + 1, NULL, 10);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	sOptions.address = "127.0.0.1";
+	sOptions.port = 8080;
+	sOptions.forecastFile = "../benchmarks/corpus/forecast-hourly-16d.json";
+	sOptions.searchFile = "../benchmarks/corpus/geocoding-10.json";
+	sOptions.shiftTimes = true;
+	sOptions.latency = 0;
+	sOptions.jitter = 0;
+	sOptions.bandwidth = 0;
+	sOptions.dripBytes = 0;
+	sOptions.dripInterval = 0;
+	sOptions.truncateRate = 0;
+	sOptions.resetRate = 0;
+	sOptions.htmlErrors = false;
+	sOptions.retryAfter = 5;
+	sOptions.seed = time(NULL);
+
+	for (int argument = 1; argument < argc; argument++) {
+		const char* option = argv[argument];
+		if (strcmp(option, "--no-shift") == 0) {
+			sOptions.shiftTimes = false;
+			continue;
+		}
+		if (strcmp(option, "--html-errors") == 0) {
+			sOptions.htmlErrors = true;
+			continue;
+		}
+		if (argument + 1 >= argc)
+			usage();
+
+		const char* value = argv[++argument];
+		if (strcmp(option, "--address") == 0)
+			sOptions.address = value;
+		else if (strcmp(option, "--port") == 0)
+			sOptions.port = atoi(value);
+		else if (strcmp(option, "--forecast") == 0)
+			sOptions.forecastFile = value;
+		else if (strcmp(option, "--search") == 0)
+			sOptions.searchFile = value;
+		else if (strcmp(option, "--latency") == 0) {
+			long latency = 0, jitter = 0;
+			parse_pair(value, latency, jitter);
+			sOptions.latency = latency;
+			sOptions.jitter = jitter;
+		} else if (strcmp(option, "--bandwidth") == 0)
+			sOptions.bandwidth = atol(value);
+		else if (strcmp(option, "--drip") == 0) {
+			long bytes = 0, interval = 0;
+			parse_pair(value, bytes, interval);
+			sOptions.dripBytes = bytes;
+			sOptions.dripInterval = interval;
+		} else if (strcmp(option, "--truncate") == 0)
+			sOptions.truncateRate = atof(value);
+		else if (strcmp(option, "--reset") == 0)
+			sOptions.resetRate = atof(value);
+		else if (strcmp(option, "--status") == 0) {
+			long code = 0, rate = 100;
+			parse_pair(value, code, rate);
+			if (code < 100 || code > 599)
+				usage();
+			sOptions.statusFaults.push_back({(int) code, (double) rate});
+		} else if (strcmp(option, "--retry-after") == 0)
+			sOptions.retryAfter = atoi(value);
+		else if (strcmp(option, "--seed") == 0)
+			sOptions.seed = strtoul(value, NULL, 10);
+		else
+			usage();
+	}
+
+	if (!read_file(sOptions.forecastFile, sForecast)
+		|| !read_file(sOptions.searchFile, sSearch))
+		return 1;
+
+	signal(SIGPIPE, SIG_IGN);
+
+	int listener = socket(AF_INET, SOCK_STREAM, 0);
+	if (listener < 0) {
+		perror("socket");
+		return 1;
+	}
+
+	int reuse = 1;
+	setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+	struct sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(sOptions.port);
+	if (inet_pton(AF_INET, sOptions.address.c_str(), &address.sin_addr)
+			!= 1) {
+		fprintf(stderr, "Not an IPv4 address: %s\n",
+			sOptions.address.c_str());
+		return 1;
+	}
+
+	if (bind(listener, (struct sockaddr*) &address, sizeof(address)) != 0
+		|| listen(listener, 64) != 0) {
+		perror("bind");
+		return 1;
+	}
+
+	printf("Serving on http://%s:%d\n", sOptions.address.c_str(),
+		sOptions.port);
+	fflush(stdout);
+
+	unsigned connections = 0;
+	for (;;) {
+		int socket = accept(listener, NULL, NULL);
+		if (socket < 0)
+			continue;
+
+		std::thread(serve_connection, socket,
+			sOptions.seed + connections++).detach();
+	}
+
+	return 0;
+}